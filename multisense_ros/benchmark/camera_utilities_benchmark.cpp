@@ -0,0 +1,612 @@
+/**
+ * @file camera_utilities_benchmark.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <multisense_ros/camera_utilities.h>
+#include <multisense_ros/stereo_point_cloud_utilities.h>
+
+#include "synthetic_data.h"
+
+using namespace multisense_ros;
+
+namespace {
+
+struct YcbcrFixture
+{
+    YcbcrFixture(uint32_t width_, uint32_t height_):
+        width(width_),
+        height(height_),
+        luma(synthetic::makeLuma(width, height)),
+        chroma(synthetic::makeChroma(width, height)),
+        luma_header(synthetic::makeImageHeader(crl::multisense::Source_Luma_Left, width, height, luma)),
+        chroma_header(synthetic::makeImageHeader(crl::multisense::Source_Chroma_Left, width / 2, height / 2, chroma)),
+        bgr(3 * width * height)
+    {
+    }
+
+    void convertPerPixel()
+    {
+        const size_t rgb_stride = width * 3;
+
+        for (uint32_t y = 0 ; y < height ; ++y)
+        {
+            for (uint32_t x = 0 ; x < width ; ++x)
+            {
+                memcpy(bgr.data() + y * rgb_stride + 3 * x, ycbcrToBgr<uint8_t>(luma_header, chroma_header, x, y).data(), 3);
+            }
+        }
+    }
+
+    ///
+    /// @brief Check the current output is within 1 of the floating point per-pixel conversion
+    ///
+    bool matchesReference()
+    {
+        const std::vector<uint8_t> output = bgr;
+        convertPerPixel();
+
+        for (size_t i = 0 ; i < output.size() ; ++i)
+        {
+            if (std::abs(static_cast<int>(output[i]) - static_cast<int>(bgr[i])) > 1)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    const uint32_t width;
+    const uint32_t height;
+
+    const std::vector<uint8_t> luma;
+    const std::vector<uint8_t> chroma;
+
+    const crl::multisense::image::Header luma_header;
+    const crl::multisense::image::Header chroma_header;
+
+    std::vector<uint8_t> bgr;
+};
+
+void BM_ycbcrToBgrPerPixel(benchmark::State &state)
+{
+    YcbcrFixture fixture(state.range(0), state.range(1));
+
+    for (auto _ : state)
+    {
+        fixture.convertPerPixel();
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * fixture.width * fixture.height);
+}
+
+void BM_ycbcrToBgr(benchmark::State &state)
+{
+    const SimdLevel level = static_cast<SimdLevel>(state.range(2));
+    if (level > simdLevel())
+    {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+
+    YcbcrFixture fixture(state.range(0), state.range(1));
+
+    ycbcrToBgr(fixture.luma_header, fixture.chroma_header, fixture.bgr.data(), level);
+    if (!fixture.matchesReference())
+    {
+        state.SkipWithError("converted image does not match the per-pixel conversion");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        ycbcrToBgr(fixture.luma_header, fixture.chroma_header, fixture.bgr.data(), level);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetLabel(simdLevelString(level));
+    state.SetItemsProcessed(state.iterations() * fixture.width * fixture.height);
+}
+
+void BM_ycbcrToBgrThreaded(benchmark::State &state)
+{
+    YcbcrFixture fixture(state.range(0), state.range(1));
+    RowBandExecutor executor(state.range(2));
+
+    for (auto _ : state)
+    {
+        ycbcrToBgr(fixture.luma_header, fixture.chroma_header, fixture.bgr.data(), executor);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetLabel(std::string(simdLevelString(simdLevel())) + " " + std::to_string(executor.bands()) + " threads");
+    state.SetItemsProcessed(state.iterations() * fixture.width * fixture.height);
+}
+
+void BM_makeRectificationRemap(benchmark::State &state)
+{
+    const auto device_info = synthetic::makeDeviceInfo();
+    const auto config = synthetic::makeConfig(state.range(0), state.range(1));
+    const auto calibration = synthetic::makeCalibration();
+
+    for (auto _ : state)
+    {
+        auto remap = makeRectificationRemap(config, calibration.left, device_info);
+        benchmark::DoNotOptimize(remap);
+    }
+}
+
+void BM_remap(benchmark::State &state)
+{
+    //
+    // Rectify a BGR image with either the fixed point maps or their floating point equivalent
+
+    const uint32_t width = state.range(0);
+    const uint32_t height = state.range(1);
+    const bool fixed_point = state.range(2) != 0;
+
+    auto remap = makeRectificationRemap(synthetic::makeConfig(width, height),
+                                        synthetic::makeCalibration().left,
+                                        synthetic::makeDeviceInfo());
+    if (!fixed_point)
+    {
+        cv::Mat map_x;
+        cv::Mat map_y;
+        cv::convertMaps(remap.map1, remap.map2, map_x, map_y, CV_32FC1);
+
+        remap.map1 = map_x;
+        remap.map2 = map_y;
+    }
+
+    std::vector<uint8_t> bgr(3 * width * height, 127);
+    std::vector<uint8_t> rectified(bgr.size());
+
+    const cv::Mat bgr_image(height, width, CV_8UC3, bgr.data());
+    cv::Mat rectified_image(height, width, CV_8UC3, rectified.data());
+
+    for (auto _ : state)
+    {
+        cv::remap(bgr_image, rectified_image, remap.map1, remap.map2, cv::INTER_LINEAR);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetLabel(fixed_point ? "CV_16SC2" : "CV_32FC1");
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+void BM_ycbcrToBgrRemap(benchmark::State &state)
+{
+    //
+    // Baseline of converting to a full resolution BGR image and rectifying it with cv::remap
+
+    YcbcrFixture fixture(state.range(0), state.range(1));
+    const auto remap = makeRectificationRemap(synthetic::makeConfig(fixture.width, fixture.height),
+                                              synthetic::makeCalibration().left,
+                                              synthetic::makeDeviceInfo());
+    RowBandExecutor executor(1);
+
+    std::vector<uint8_t> rectified(fixture.bgr.size());
+
+    for (auto _ : state)
+    {
+        ycbcrToBgr(fixture.luma_header, fixture.chroma_header, fixture.bgr.data(), executor);
+
+        const cv::Mat bgr_image(fixture.height, fixture.width, CV_8UC3, fixture.bgr.data());
+        cv::Mat rectified_image(fixture.height, fixture.width, CV_8UC3, rectified.data());
+        cv::remap(bgr_image, rectified_image, remap.map1, remap.map2, cv::INTER_LINEAR);
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * fixture.width * fixture.height);
+}
+
+void BM_ycbcrToRectifiedBgrPixel(benchmark::State &state)
+{
+    //
+    // Per pixel rectification used by the sparse color pointcloud kernels, run over every pixel of the image
+
+    YcbcrFixture fixture(state.range(0), state.range(1));
+    const auto remap = makeRectificationRemap(synthetic::makeConfig(fixture.width, fixture.height),
+                                              synthetic::makeCalibration().left,
+                                              synthetic::makeDeviceInfo());
+
+    const auto image = makeYcbcr420Image(fixture.luma_header, fixture.chroma_header);
+
+    for (auto _ : state)
+    {
+        uint8_t *bgr = fixture.bgr.data();
+        for (uint32_t y = 0 ; y < fixture.height ; ++y)
+        {
+            for (uint32_t x = 0 ; x < fixture.width ; ++x, bgr += 3)
+            {
+                ycbcrToRectifiedBgrPixel(image, remap, x, y, bgr);
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * fixture.width * fixture.height);
+}
+
+void BM_rectifiedAuxProject(benchmark::State &state)
+{
+    const uint32_t width = state.range(0);
+    const uint32_t height = state.range(1);
+
+    const auto device_info = synthetic::makeDeviceInfo();
+    const StereoCalibrationManger manager(synthetic::makeConfig(width, height),
+                                          synthetic::makeCalibration(),
+                                          device_info);
+
+    const auto aux_camera_info = manager.auxCameraInfo("aux", ros::Time(), manager.operatingAuxResolution());
+
+    //
+    // Reproject a synthetic disparity image so the aux projection sees a realistic distribution of points
+
+    const auto ray_table = manager.rayTable();
+    const auto disparity = synthetic::makeDisparity<uint16_t>(width, height);
+
+    std::vector<float> x(width);
+    std::vector<float> y(width);
+    std::vector<float> z(width);
+
+    std::vector<Eigen::Vector3f> points;
+    points.reserve(width * height);
+
+    for (size_t v = 0 ; v < height ; ++v)
+    {
+        reprojectDisparityRow(&(disparity[v * width]), v, width, *ray_table, x.data(), y.data(), z.data());
+
+        for (size_t u = 0 ; u < width ; ++u)
+        {
+            if (x[u] != std::numeric_limits<float>::max())
+            {
+                points.emplace_back(x[u], y[u], z[u]);
+            }
+        }
+    }
+
+    for (auto _ : state)
+    {
+        for (const auto &point : points)
+        {
+            const Eigen::Vector2f pixel = manager.rectifiedAuxProject(point, aux_camera_info);
+            benchmark::DoNotOptimize(pixel);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+//
+// Reprojected points of a synthetic disparity image with a full resolution aux image to color them from, as seen by
+// the pointcloud callback when running with the Full_Res_Aux_Cam profile
+
+struct AuxColorFixture
+{
+    AuxColorFixture(uint32_t width, uint32_t height):
+        device_info(synthetic::makeDeviceInfo()),
+        manager(makeFullResAuxConfig(width, height), synthetic::makeCalibration(), device_info),
+        aux_camera_info(manager.auxCameraInfo("aux", ros::Time(), manager.operatingAuxResolution())),
+        aux_image(synthetic::makeColorImage(manager.operatingAuxResolution().width,
+                                            manager.operatingAuxResolution().height)),
+        disparity(synthetic::makeDisparity<uint16_t>(width, height)),
+        x(width * height),
+        y(width * height),
+        z(width * height)
+    {
+        const auto ray_table = manager.rayTable();
+
+        for (size_t v = 0 ; v < height ; ++v)
+        {
+            const size_t row_offset = v * width;
+
+            reprojectDisparityRow(&(disparity[row_offset]), v, width, *ray_table,
+                                  &(x[row_offset]), &(y[row_offset]), &(z[row_offset]));
+        }
+    }
+
+    static crl::multisense::image::Config makeFullResAuxConfig(uint32_t width, uint32_t height)
+    {
+        auto config = synthetic::makeConfig(width, height);
+        config.setCameraProfile(crl::multisense::Full_Res_Aux_Cam);
+
+        return config;
+    }
+
+    const crl::multisense::system::DeviceInfo device_info;
+    const StereoCalibrationManger manager;
+    const sensor_msgs::CameraInfo aux_camera_info;
+    const cv::Mat aux_image;
+    const std::vector<uint16_t> disparity;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+};
+
+void BM_auxColorPerPoint(benchmark::State &state)
+{
+    const uint32_t width = state.range(0);
+    const uint32_t height = state.range(1);
+
+    const AuxColorFixture fixture(width, height);
+
+    std::vector<uint32_t> colors(width * height);
+
+    for (auto _ : state)
+    {
+        for (size_t index = 0 ; index < colors.size() ; ++index)
+        {
+            if (0 == fixture.disparity[index])
+            {
+                continue;
+            }
+
+            const Eigen::Vector3f point(fixture.x[index], fixture.y[index], fixture.z[index]);
+
+            const auto color = interpolate_color(fixture.manager.rectifiedAuxProject(point, fixture.aux_camera_info),
+                                                 fixture.aux_image);
+
+            colors[index] = color[2] << 16 | color[1] << 8 | color[0];
+        }
+
+        benchmark::DoNotOptimize(colors.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+void BM_auxColorRow(benchmark::State &state)
+{
+    const uint32_t width = state.range(0);
+    const uint32_t height = state.range(1);
+    const SimdLevel level = static_cast<SimdLevel>(state.range(2));
+
+    const AuxColorFixture fixture(width, height);
+    const auto table = fixture.manager.auxProjectionTable();
+
+    std::vector<uint32_t> colors(width * height);
+
+    for (auto _ : state)
+    {
+        for (size_t v = 0 ; v < height ; ++v)
+        {
+            auxColorRow(*table, v, width, &(fixture.z[v * width]), fixture.aux_image, &(colors[v * width]), level);
+        }
+
+        benchmark::DoNotOptimize(colors.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+//
+// The per frame resize of the full resolution aux image to the disparity resolution, which the pointcloud callback
+// performed before sampling the aux image directly
+
+void BM_resizeAuxColor(benchmark::State &state)
+{
+    const uint32_t width = state.range(0);
+    const uint32_t height = state.range(1);
+
+    const AuxColorFixture fixture(width, height);
+
+    for (auto _ : state)
+    {
+        cv::Mat resized;
+        cv::resize(fixture.aux_image, resized, cv::Size{static_cast<int>(width), static_cast<int>(height)},
+                   0, 0, cv::INTER_AREA);
+
+        benchmark::DoNotOptimize(resized.data);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+//
+// Depth images requested from disparityToDepth
+
+enum class DepthOutputs
+{
+    BOTH,
+    DEPTH,
+    NI_DEPTH
+};
+
+template <typename T>
+void BM_disparityToDepth(benchmark::State &state)
+{
+    const uint32_t width = state.range(0);
+    const uint32_t height = state.range(1);
+
+    const auto device_info = synthetic::makeDeviceInfo();
+    const StereoCalibrationManger manager(synthetic::makeConfig(width, height),
+                                          synthetic::makeCalibration(),
+                                          device_info);
+
+    const auto ray_table = manager.rayTable();
+    const auto disparity = synthetic::makeDisparity<T>(width, height);
+    const auto header = synthetic::makeImageHeader(crl::multisense::Source_Disparity, width, height, disparity);
+
+    const auto level = static_cast<SimdLevel>(state.range(2));
+    const auto outputs = static_cast<DepthOutputs>(state.range(3));
+
+    std::vector<float> depth(width * height);
+    std::vector<uint16_t> ni_depth(width * height);
+
+    float *depth_output = outputs != DepthOutputs::NI_DEPTH ? depth.data() : nullptr;
+    uint16_t *ni_depth_output = outputs != DepthOutputs::DEPTH ? ni_depth.data() : nullptr;
+
+    for (auto _ : state)
+    {
+        if (!disparityToDepth(header, *ray_table, depth_output, ni_depth_output, level))
+        {
+            state.SkipWithError("unsupported disparity bit depth");
+            return;
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+void BM_disparityToFloat(benchmark::State &state)
+{
+    const uint32_t width = state.range(0);
+    const uint32_t height = state.range(1);
+    const auto level = static_cast<SimdLevel>(state.range(2));
+
+    const auto disparity = synthetic::makeDisparity<uint16_t>(width, height);
+
+    std::vector<float> output(width * height);
+
+    for (auto _ : state)
+    {
+        disparityToFloat(disparity.data(), disparity.size(), output.data(), level);
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+void resolutions(benchmark::internal::Benchmark *benchmark)
+{
+    for (const auto &resolution : synthetic::RESOLUTIONS)
+    {
+        benchmark->Args({resolution.first, resolution.second});
+    }
+}
+
+void resolutionsAndSimdLevels(benchmark::internal::Benchmark *benchmark)
+{
+    for (const auto &level : {SimdLevel::SCALAR, SimdLevel::SSE4, SimdLevel::AVX2})
+    {
+        for (const auto &resolution : synthetic::RESOLUTIONS)
+        {
+            benchmark->Args({resolution.first, resolution.second, static_cast<int64_t>(level)});
+        }
+    }
+}
+
+void resolutionsSimdLevelsAndDepthOutputs(benchmark::internal::Benchmark *benchmark)
+{
+    for (const auto &outputs : {DepthOutputs::BOTH, DepthOutputs::DEPTH, DepthOutputs::NI_DEPTH})
+    {
+        for (const auto &level : {SimdLevel::SCALAR, SimdLevel::SSE4, SimdLevel::AVX2})
+        {
+            for (const auto &resolution : synthetic::RESOLUTIONS)
+            {
+                benchmark->Args({resolution.first,
+                                 resolution.second,
+                                 static_cast<int64_t>(level),
+                                 static_cast<int64_t>(outputs)});
+            }
+        }
+    }
+}
+
+//
+// The full resolution aux camera is only available on the S30 family
+
+void s30Resolutions(benchmark::internal::Benchmark *benchmark)
+{
+    for (const auto &resolution : {std::make_pair(1920, 1200), std::make_pair(960, 600)})
+    {
+        benchmark->Args({resolution.first, resolution.second});
+    }
+}
+
+void s30ResolutionsAndSimdLevels(benchmark::internal::Benchmark *benchmark)
+{
+    for (const auto &level : {SimdLevel::SCALAR, SimdLevel::AVX2})
+    {
+        for (const auto &resolution : {std::make_pair(1920, 1200), std::make_pair(960, 600)})
+        {
+            benchmark->Args({resolution.first, resolution.second, static_cast<int64_t>(level)});
+        }
+    }
+}
+
+void resolutionsAndMapTypes(benchmark::internal::Benchmark *benchmark)
+{
+    for (const int64_t fixed_point : {0, 1})
+    {
+        for (const auto &resolution : synthetic::RESOLUTIONS)
+        {
+            benchmark->Args({resolution.first, resolution.second, fixed_point});
+        }
+    }
+}
+
+void resolutionsAndThreads(benchmark::internal::Benchmark *benchmark)
+{
+    for (const int64_t threads : {1, 2, 4, 8})
+    {
+        for (const auto &resolution : synthetic::RESOLUTIONS)
+        {
+            benchmark->Args({resolution.first, resolution.second, threads});
+        }
+    }
+}
+
+}// namespace
+
+BENCHMARK(BM_ycbcrToBgrPerPixel)->Apply(resolutions)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ycbcrToBgr)->Apply(resolutionsAndSimdLevels)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ycbcrToBgrThreaded)->Apply(resolutionsAndThreads)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_makeRectificationRemap)->Apply(resolutions)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_remap)->Apply(resolutionsAndMapTypes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ycbcrToBgrRemap)->Apply(resolutions)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ycbcrToRectifiedBgrPixel)->Apply(resolutions)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_rectifiedAuxProject)->Apply(resolutions)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_auxColorPerPoint)->Apply(s30Resolutions)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_auxColorRow)->Apply(s30ResolutionsAndSimdLevels)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_resizeAuxColor)->Apply(s30Resolutions)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_disparityToDepth, uint16_t)->Apply(resolutionsSimdLevelsAndDepthOutputs)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_disparityToDepth, float)->Apply(resolutionsSimdLevelsAndDepthOutputs)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_disparityToFloat)->Apply(resolutionsAndSimdLevels)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,141 @@
+/**
+ * @file ground_surface_benchmark.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <multisense_ros/ground_surface_utilities.h>
+
+#include "synthetic_data.h"
+
+using namespace multisense_ros;
+
+namespace {
+
+//
+// Synthetic spline model covering the default SplineDrawParameters drawing extents. The cell origin leaves one
+// control point of padding on each side of the drawn region so every sample interpolates inside the grid
+
+static constexpr size_t CONTROL_GRID_ROWS = 20;
+static constexpr size_t CONTROL_GRID_COLS = 30;
+static constexpr float XZ_CELL_ORIGIN[2] = {-28.0f, -3.0f};
+static constexpr float XZ_CELL_SIZE[2] = {2.0f, 2.0f};
+static constexpr float EXTRINSICS[6] = {0.0f, 1.5f, 0.0f, 0.0f, 0.0f, 0.0f};
+static constexpr float QUADRATIC_PARAMS[6] = {0.0f, 0.0f, 0.0f, 0.001f, 0.0f, 0.001f};
+static constexpr double POINTCLOUD_MAX_RANGE = 30.0;
+
+void BM_groundSurfaceClassToPixelColor(benchmark::State &state)
+{
+    const uint32_t width = state.range(0);
+    const uint32_t height = state.range(1);
+
+    const auto classes = synthetic::makeGroundSurfaceClasses(width, height);
+
+    std::vector<uint8_t> output(3 * width * height);
+
+    //
+    // Mirror the colorization loop in Camera::groundSurfaceCallback
+
+    for (auto _ : state)
+    {
+        const size_t rgb_stride = width * 3;
+
+        for (uint32_t y = 0 ; y < height ; ++y)
+        {
+            const size_t row_offset = y * rgb_stride;
+
+            for (uint32_t x = 0 ; x < width ; ++x)
+            {
+                const size_t image_offset = (y * width) + x;
+                memcpy(output.data() + row_offset + (3 * x),
+                       ground_surface_utilities::groundSurfaceClassToPixelColor(classes[image_offset]).data(), 3);
+            }
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+void BM_convertSplineToPointcloud(benchmark::State &state)
+{
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> control_grid =
+        Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>::Random(CONTROL_GRID_ROWS,
+                                                                                       CONTROL_GRID_COLS) * 0.1f;
+
+    ground_surface_utilities::SplineDrawParameters draw_params;
+    draw_params.resolution = static_cast<double>(state.range(0)) / 100.0;
+
+    const float half_fov = std::atan((synthetic::IMAGER_WIDTH / 2.0) / synthetic::FOCAL_LENGTH);
+    const float min_max_azimuth_angle[2] = {static_cast<float>(M_PI_2) - half_fov,
+                                            static_cast<float>(M_PI_2) + half_fov};
+
+    size_t points = 0;
+    for (auto _ : state)
+    {
+        const auto cloud = ground_surface_utilities::convertSplineToPointcloud(control_grid,
+                                                                               draw_params,
+                                                                               POINTCLOUD_MAX_RANGE,
+                                                                               XZ_CELL_ORIGIN,
+                                                                               XZ_CELL_SIZE,
+                                                                               min_max_azimuth_angle,
+                                                                               EXTRINSICS,
+                                                                               QUADRATIC_PARAMS,
+                                                                               synthetic::BASELINE);
+        points = cloud.size();
+        benchmark::DoNotOptimize(cloud.data());
+    }
+
+    state.counters["points"] = points;
+}
+
+void resolutions(benchmark::internal::Benchmark *benchmark)
+{
+    for (const auto &resolution : synthetic::RESOLUTIONS)
+    {
+        benchmark->Args({resolution.first, resolution.second});
+    }
+}
+
+}// namespace
+
+BENCHMARK(BM_groundSurfaceClassToPixelColor)->Apply(resolutions)->Unit(benchmark::kMicrosecond);
+
+//
+// Spline sampling resolution in centimeters
+
+BENCHMARK(BM_convertSplineToPointcloud)->Arg(20)->Arg(10)->Arg(5)->Unit(benchmark::kMillisecond);
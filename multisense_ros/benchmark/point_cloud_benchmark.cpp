@@ -0,0 +1,494 @@
+/**
+ * @file point_cloud_benchmark.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <multisense_ros/camera_utilities.h>
+#include <multisense_ros/point_cloud_utilities.h>
+#include <multisense_ros/stereo_point_cloud_utilities.h>
+
+#include "synthetic_data.h"
+
+using namespace multisense_ros;
+
+namespace {
+
+void writeGenericPoint(sensor_msgs::PointCloud2 &pointcloud, size_t index, const Eigen::Vector3f &point, uint32_t color)
+{
+    float* cloudP = reinterpret_cast<float*>(&(pointcloud.data[index * pointcloud.point_step]));
+    cloudP[0] = point[0];
+    cloudP[1] = point[1];
+    cloudP[2] = point[2];
+
+    uint32_t* colorP = reinterpret_cast<uint32_t*>(&(cloudP[3]));
+    colorP[0] = color;
+}
+
+uint32_t genericLuma(size_t image_index, const crl::multisense::image::Header &image)
+{
+    switch (image.bitsPerPixel)
+    {
+        case 8:
+            return static_cast<uint32_t>(reinterpret_cast<const uint8_t*>(image.imageDataP)[image_index]);
+        case 16:
+            return static_cast<uint32_t>(reinterpret_cast<const uint16_t*>(image.imageDataP)[image_index]);
+        case 32:
+            return reinterpret_cast<const uint32_t*>(image.imageDataP)[image_index];
+    }
+
+    return 0;
+}
+
+void writeGenericPoint(sensor_msgs::PointCloud2 &pointcloud,
+                       size_t pointcloud_index,
+                       const Eigen::Vector3f &point,
+                       size_t image_index,
+                       const crl::multisense::image::Header &image)
+{
+    writeGenericPoint(pointcloud, pointcloud_index, point, genericLuma(image_index, image));
+}
+
+void writeGenericPoint(sensor_msgs::PointCloud2 &pointcloud,
+                       size_t pointcloud_index,
+                       const Eigen::Vector3f &point,
+                       size_t image_index,
+                       const crl::multisense::image::Header &image,
+                       uint32_t color)
+{
+    float* cloudP = reinterpret_cast<float*>(&(pointcloud.data[pointcloud_index * pointcloud.point_step]));
+    cloudP[0] = point[0];
+    cloudP[1] = point[1];
+    cloudP[2] = point[2];
+    cloudP[3] = static_cast<float>(genericLuma(image_index, image));
+
+    uint32_t* colorP = reinterpret_cast<uint32_t*>(&(cloudP[4]));
+    colorP[0] = color;
+}
+
+//
+// The generic pointcloud loop which checks every output and image format per pixel. This is the loop
+// Camera::pointCloudCallback ran before the specialized kernels were introduced. Aux colors are computed per point
+// by projecting each point into the aux image
+
+size_t genericPointCloudLoop(const StereoPointCloudFrameT &frame,
+                             const StereoCalibrationManger &manager,
+                             const sensor_msgs::CameraInfo &aux_camera_info,
+                             uint32_t outputs,
+                             float *row_buffer)
+{
+    const bool pub_pointcloud = outputs & LUMA_POINTCLOUD;
+    const bool pub_color_pointcloud = outputs & COLOR_POINTCLOUD;
+    const bool pub_organized_pointcloud = outputs & LUMA_ORGANIZED_POINTCLOUD;
+    const bool pub_color_organized_pointcloud = outputs & COLOR_ORGANIZED_POINTCLOUD;
+    const bool pub_luma_color_organized_pointcloud = outputs & LUMA_COLOR_ORGANIZED_POINTCLOUD;
+    const bool has_aux_camera = outputs & AUX_COLOR;
+
+    const auto &header = *frame.disparity;
+
+    const Eigen::Vector3f invalid_point(std::numeric_limits<float>::quiet_NaN(),
+                                        std::numeric_limits<float>::quiet_NaN(),
+                                        std::numeric_limits<float>::quiet_NaN());
+
+    float *row_x = row_buffer;
+    float *row_y = row_x + header.width;
+    float *row_z = row_y + header.width;
+
+    const uint16_t *disparity_16 = reinterpret_cast<const uint16_t*>(header.imageDataP);
+    const float *disparity_32 = reinterpret_cast<const float*>(header.imageDataP);
+
+    uint32_t packed_color = 0;
+
+    size_t valid_points = 0;
+    for (size_t y = 0 ; y < header.height ; ++y)
+    {
+        const size_t row_offset = y * header.width;
+
+        if (header.bitsPerPixel == 16)
+        {
+            reprojectDisparityRow(disparity_16 + row_offset, y, header.width, *frame.ray_table, row_x, row_y, row_z);
+        }
+        else
+        {
+            reprojectDisparityRow(disparity_32 + row_offset, y, header.width, *frame.ray_table, row_x, row_y, row_z);
+        }
+
+        for (size_t x = 0 ; x < header.width ; ++x)
+        {
+            const size_t index = row_offset + x;
+
+            const float disparity = header.bitsPerPixel == 16 ? static_cast<float>(disparity_16[index]) / 16.0f :
+                                                                disparity_32[index];
+
+            const Eigen::Vector3f point(row_x[x], row_y[x], row_z[x]);
+
+            if (pub_color_pointcloud || pub_color_organized_pointcloud || pub_luma_color_organized_pointcloud)
+            {
+                packed_color = 0;
+
+                const auto color_pixel = (has_aux_camera && disparity != 0.0) ?
+                    interpolate_color(manager.rectifiedAuxProject(point, aux_camera_info),
+                                      *frame.rectified_color) :
+                    frame.rectified_color->at<cv::Vec3b>(y, x);
+
+                packed_color |= color_pixel[2] << 16 | color_pixel[1] << 8 | color_pixel[0];
+            }
+
+            if (disparity == 0.0 || clipPoint(frame.border_clip->type, frame.border_clip->value,
+                                              header.width, header.height, x, y))
+            {
+                if (pub_organized_pointcloud)
+                {
+                    writeGenericPoint(*frame.luma_organized_point_cloud, index, invalid_point, index, *frame.luma);
+                }
+
+                if (pub_color_organized_pointcloud)
+                {
+                    writeGenericPoint(*frame.color_organized_point_cloud, index, invalid_point, packed_color);
+                }
+
+                if (pub_luma_color_organized_pointcloud)
+                {
+                    writeGenericPoint(*frame.luma_color_organized_point_cloud, index, invalid_point, index,
+                                      *frame.luma, packed_color);
+                }
+
+                continue;
+            }
+
+            const bool valid = isValidReprojectedPoint(point, frame.squared_max_range);
+
+            if (pub_pointcloud && valid)
+            {
+                writeGenericPoint(*frame.luma_point_cloud, valid_points, point, index, *frame.luma);
+            }
+
+            if(pub_color_pointcloud && valid)
+            {
+                writeGenericPoint(*frame.color_point_cloud, valid_points, point, packed_color);
+            }
+
+            if (pub_organized_pointcloud)
+            {
+                writeGenericPoint(*frame.luma_organized_point_cloud, index, valid ? point : invalid_point, index,
+                                  *frame.luma);
+            }
+
+            if (pub_color_organized_pointcloud)
+            {
+                writeGenericPoint(*frame.color_organized_point_cloud, index, valid ? point : invalid_point,
+                                  packed_color);
+            }
+
+            if (pub_luma_color_organized_pointcloud)
+            {
+                writeGenericPoint(*frame.luma_color_organized_point_cloud, index, valid ? point : invalid_point,
+                                  index, *frame.luma, packed_color);
+            }
+
+            if (valid)
+            {
+                ++valid_points;
+            }
+        }
+    }
+
+    return valid_points;
+}
+
+struct PointCloudFixture
+{
+    PointCloudFixture(uint32_t width, uint32_t height, BorderClip border_clip_type):
+        device_info(synthetic::makeDeviceInfo()),
+        manager(std::make_shared<StereoCalibrationManger>(synthetic::makeConfig(width, height),
+                                                          synthetic::makeCalibration(),
+                                                          device_info)),
+        ray_table(manager->rayTable()),
+        aux_projection_table(manager->auxProjectionTable()),
+        aux_pixel_map(makeColorPixelMap(width, height, width, height)),
+        aux_camera_info(manager->auxCameraInfo("aux", ros::Time(), width, height)),
+        border_clip(makeBorderClipMask(border_clip_type, 40.0, width, height)),
+        disparity_data(synthetic::makeDisparity<uint16_t>(width, height)),
+        luma_data(synthetic::makeLuma(width, height)),
+        chroma_data(synthetic::makeChroma(width, height)),
+        disparity(synthetic::makeImageHeader(crl::multisense::Source_Disparity, width, height, disparity_data)),
+        luma(synthetic::makeImageHeader(crl::multisense::Source_Luma_Rectified_Left, width, height, luma_data)),
+        chroma(synthetic::makeImageHeader(crl::multisense::Source_Chroma_Left, width / 2, height / 2, chroma_data)),
+        color(makeYcbcr420Image(synthetic::makeImageHeader(crl::multisense::Source_Luma_Left, width, height,
+                                                           luma_data),
+                                chroma)),
+        color_remap(manager->leftRemap()),
+        rectified_color(height, width, CV_8UC3),
+        row_buffer(4 * width)
+    {
+        //
+        // Color the points from the rectified left color image, so the sparse color kernels produce exactly the same
+        // colors as the generic loop
+
+        RowBandExecutor executor(1);
+        cv::Mat bgr(height, width, CV_8UC3);
+        ycbcrToBgr(luma, chroma, bgr.data, executor);
+        cv::remap(bgr, rectified_color, color_remap->map1, color_remap->map2, cv::INTER_LINEAR);
+
+        for (auto cloud : {&luma_point_cloud, &color_point_cloud, &luma_organized_point_cloud,
+                           &color_organized_point_cloud})
+        {
+            *cloud = initialize_pointcloud<float>(false, "left", "luminance");
+            cloud->data.resize(width * height * cloud->point_step);
+        }
+
+        luma_color_organized_point_cloud = initialize_pointcloud<float>(false, "left",
+                                                                        std::vector<std::string>{"luminance", "rgb"});
+        luma_color_organized_point_cloud.data.resize(width * height * luma_color_organized_point_cloud.point_step);
+
+        frame.disparity = &disparity;
+        frame.luma = &luma;
+        frame.rectified_color = &rectified_color;
+        frame.color = &color;
+        frame.color_remap = color_remap.get();
+        frame.ray_table = ray_table.get();
+        frame.border_clip = &border_clip;
+        frame.aux_projection = aux_projection_table.get();
+        frame.aux_pixel_map = &aux_pixel_map;
+        frame.squared_max_range = 15.0f * 15.0f;
+        frame.luma_point_cloud = &luma_point_cloud;
+        frame.color_point_cloud = &color_point_cloud;
+        frame.luma_organized_point_cloud = &luma_organized_point_cloud;
+        frame.color_organized_point_cloud = &color_organized_point_cloud;
+        frame.luma_color_organized_point_cloud = &luma_color_organized_point_cloud;
+    }
+
+    std::vector<sensor_msgs::PointCloud2*> outputClouds(uint32_t outputs)
+    {
+        std::vector<sensor_msgs::PointCloud2*> clouds;
+        if (outputs & LUMA_POINTCLOUD) clouds.push_back(&luma_point_cloud);
+        if (outputs & COLOR_POINTCLOUD) clouds.push_back(&color_point_cloud);
+        if (outputs & LUMA_ORGANIZED_POINTCLOUD) clouds.push_back(&luma_organized_point_cloud);
+        if (outputs & COLOR_ORGANIZED_POINTCLOUD) clouds.push_back(&color_organized_point_cloud);
+        if (outputs & LUMA_COLOR_ORGANIZED_POINTCLOUD) clouds.push_back(&luma_color_organized_point_cloud);
+
+        return clouds;
+    }
+
+    //
+    // Check the specialized kernel produces the same pointclouds as the generic loop. Aux colors are interpolated in
+    // single rather than double precision by the kernels, so their color channels may differ by one
+
+    static bool matchingPoints(const std::vector<uint8_t> &generic,
+                               const sensor_msgs::PointCloud2 &cloud,
+                               bool aux_color)
+    {
+        if (!aux_color)
+        {
+            return 0 == std::memcmp(generic.data(), cloud.data.data(), generic.size());
+        }
+
+        //
+        // The color is the last field of every pointcloud
+
+        const size_t color_offset = cloud.fields.back().offset;
+
+        for (size_t offset = 0 ; offset < generic.size() ; offset += cloud.point_step)
+        {
+            if (0 != std::memcmp(&(generic[offset]), &(cloud.data[offset]), color_offset))
+            {
+                return false;
+            }
+
+            for (size_t channel = 0 ; channel < 3 ; ++channel)
+            {
+                const size_t index = offset + color_offset + channel;
+                if (std::abs(static_cast<int>(generic[index]) - static_cast<int>(cloud.data[index])) > 1)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool matchesGeneric(uint32_t outputs, StereoPointCloudKernel kernel)
+    {
+        const size_t generic_points = genericPointCloudLoop(frame, *manager, aux_camera_info, outputs, row_buffer.data());
+
+        std::vector<std::vector<uint8_t>> generic_data;
+        for (const auto cloud : outputClouds(outputs))
+        {
+            generic_data.push_back(cloud->data);
+            std::fill(cloud->data.begin(), cloud->data.end(), 0);
+        }
+
+        const size_t points = kernel(frame, 0, disparity.height, 0, row_buffer.data());
+
+        if (points != generic_points)
+        {
+            return false;
+        }
+
+        const auto clouds = outputClouds(outputs);
+        for (size_t i = 0 ; i < clouds.size() ; ++i)
+        {
+            const bool aux_color = (outputs & AUX_COLOR) &&
+                                   (clouds[i] == &color_point_cloud || clouds[i] == &color_organized_point_cloud ||
+                                    clouds[i] == &luma_color_organized_point_cloud);
+
+            if (!matchingPoints(generic_data[i], *clouds[i], aux_color))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    const crl::multisense::system::DeviceInfo device_info;
+    std::shared_ptr<StereoCalibrationManger> manager;
+    const std::shared_ptr<const RayTableT> ray_table;
+    const std::shared_ptr<const AuxProjectionTableT> aux_projection_table;
+    const ColorPixelMapT aux_pixel_map;
+    const sensor_msgs::CameraInfo aux_camera_info;
+    const BorderClipMaskT border_clip;
+    const std::vector<uint16_t> disparity_data;
+    const std::vector<uint8_t> luma_data;
+    const std::vector<uint8_t> chroma_data;
+    const crl::multisense::image::Header disparity;
+    const crl::multisense::image::Header luma;
+    const crl::multisense::image::Header chroma;
+    const Ycbcr420ImageT color;
+    const std::shared_ptr<RectificationRemapT> color_remap;
+    cv::Mat rectified_color;
+    std::vector<float> row_buffer;
+
+    sensor_msgs::PointCloud2 luma_point_cloud;
+    sensor_msgs::PointCloud2 color_point_cloud;
+    sensor_msgs::PointCloud2 luma_organized_point_cloud;
+    sensor_msgs::PointCloud2 color_organized_point_cloud;
+    sensor_msgs::PointCloud2 luma_color_organized_point_cloud;
+
+    StereoPointCloudFrameT frame;
+};
+
+void BM_genericPointCloudLoop(benchmark::State &state)
+{
+    const uint32_t outputs = state.range(2);
+
+    PointCloudFixture fixture(state.range(0), state.range(1), static_cast<BorderClip>(state.range(3)));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(genericPointCloudLoop(fixture.frame, *fixture.manager, fixture.aux_camera_info, outputs,
+                                                       fixture.row_buffer.data()));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+
+void BM_specializedPointCloudKernel(benchmark::State &state)
+{
+    const uint32_t outputs = state.range(2);
+
+    PointCloudFixture fixture(state.range(0), state.range(1), static_cast<BorderClip>(state.range(3)));
+
+    const auto kernel = selectStereoPointCloudKernel(outputs, fixture.disparity.bitsPerPixel,
+                                                     fixture.luma.bitsPerPixel);
+
+    if (!fixture.matchesGeneric(outputs, kernel))
+    {
+        state.SkipWithError("specialized kernel output does not match the generic pointcloud loop");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kernel(fixture.frame, 0, fixture.disparity.height, 0, fixture.row_buffer.data()));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+
+void subscriberCombinations(benchmark::internal::Benchmark *benchmark)
+{
+    for (const auto &resolution : {std::make_pair(1920, 1200), std::make_pair(960, 600)})
+    {
+        for (uint32_t outputs = LUMA_POINTCLOUD ; outputs <= ALL_STEREO_POINTCLOUD_OUTPUTS ; ++outputs)
+        {
+            if (0 == (outputs & ~(AUX_COLOR | SPARSE_COLOR)))
+            {
+                continue;
+            }
+
+            //
+            // Sparse coloring only applies to color pointclouds colored by the left camera
+
+            if ((outputs & SPARSE_COLOR) &&
+                ((outputs & AUX_COLOR) ||
+                 0 == (outputs & (COLOR_POINTCLOUD | COLOR_ORGANIZED_POINTCLOUD | LUMA_COLOR_ORGANIZED_POINTCLOUD))))
+            {
+                continue;
+            }
+
+            //
+            // The luma and color pointcloud replaces both organized pointclouds, so it is compared against them
+            // rather than combined with the other pointclouds
+
+            if ((outputs & LUMA_COLOR_ORGANIZED_POINTCLOUD) &&
+                (outputs & ~(LUMA_COLOR_ORGANIZED_POINTCLOUD | AUX_COLOR | SPARSE_COLOR)))
+            {
+                continue;
+            }
+
+            benchmark->Args({resolution.first, resolution.second, outputs, static_cast<int>(BorderClip::NONE)});
+        }
+
+        const uint32_t all_outputs = LUMA_POINTCLOUD | COLOR_POINTCLOUD | LUMA_ORGANIZED_POINTCLOUD |
+                                     COLOR_ORGANIZED_POINTCLOUD;
+
+        benchmark->Args({resolution.first, resolution.second, all_outputs, static_cast<int>(BorderClip::RECTANGULAR)});
+        benchmark->Args({resolution.first, resolution.second, all_outputs, static_cast<int>(BorderClip::CIRCULAR)});
+    }
+
+    benchmark->ArgNames({"width", "height", "outputs", "clip"});
+}
+
+}// namespace
+
+BENCHMARK(BM_genericPointCloudLoop)->Apply(subscriberCombinations)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_specializedPointCloudKernel)->Apply(subscriberCombinations)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,209 @@
+/**
+ * @file reprojection_benchmark.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <multisense_ros/camera_utilities.h>
+
+#include "synthetic_data.h"
+
+using namespace multisense_ros;
+
+namespace {
+
+//
+// Maximum difference between the row kernel and StereoCalibrationManger::reproject relative to the range of each
+// point
+
+static constexpr double REPROJECTION_TOLERANCE = 1e-5;
+
+template <typename T>
+struct ReprojectionFixture
+{
+    ReprojectionFixture(uint32_t width, uint32_t height):
+        width(width),
+        height(height),
+        device_info(synthetic::makeDeviceInfo()),
+        manager(std::make_shared<StereoCalibrationManger>(synthetic::makeConfig(width, height),
+                                                          synthetic::makeCalibration(),
+                                                          device_info)),
+        left_camera_info(manager->leftCameraInfo("left", ros::Time())),
+        right_camera_info(manager->rightCameraInfo("right", ros::Time())),
+        ray_table(manager->rayTable()),
+        disparity(synthetic::makeDisparity<T>(width, height)),
+        points(3 * width * height)
+    {
+    }
+
+    float disparityPixels(size_t index) const
+    {
+        return sizeof(T) == sizeof(uint16_t) ? static_cast<float>(disparity[index]) / 16.0f :
+                                               static_cast<float>(disparity[index]);
+    }
+
+    void reprojectRows(SimdLevel level)
+    {
+        for (size_t v = 0 ; v < height ; ++v)
+        {
+            float *x = &(points[3 * v * width]);
+            reprojectDisparityRow(&(disparity[v * width]), v, width, *ray_table, x, x + width, x + 2 * width, level);
+        }
+    }
+
+    bool matchesReference()
+    {
+        for (size_t v = 0 ; v < height ; ++v)
+        {
+            const float *x = &(points[3 * v * width]);
+            const float *y = x + width;
+            const float *z = y + width;
+
+            for (size_t u = 0 ; u < width ; ++u)
+            {
+                const Eigen::Vector3f reference = manager->reproject(u, v, disparityPixels(v * width + u),
+                                                                     left_camera_info, right_camera_info);
+                const Eigen::Vector3f point(x[u], y[u], z[u]);
+
+                if (reference.x() == std::numeric_limits<float>::max())
+                {
+                    if (point != reference)
+                    {
+                        return false;
+                    }
+
+                    continue;
+                }
+
+                const double tolerance = REPROJECTION_TOLERANCE * reference.norm();
+                if ((point - reference).cwiseAbs().maxCoeff() > tolerance)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    const uint32_t width;
+    const uint32_t height;
+    const crl::multisense::system::DeviceInfo device_info;
+    std::shared_ptr<StereoCalibrationManger> manager;
+    const sensor_msgs::CameraInfo left_camera_info;
+    const sensor_msgs::CameraInfo right_camera_info;
+    const std::shared_ptr<const RayTableT> ray_table;
+    const std::vector<T> disparity;
+    std::vector<float> points;
+};
+
+template <typename T>
+void BM_reprojectPerPixel(benchmark::State &state)
+{
+    ReprojectionFixture<T> fixture(state.range(0), state.range(1));
+
+    for (auto _ : state)
+    {
+        for (size_t v = 0 ; v < fixture.height ; ++v)
+        {
+            for (size_t u = 0 ; u < fixture.width ; ++u)
+            {
+                const Eigen::Vector3f point = fixture.manager->reproject(u, v, fixture.disparityPixels(v * fixture.width + u),
+                                                                         fixture.left_camera_info,
+                                                                         fixture.right_camera_info);
+                benchmark::DoNotOptimize(point);
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * fixture.width * fixture.height);
+}
+
+template <typename T>
+void BM_reprojectDisparityRow(benchmark::State &state)
+{
+    const SimdLevel level = static_cast<SimdLevel>(state.range(2));
+    if (level > simdLevel())
+    {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+
+    ReprojectionFixture<T> fixture(state.range(0), state.range(1));
+
+    fixture.reprojectRows(level);
+    if (!fixture.matchesReference())
+    {
+        state.SkipWithError("reprojected points do not match StereoCalibrationManger::reproject");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        fixture.reprojectRows(level);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetLabel(simdLevelString(level));
+    state.SetItemsProcessed(state.iterations() * fixture.width * fixture.height);
+}
+
+void resolutions(benchmark::internal::Benchmark *benchmark)
+{
+    for (const auto &resolution : synthetic::RESOLUTIONS)
+    {
+        benchmark->Args({resolution.first, resolution.second});
+    }
+}
+
+void resolutionsAndSimdLevels(benchmark::internal::Benchmark *benchmark)
+{
+    for (const auto &level : {SimdLevel::SCALAR, SimdLevel::SSE4, SimdLevel::AVX2})
+    {
+        for (const auto &resolution : synthetic::RESOLUTIONS)
+        {
+            benchmark->Args({resolution.first, resolution.second, static_cast<int64_t>(level)});
+        }
+    }
+}
+
+}// namespace
+
+BENCHMARK_TEMPLATE(BM_reprojectPerPixel, uint16_t)->Apply(resolutions)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_reprojectPerPixel, float)->Apply(resolutions)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_reprojectDisparityRow, uint16_t)->Apply(resolutionsAndSimdLevels)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_reprojectDisparityRow, float)->Apply(resolutionsAndSimdLevels)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,240 @@
+/**
+ * @file synthetic_data.h
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef MULTISENSE_ROS_BENCHMARK_SYNTHETIC_DATA_H
+#define MULTISENSE_ROS_BENCHMARK_SYNTHETIC_DATA_H
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <multisense_lib/MultiSenseTypes.hh>
+
+namespace multisense_ros {
+namespace synthetic {
+
+//
+// Full resolution imager geometry of a synthetic S30-like sensor
+
+static constexpr uint32_t IMAGER_WIDTH = 1920;
+static constexpr uint32_t IMAGER_HEIGHT = 1200;
+static constexpr double FOCAL_LENGTH = 1500.0;
+static constexpr double BASELINE = 0.27;
+
+//
+// Operating resolutions supported by the S30 (1920x1200 imagers) and S21/SL (2048x1088 imagers) families
+
+static const std::vector<std::pair<int64_t, int64_t>> RESOLUTIONS = {{1920, 1200}, {960, 600}, {480, 300},
+                                                                     {2048, 1088}, {1024, 544}};
+
+inline crl::multisense::system::DeviceInfo makeDeviceInfo()
+{
+    crl::multisense::system::DeviceInfo device_info;
+    device_info.imagerWidth = IMAGER_WIDTH;
+    device_info.imagerHeight = IMAGER_HEIGHT;
+
+    return device_info;
+}
+
+inline crl::multisense::image::Config makeConfig(uint32_t width, uint32_t height)
+{
+    crl::multisense::image::Config config;
+    config.setResolution(width, height);
+
+    return config;
+}
+
+inline crl::multisense::image::Calibration::Data makeCalibrationData(double tx)
+{
+    crl::multisense::image::Calibration::Data data;
+
+    for (size_t r = 0 ; r < 3 ; ++r)
+    {
+        for (size_t c = 0 ; c < 3 ; ++c)
+        {
+            data.M[r][c] = 0.0f;
+            data.R[r][c] = (r == c) ? 1.0f : 0.0f;
+        }
+
+        for (size_t c = 0 ; c < 4 ; ++c)
+        {
+            data.P[r][c] = 0.0f;
+        }
+    }
+
+    for (size_t i = 0 ; i < 8 ; ++i)
+    {
+        data.D[i] = 0.0f;
+    }
+
+    data.M[0][0] = FOCAL_LENGTH;
+    data.M[0][2] = IMAGER_WIDTH / 2.0;
+    data.M[1][1] = FOCAL_LENGTH;
+    data.M[1][2] = IMAGER_HEIGHT / 2.0;
+    data.M[2][2] = 1.0f;
+
+    data.P[0][0] = FOCAL_LENGTH;
+    data.P[0][2] = IMAGER_WIDTH / 2.0 + 3.5;
+    data.P[0][3] = FOCAL_LENGTH * tx;
+    data.P[1][1] = FOCAL_LENGTH;
+    data.P[1][2] = IMAGER_HEIGHT / 2.0 - 2.25;
+    data.P[2][2] = 1.0f;
+
+    return data;
+}
+
+inline crl::multisense::image::Calibration makeCalibration()
+{
+    crl::multisense::image::Calibration calibration;
+    calibration.left = makeCalibrationData(0.0);
+    calibration.right = makeCalibrationData(-BASELINE);
+    calibration.aux = makeCalibrationData(-0.033);
+
+    return calibration;
+}
+
+///
+/// @brief Create a random disparity image. Roughly 10% of the pixels are invalid (zero disparity)
+///
+template <typename T>
+std::vector<T> makeDisparity(uint32_t width, uint32_t height, float max_disparity = 256.0f)
+{
+    std::mt19937 generator(width * height);
+    std::uniform_real_distribution<float> distribution(0.0f, max_disparity);
+    std::uniform_real_distribution<float> invalid(0.0f, 1.0f);
+
+    const float scale = sizeof(T) == sizeof(uint16_t) ? 16.0f : 1.0f;
+
+    std::vector<T> disparity(width * height);
+    for (auto &d : disparity)
+    {
+        d = invalid(generator) < 0.1f ? static_cast<T>(0) : static_cast<T>(scale * distribution(generator));
+    }
+
+    return disparity;
+}
+
+///
+/// @brief Create a random 8 bit image
+///
+inline std::vector<uint8_t> makeLuma(uint32_t width, uint32_t height)
+{
+    std::mt19937 generator(width + height);
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    std::vector<uint8_t> luma(width * height);
+    for (auto &l : luma)
+    {
+        l = static_cast<uint8_t>(distribution(generator));
+    }
+
+    return luma;
+}
+
+///
+/// @brief Create a random interleaved CbCr chroma image which accompanies a luma image of width x height
+///
+inline std::vector<uint8_t> makeChroma(uint32_t width, uint32_t height)
+{
+    std::mt19937 generator(width * height);
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    std::vector<uint8_t> chroma(2 * (width / 2) * (height / 2));
+    for (auto &c : chroma)
+    {
+        c = static_cast<uint8_t>(distribution(generator));
+    }
+
+    return chroma;
+}
+
+///
+/// @brief Create a random ground surface class image. Values span the unknown, out of bounds, obstacle, and free
+///        space classes
+///
+inline std::vector<uint8_t> makeGroundSurfaceClasses(uint32_t width, uint32_t height)
+{
+    std::mt19937 generator(width + height);
+    std::uniform_int_distribution<int> distribution(0, 3);
+
+    std::vector<uint8_t> classes(width * height);
+    for (auto &c : classes)
+    {
+        c = static_cast<uint8_t>(distribution(generator));
+    }
+
+    return classes;
+}
+
+///
+/// @brief Create a random CV_8UC3 image
+///
+inline cv::Mat makeColorImage(uint32_t width, uint32_t height)
+{
+    cv::Mat image(height, width, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+
+    return image;
+}
+
+///
+/// @brief Wrap an image buffer in a image header as if it was received from the sensor
+///
+template <typename T>
+crl::multisense::image::Header makeImageHeader(crl::multisense::DataSource source,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               const std::vector<T> &data,
+                                               int64_t frame_id = 1)
+{
+    crl::multisense::image::Header header;
+    header.source = source;
+    header.bitsPerPixel = 8 * sizeof(T);
+    header.width = width;
+    header.height = height;
+    header.frameId = frame_id;
+    header.timeSeconds = 1;
+    header.timeMicroSeconds = 0;
+    header.imageLength = static_cast<uint32_t>(data.size() * sizeof(T));
+    header.imageDataP = data.data();
+
+    return header;
+}
+
+}// namespace synthetic
+}// namespace
+
+#endif
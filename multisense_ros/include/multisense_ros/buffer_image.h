@@ -0,0 +1,231 @@
+/**
+ * @file buffer_image.h
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef MULTISENSE_ROS_BUFFER_IMAGE_H
+#define MULTISENSE_ROS_BUFFER_IMAGE_H
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ros/message_traits.h>
+#include <ros/serialization.h>
+#include <sensor_msgs/Image.h>
+#include <std_msgs/Header.h>
+
+#include <multisense_lib/MultiSenseChannel.hh>
+#include <multisense_ros/camera_utilities.h>
+
+namespace multisense_ros {
+
+///
+/// @brief Image message which references its pixel data instead of owning a copy. The message serializes exactly like
+///        a sensor_msgs/Image and can be published on any Image topic. Intra-process subscribers which subscribe with
+///        this type receive the referenced data without a copy, every other subscriber receives a sensor_msgs/Image
+///
+struct BufferImage
+{
+    typedef boost::shared_ptr<BufferImage> Ptr;
+    typedef boost::shared_ptr<const BufferImage> ConstPtr;
+
+    std_msgs::Header header;
+
+    uint32_t height = 0;
+    uint32_t width = 0;
+    std::string encoding;
+    uint8_t is_bigendian = 0;
+    uint32_t step = 0;
+
+    const uint8_t *data = nullptr;
+    uint32_t size = 0;
+
+    //
+    // Keeps data valid for the lifetime of the message
+
+    std::shared_ptr<const void> owner;
+};
+
+///
+/// @brief Limits the number of LibMultiSense callback buffers held by outstanding zero-copy messages. LibMultiSense
+///        has a fixed pool of callback buffers and stops dispatching images once every buffer is reserved, so
+///        zero-copy publishing falls back to copying whenever the limit is reached
+///
+class CallbackBufferLimiter
+{
+public:
+
+    CallbackBufferLimiter(crl::multisense::Channel* driver, size_t max_buffers);
+
+    ///
+    /// @brief Reserve the callback buffer of the image currently being dispatched. Must be called from within the
+    ///        image callback, or within a DispatchedImageScope for the image. Returns nullptr if max_buffers are already
+    ///        reserved. The buffer is released once the last copy of the returned pointer is destroyed, which must
+    ///        happen before the channel is destroyed
+    ///
+    std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>> reserve(const crl::multisense::image::Header& header);
+
+    ///
+    /// @brief The number of callback buffers currently reserved
+    ///
+    size_t outstanding() const noexcept;
+
+private:
+
+    crl::multisense::Channel* driver_ = nullptr;
+    const size_t max_buffers_ = 0;
+
+    //
+    // Shared with the deleter of each reservation, which may outlive the limiter
+
+    std::shared_ptr<std::atomic<size_t>> outstanding_;
+};
+
+///
+/// @brief Marks the reserved callback buffer of an image whose callback runs on a worker thread instead of a driver
+///        callback thread. LibMultiSense can only reserve a buffer from within its own callback, so while a scope is
+///        alive CallbackBufferLimiter::reserve calls for that image on the same thread share the existing reservation
+///
+class DispatchedImageScope
+{
+public:
+
+    explicit DispatchedImageScope(const std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>> &image);
+    ~DispatchedImageScope();
+
+    ///
+    /// @brief The reservation of the image being processed on this thread, or nullptr outside of a scope
+    ///
+    static const std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>>* current() noexcept;
+
+private:
+
+    DispatchedImageScope(const DispatchedImageScope&) = delete;
+    DispatchedImageScope operator=(const DispatchedImageScope&) = delete;
+
+    const std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>> *previous_ = nullptr;
+};
+
+}// namespace
+
+namespace ros {
+namespace message_traits {
+
+template<> struct IsMessage<multisense_ros::BufferImage> : TrueType {};
+template<> struct IsMessage<const multisense_ros::BufferImage> : TrueType {};
+template<> struct HasHeader<multisense_ros::BufferImage> : TrueType {};
+template<> struct HasHeader<const multisense_ros::BufferImage> : TrueType {};
+
+template<>
+struct MD5Sum<multisense_ros::BufferImage>
+{
+    static const char* value() { return MD5Sum<sensor_msgs::Image>::value(); }
+    static const char* value(const multisense_ros::BufferImage&) { return value(); }
+};
+
+template<>
+struct DataType<multisense_ros::BufferImage>
+{
+    static const char* value() { return DataType<sensor_msgs::Image>::value(); }
+    static const char* value(const multisense_ros::BufferImage&) { return value(); }
+};
+
+template<>
+struct Definition<multisense_ros::BufferImage>
+{
+    static const char* value() { return Definition<sensor_msgs::Image>::value(); }
+    static const char* value(const multisense_ros::BufferImage&) { return value(); }
+};
+
+} // namespace message_traits
+
+namespace serialization {
+
+template<>
+struct Serializer<multisense_ros::BufferImage>
+{
+    template<typename Stream>
+    inline static void write(Stream& stream, const multisense_ros::BufferImage& m)
+    {
+        stream.next(m.header);
+        stream.next(m.height);
+        stream.next(m.width);
+        stream.next(m.encoding);
+        stream.next(m.is_bigendian);
+        stream.next(m.step);
+        stream.next(m.size);
+        if (m.size > 0) {
+            memcpy(stream.advance(m.size), m.data, m.size);
+        }
+    }
+
+    template<typename Stream>
+    inline static void read(Stream& stream, multisense_ros::BufferImage& m)
+    {
+        stream.next(m.header);
+        stream.next(m.height);
+        stream.next(m.width);
+        stream.next(m.encoding);
+        stream.next(m.is_bigendian);
+        stream.next(m.step);
+        stream.next(m.size);
+
+        const auto data = std::make_shared<std::vector<uint8_t>>(m.size);
+        if (m.size > 0) {
+            memcpy(data->data(), stream.advance(m.size), m.size);
+        }
+
+        m.data = data->data();
+        m.owner = data;
+    }
+
+    inline static uint32_t serializedLength(const multisense_ros::BufferImage& m)
+    {
+        return serializationLength(m.header) +
+               serializationLength(m.height) +
+               serializationLength(m.width) +
+               serializationLength(m.encoding) +
+               serializationLength(m.is_bigendian) +
+               serializationLength(m.step) +
+               serializationLength(m.size) +
+               m.size;
+    }
+};
+
+} // namespace serialization
+} // namespace ros
+
+#endif
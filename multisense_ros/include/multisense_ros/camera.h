@@ -34,9 +34,13 @@
 #ifndef MULTISENSE_ROS_CAMERA_H
 #define MULTISENSE_ROS_CAMERA_H
 
+#include <atomic>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 
 #include <ros/ros.h>
 
@@ -52,15 +56,25 @@
 
 #include <multisense_lib/MultiSenseChannel.hh>
 #include <multisense_ros/RawCamData.h>
+#include <multisense_ros/buffer_image.h>
 #include <multisense_ros/camera_utilities.h>
+#include <multisense_ros/frame_assembler.h>
+#include <multisense_ros/latency_metrics.h>
+#include <multisense_ros/LatencyMetrics.h>
 #include <multisense_ros/ground_surface_utilities.h>
+#include <multisense_ros/parallel_utilities.h>
+#include <multisense_ros/point_cloud_utilities.h>
+#include <multisense_ros/stereo_point_cloud_utilities.h>
 
 namespace multisense_ros {
 
 class Camera {
 public:
     Camera(crl::multisense::Channel* driver,
-           const std::string& tf_prefix);
+           const std::string& tf_prefix,
+           const ros::NodeHandle& nh = ros::NodeHandle(""),
+           const ros::NodeHandle& private_nh = ros::NodeHandle("~"),
+           const std::shared_ptr<LatencyRegistry>& latency_registry = nullptr);
     ~Camera();
 
     void updateConfig(const crl::multisense::image::Config& config);
@@ -68,16 +82,32 @@ public:
     void monoCallback(const crl::multisense::image::Header& header);
     void rectCallback(const crl::multisense::image::Header& header);
     void depthCallback(const crl::multisense::image::Header& header);
-    void pointCloudCallback(const crl::multisense::image::Header& header);
-    void rawCamDataCallback(const crl::multisense::image::Header& header);
-    void colorImageCallback(const crl::multisense::image::Header& header);
+    void pointCloudCallback(const AssembledFrame& frame);
+    void rawCamDataCallback(const AssembledFrame& frame);
+    void colorImageCallback(const crl::multisense::image::Header& luma, const crl::multisense::image::Header& chroma);
     void disparityImageCallback(const crl::multisense::image::Header& header);
     void jpegImageCallback(const crl::multisense::image::Header& header);
     void histogramCallback(const crl::multisense::image::Header& header);
-    void colorizeCallback(const crl::multisense::image::Header& header);
+    void assembleCallback(const crl::multisense::image::Header& header);
     void groundSurfaceCallback(const crl::multisense::image::Header& header);
     void groundSurfaceSplineCallback(const crl::multisense::ground_surface::Header& header);
 
+    ///
+    /// @brief Run an image callback on the worker pool queue with the given name, or immediately on the calling
+    ///        driver thread if the worker pool is disabled. Must be called from within the driver image callback
+    ///
+    void dispatch(const std::string& queue,
+                  const crl::multisense::image::Header& header,
+                  void (Camera::*callback)(const crl::multisense::image::Header&));
+
+    ///
+    /// @brief Run an assembled frame callback on the worker pool queue with the given name, or immediately if the
+    ///        worker pool is disabled
+    ///
+    void dispatch(const std::string& queue,
+                  const AssembledFrame& frame,
+                  const std::function<void(const AssembledFrame&)>& callback);
+
     void borderClipChanged(const BorderClip &borderClipType, double borderClipValue);
 
     void maxPointCloudRangeChanged(double range);
@@ -117,6 +147,7 @@ private:
     static constexpr char RAW_CAM_CONFIG_TOPIC[] = "raw_cam_config";
     static constexpr char RAW_CAM_DATA_TOPIC[] = "raw_cam_data";
     static constexpr char HISTOGRAM_TOPIC[] = "histogram";
+    static constexpr char LATENCY_METRICS_TOPIC[] = "latency_metrics";
     static constexpr char MONO_TOPIC[] = "image_mono";
     static constexpr char RECT_TOPIC[] = "image_rect";
     static constexpr char DISPARITY_TOPIC[] = "disparity";
@@ -126,10 +157,17 @@ private:
     static constexpr char COST_TOPIC[] = "cost";
     static constexpr char COLOR_TOPIC[] = "image_color";
     static constexpr char RECT_COLOR_TOPIC[] = "image_rect_color";
+    static constexpr char JPEG_COLOR_TOPIC[] = "image_color_jpeg/compressed";
+    static constexpr char HALF_COLOR_TOPIC[] = "image_color_half";
+    static constexpr char QUARTER_COLOR_TOPIC[] = "image_color_quarter";
+    static constexpr char EIGHTH_COLOR_TOPIC[] = "image_color_eighth";
+    static constexpr char NV12_TOPIC[] = "image_nv12";
+    static constexpr char RECT_NV12_TOPIC[] = "image_rect_nv12";
     static constexpr char POINTCLOUD_TOPIC[] = "image_points2";
     static constexpr char COLOR_POINTCLOUD_TOPIC[] = "image_points2_color";
     static constexpr char ORGANIZED_POINTCLOUD_TOPIC[] = "organized_image_points2";
     static constexpr char COLOR_ORGANIZED_POINTCLOUD_TOPIC[] = "organized_image_points2_color";
+    static constexpr char LUMA_COLOR_ORGANIZED_POINTCLOUD_TOPIC[] = "organized_image_points2_luma_color";
     static constexpr char MONO_CAMERA_INFO_TOPIC[] = "image_mono/camera_info";
     static constexpr char RECT_CAMERA_INFO_TOPIC[] = "image_rect/camera_info";
     static constexpr char COLOR_CAMERA_INFO_TOPIC[] = "image_color/camera_info";
@@ -141,6 +179,21 @@ private:
     static constexpr char GROUND_SURFACE_INFO_TOPIC[] = "camera_info";
     static constexpr char GROUND_SURFACE_POINT_SPLINE_TOPIC[] = "spline";
 
+    //
+    // Default limit on the number of driver buffers held by zero-copy images
+
+    static constexpr int DEFAULT_MAX_ZERO_COPY_BUFFERS = 8;
+
+    //
+    // Default limit on the number of partially received frames held for pointclouds and color images
+
+    static constexpr int DEFAULT_MAX_ASSEMBLED_FRAMES = 4;
+
+    //
+    // Default number of images each worker pool queue holds before dropping the oldest
+
+    static constexpr int DEFAULT_WORKER_QUEUE_DEPTH = 2;
+
 
     //
     // Device stream control
@@ -155,6 +208,16 @@ private:
 
     void publishAllCameraInfo();
 
+    //
+    // Publish an image which references the driver buffer of the image instead of a copy. Returns false if zero-copy
+    // publishing is disabled for the image source, the image has no raw topic subscribers, any image transport
+    // plugin topic has subscribers, or every available buffer is already held by subscribers, in which case the
+    // caller needs to copy and publish the image through image transport itself
+
+    bool publishBufferImage(const crl::multisense::image::Header& header,
+                            const std::string& frame_id,
+                            const ros::Time& stamp);
+
     //
     // CRL sensor API
 
@@ -205,8 +268,23 @@ private:
     image_transport::Publisher       aux_mono_cam_pub_;
     image_transport::CameraPublisher aux_rect_cam_pub_;
     image_transport::CameraPublisher aux_rgb_rect_cam_pub_;
+    image_transport::Publisher       left_nv12_cam_pub_;
+    image_transport::Publisher       aux_nv12_cam_pub_;
+    image_transport::Publisher       aux_nv12_rect_cam_pub_;
     image_transport::Publisher       ground_surface_cam_pub_;
 
+    //
+    // Reduced resolution color images decoded from the sensor JPEG with DCT domain scaling. Each publisher decodes at
+    // 1/denominator of the full resolution
+
+    struct ScaledColorPublisherT
+    {
+        int denominator = 1;
+        image_transport::CameraPublisher publisher;
+    };
+
+    std::vector<ScaledColorPublisherT> left_rgb_scaled_cam_pubs_;
+
     ros::Publisher                   left_mono_cam_info_pub_;
     ros::Publisher                   right_mono_cam_info_pub_;
     ros::Publisher                   left_rect_cam_info_pub_;
@@ -215,6 +293,7 @@ private:
     ros::Publisher                   right_disp_cam_info_pub_;
     ros::Publisher                   left_cost_cam_info_pub_;
     ros::Publisher                   left_rgb_cam_info_pub_;
+    ros::Publisher                   left_rgb_jpeg_pub_;
     ros::Publisher                   left_rgb_rect_cam_info_pub_;
     ros::Publisher                   depth_cam_info_pub_;
     ros::Publisher                   aux_mono_cam_info_pub_;
@@ -229,6 +308,7 @@ private:
 
     ros::Publisher                   luma_organized_point_cloud_pub_;
     ros::Publisher                   color_organized_point_cloud_pub_;
+    ros::Publisher                   luma_color_organized_point_cloud_pub_;
 
     image_transport::Publisher       left_disparity_pub_;
     image_transport::Publisher       right_disparity_pub_;
@@ -237,6 +317,25 @@ private:
     ros::Publisher                   left_stereo_disparity_pub_;
     ros::Publisher                   right_stereo_disparity_pub_;
 
+    //
+    // Zero-copy publishers for the raw mono, rectified, disparity, and cost images keyed by image source. Each is
+    // advertised on the raw topic of the corresponding image transport, and counts the subscribers of every topic of
+    // that transport
+
+    struct BufferImagePublisher
+    {
+        ros::Publisher raw;
+        std::function<uint32_t()> transport_subscribers;
+    };
+
+    std::unordered_map<crl::multisense::DataSource, BufferImagePublisher> buffer_image_pubs_;
+
+    //
+    // Limits the driver buffers held by zero-copy images and pending assembled frames. Null if zero-copy publishing is
+    // disabled
+
+    std::unique_ptr<CallbackBufferLimiter> callback_buffer_limiter_;
+
     //
     // Raw data publishers
 
@@ -245,41 +344,54 @@ private:
     ros::Publisher raw_cam_cal_pub_;
     ros::Publisher device_info_pub_;
     ros::Publisher histogram_pub_;
+    ros::Publisher latency_metrics_pub_;
 
     //
-    // Store outgoing messages for efficiency
+    // Pointcloud message templates. Each outgoing pointcloud is a new message which copies its point fields from
+    // these templates, so published messages can be shared with intra-process subscribers without a copy
 
-    sensor_msgs::Image         left_mono_image_;
-    sensor_msgs::Image         right_mono_image_;
-    sensor_msgs::Image         left_rect_image_;
-    sensor_msgs::Image         right_rect_image_;
-    sensor_msgs::Image         depth_image_;
-    sensor_msgs::Image         ni_depth_image_;
     sensor_msgs::PointCloud2   luma_point_cloud_;
     sensor_msgs::PointCloud2   color_point_cloud_;
     sensor_msgs::PointCloud2   luma_organized_point_cloud_;
     sensor_msgs::PointCloud2   color_organized_point_cloud_;
+    sensor_msgs::PointCloud2   luma_color_organized_point_cloud_;
+
+    //
+    // Scratch images for converting and rectifying color images. Each is only used by a single callback, which never
+    // runs concurrently with itself: assembled images are inserted from one driver thread, and a worker queue runs its
+    // tasks in order
+
+    std::vector<uint8_t> pointcloud_color_buffer_;
+    std::vector<uint8_t> pointcloud_rect_color_buffer_;
+    std::vector<uint8_t> left_color_buffer_;
+    std::vector<uint8_t> jpeg_rgb_buffer_;
 
-    sensor_msgs::Image         aux_mono_image_;
-    sensor_msgs::Image         left_rgb_image_;
-    sensor_msgs::Image         aux_rgb_image_;
-    sensor_msgs::Image         left_rgb_rect_image_;
-    sensor_msgs::Image         aux_rect_image_;
-    sensor_msgs::Image         aux_rgb_rect_image_;
+    //
+    // Scratch space for one row of reprojected x, y, and z coordinates per pointcloud band
 
-    sensor_msgs::Image         left_disparity_image_;
-    sensor_msgs::Image         left_disparity_cost_image_;
-    sensor_msgs::Image         right_disparity_image_;
+    std::vector<float> pointcloud_row_buffer_;
 
-    stereo_msgs::DisparityImage left_stereo_disparity_;
-    stereo_msgs::DisparityImage right_stereo_disparity_;
+    //
+    // Threads used to generate pointclouds, and the index of the first point and the number of valid points written
+    // by each band of rows
 
-    sensor_msgs::Image         ground_surface_image_;
+    std::unique_ptr<RowBandExecutor> pointcloud_executor_;
+    std::vector<std::pair<size_t, size_t>> pointcloud_band_points_;
 
-    multisense_ros::RawCamData raw_cam_data_;
+    //
+    // Threads used to convert YCbCr images to BGR
 
-    std::vector<uint8_t> pointcloud_color_buffer_;
-    std::vector<uint8_t> pointcloud_rect_color_buffer_;
+    std::unique_ptr<RowBandExecutor> color_executor_;
+
+    //
+    // Valid columns of each disparity row after border clipping
+
+    BorderClipMaskT pointcloud_border_clip_;
+
+    //
+    // Nearest rectified aux pixel of each disparity pixel, used to color points without a valid disparity
+
+    ColorPixelMapT pointcloud_aux_pixel_map_;
 
     //
     // Calibration from sensor
@@ -314,11 +426,23 @@ private:
     std::mutex stream_lock_;
     StreamMapType stream_map_;
 
+    //
+    // Calibration dependent fields of the stereo_msgs::DisparityImage messages. Shared by the left and right disparity
+    // images and rebuilt by updateConfig
+
+    std::mutex stereo_disparity_template_lock_;
+    std::shared_ptr<const stereo_msgs::DisparityImage> stereo_disparity_template_;
+
     //
     // Max distance from the camera for a point to be considered valid
 
     double pointcloud_max_range_ = 15.0;
 
+    //
+    // Publish luma pointcloud intensities as float32 values rather than the raw bits of the integer luma
+
+    bool pointcloud_float_intensity_ = false;
+
     //
     // Histogram tracking
 
@@ -336,9 +460,27 @@ private:
     ground_surface_utilities::SplineDrawParameters spline_draw_params_;
 
     //
-    // Storage of images which we use for pointcloud colorizing
+    // Point layout of the ground surface spline pointcloud
+
+    PointLayout ground_surface_spline_layout_ = PointLayout::XYZ_CHANNELS;
+
+    //
+    // Groups the images which we use for pointclouds, raw cam data, and color images by frame
+
+    std::unique_ptr<FrameAssembler> frame_assembler_;
+
+    //
+    // Optional pool of threads which processes images off of the driver callback threads
+
+    std::unique_ptr<WorkerPool> worker_pool_;
+
+    //
+    // Processing time and sensor-to-publish latency of each dispatched callback. The registry may be shared with the
+    // other sensor interfaces so their latencies are reported here as well
 
-    std::unordered_map<crl::multisense::DataSource, std::shared_ptr<BufferWrapper<crl::multisense::image::Header>>> image_buffers_;
+    std::shared_ptr<LatencyRegistry> latency_registry_;
+    std::map<std::pair<std::string, crl::multisense::DataSource>, LatencyTracker*> latency_trackers_;
+    std::vector<LatencyRegistry::TopicSummaryT> latency_summaries_;
 
     //
     // Has a 3rd aux color camera
@@ -350,6 +492,16 @@ private:
     diagnostic_updater::Updater diagnostic_updater_;
     void deviceInfoDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat);
     void deviceStatusDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat);
+    void frameAssemblerDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat);
+    void workerPoolDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat);
+    void latencyDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat);
+    void jpegDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat);
+
+    //
+    // JPEG decoding statistics
+
+    std::atomic<uint64_t> jpeg_decoded_frames_{0};
+    std::atomic<uint64_t> jpeg_decode_failures_{0};
 
     void diagnosticTimerCallback(const ros::TimerEvent &);
     ros::Timer diagnostic_trigger_;
@@ -35,7 +35,10 @@
 #define MULTISENSE_ROS_CAMERA_UTILITIES_H
 
 #include <tuple>
+#include <list>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -48,6 +51,9 @@
 #include <multisense_lib/MultiSenseChannel.hh>
 #include <multisense_lib/MultiSenseTypes.hh>
 
+#include <multisense_ros/parallel_utilities.h>
+#include <multisense_ros/simd_utilities.h>
+
 namespace multisense_ros {
 
 static constexpr size_t S30_AUX_CAM_WIDTH = 1920;
@@ -61,12 +67,23 @@ struct OperatingResolutionT
 
 enum class BorderClip {NONE, RECTANGULAR, CIRCULAR};
 
+///
+/// @brief Rectification maps in OpenCV's fixed point form for cv::remap. map1 (CV_16SC2) holds the integer source
+///        coordinates and map2 (CV_16UC1) the index of the cv::INTER_TAB_SIZE x cv::INTER_TAB_SIZE sub-pixel
+///        interpolation offset
+///
 struct RectificationRemapT
 {
     cv::Mat map1;
     cv::Mat map2;
 };
 
+struct StereoRectificationRemapT
+{
+    std::shared_ptr<RectificationRemapT> left;
+    std::shared_ptr<RectificationRemapT> right;
+};
+
 template <typename T>
 class BufferWrapper
 {
@@ -130,9 +147,80 @@ constexpr Eigen::Matrix<T, 3, 1> ycbcrToBgr(const crl::multisense::image::Header
     return Eigen::Matrix<T, 3, 1>{static_cast<T>(px_b), static_cast<T>(px_g), static_cast<T>(px_r)};
 }
 
+///
+/// @brief Convert a YCbCr420 image (full resolution luma and interleaved CbCr at half resolution) into an interleaved
+///        BGR image using fixed point arithmetic. Every channel is within 1 of the per-pixel ycbcrToBgr<uint8_t>, and
+///        every SIMD level produces identical output
+/// @param output Image of 3 * luma.width * luma.height bytes
+///
+void ycbcrToBgr(const crl::multisense::image::Header &luma,
+                const crl::multisense::image::Header &chroma,
+                uint8_t *output,
+                SimdLevel level = simdLevel());
+
+///
+/// @brief Convert rows [begin_row, end_row) of a YCbCr420 image into BGR. output points to the start of the full BGR
+///        image
+///
+void ycbcrToBgr(const crl::multisense::image::Header &luma,
+                const crl::multisense::image::Header &chroma,
+                size_t begin_row,
+                size_t end_row,
+                uint8_t *output,
+                SimdLevel level = simdLevel());
+
+///
+/// @brief Convert a YCbCr420 image into BGR, splitting the rows between the threads of an executor
+///
 void ycbcrToBgr(const crl::multisense::image::Header &luma,
                 const crl::multisense::image::Header &chroma,
-                uint8_t *output);
+                uint8_t *output,
+                RowBandExecutor &executor,
+                SimdLevel level = simdLevel());
+
+///
+/// @brief View of a YCbCr420 image with full resolution luma and half resolution chroma. Cb and Cr samples are
+///        chroma_step bytes apart, which is 2 for the interleaved CbCr sent by the camera
+///
+struct Ycbcr420ImageT
+{
+    size_t width = 0;
+    size_t height = 0;
+
+    const uint8_t *luma = nullptr;
+    size_t luma_stride = 0;
+
+    const uint8_t *cb = nullptr;
+    const uint8_t *cr = nullptr;
+    size_t chroma_width = 0;
+    size_t chroma_height = 0;
+    size_t chroma_step = 0;
+    size_t chroma_stride = 0;
+};
+
+///
+/// @brief Create a view of a luma image and its interleaved CbCr chroma image
+///
+Ycbcr420ImageT makeYcbcr420Image(const crl::multisense::image::Header &luma,
+                                 const crl::multisense::image::Header &chroma);
+
+///
+/// @brief Check if rectification maps are fixed point maps of the given resolution
+///
+bool isValidRectificationRemap(const RectificationRemapT &remap, size_t width, size_t height);
+
+///
+/// @brief Rectify and convert the single pixel (u, v) of a YCbCr420 image, producing exactly the BGR value of
+///        converting the image with ycbcrToBgr and rectifying it with cv::remap (cv::INTER_LINEAR, black constant
+///        border). Used to color sparse sets of pixels without converting and rectifying the whole image
+/// @param remap Fixed point rectification maps which pass isValidRectificationRemap for the image resolution
+/// @param output The 3 bytes of the BGR pixel
+///
+void ycbcrToRectifiedBgrPixel(const Ycbcr420ImageT &image,
+                              const RectificationRemapT &remap,
+                              size_t u,
+                              size_t v,
+                              uint8_t *output);
 
 Eigen::Matrix4d makeQ(const crl::multisense::image::Config& config,
                       const crl::multisense::image::Calibration& calibration,
@@ -146,6 +234,196 @@ sensor_msgs::CameraInfo makeCameraInfo(const crl::multisense::image::Config& con
 RectificationRemapT makeRectificationRemap(const crl::multisense::image::Config& config,
                                            const crl::multisense::image::Calibration::Data& calibration,
                                            const crl::multisense::system::DeviceInfo& device_info);
+
+///
+/// @brief Least recently used cache of left and right rectification maps keyed by operating resolution and crop
+///        offset. Maps which are not cached are built on a background thread, so looking up maps never blocks on
+///        map generation
+///
+class RectificationRemapCache
+{
+public:
+
+    static constexpr size_t DEFAULT_CAPACITY = 4;
+
+    RectificationRemapCache(const crl::multisense::image::Calibration &calibration,
+                            const crl::multisense::system::DeviceInfo &device_info,
+                            size_t capacity = DEFAULT_CAPACITY);
+
+    ///
+    /// @brief Get the maps for a config, building them on the calling thread if they are not cached
+    ///
+    StereoRectificationRemapT build(const crl::multisense::image::Config &config);
+
+    ///
+    /// @brief Get the maps for a config if they are cached. Otherwise schedule them to be built in the background and
+    ///        return empty maps
+    ///
+    StereoRectificationRemapT get(const crl::multisense::image::Config &config);
+
+private:
+
+    struct KeyT
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        int32_t offset = 0;
+
+        bool operator==(const KeyT &other) const
+        {
+            return width == other.width && height == other.height && offset == other.offset;
+        }
+    };
+
+    static KeyT makeKey(const crl::multisense::image::Config &config);
+
+    bool find(const KeyT &key, StereoRectificationRemapT &remaps);
+    void insert(const KeyT &key, const StereoRectificationRemapT &remaps);
+
+    const crl::multisense::image::Calibration calibration_;
+    const crl::multisense::system::DeviceInfo device_info_;
+    const size_t capacity_ = DEFAULT_CAPACITY;
+
+    std::mutex mutex_;
+
+    //
+    // Most recently used maps first
+
+    std::list<std::pair<KeyT, StereoRectificationRemapT>> entries_;
+
+    //
+    // Single background thread whose queue only holds the most recently requested config. Destroyed first so no
+    // build runs after the rest of the cache is destroyed
+
+    WorkerPool builder_;
+};
+
+///
+/// @brief Lookup table of the rays through the pixels of the left rectified image at a single operating resolution.
+///        Rectified rays are separable, so the table stores one x/z ratio per column and one y/z ratio per row. A
+///        disparity of d pixels at pixel (u, v) reprojects to:
+///
+///        z = depth_scale / d + depth_offset
+///        x = x_over_z[u] * z
+///        y = y_over_z[v] * z
+///
+///        16 bit disparity images only have DISPARITY_LUT_SIZE distinct values, so the table also stores the depth
+///        of every raw 16 bit disparity to replace the per pixel division with a lookup
+///
+struct RayTableT
+{
+    static constexpr size_t DISPARITY_LUT_SIZE = 65536;
+
+    OperatingResolutionT resolution;
+    std::vector<float> x_over_z;
+    std::vector<float> y_over_z;
+    float depth_scale = 0.0f;
+    float depth_offset = 0.0f;
+
+    //
+    // Indexed by raw 1/16th pixel disparity. depth_lut is 16 * depth_scale / d in meters, without depth_offset, and
+    // ni_depth_lut is the OpenNI depth in millimeters. A disparity of 0 maps to NaN and 0 respectively
+
+    std::vector<float> depth_lut;
+    std::vector<uint16_t> ni_depth_lut;
+};
+
+RayTableT makeRayTable(const sensor_msgs::CameraInfo &left_camera_info,
+                       const sensor_msgs::CameraInfo &right_camera_info);
+
+///
+/// @brief Reproject one row of a disparity image into 3D using a ray table which matches the resolution of the
+///        disparity image. The points are written in structure of arrays form into x, y, and z which must each hold
+///        width values. Zero disparities are reprojected to std::numeric_limits<float>::max() to match
+///        StereoCalibrationManger::reproject. Each coordinate agrees with StereoCalibrationManger::reproject to within
+///        1e-5 of the range of the point. The ray table must be created with makeRayTable
+/// @param disparity Row of 1/16th pixel disparity values (16 bit disparity images)
+/// @param v The row index of the disparity row
+/// @param level The instruction set to use. Defaults to the widest instruction set supported by the host
+///
+void reprojectDisparityRow(const uint16_t *disparity,
+                           size_t v,
+                           size_t width,
+                           const RayTableT &ray_table,
+                           float *x,
+                           float *y,
+                           float *z,
+                           SimdLevel level = simdLevel());
+
+///
+/// @brief Reproject one row of a floating point disparity image into 3D. See the uint16_t overload
+///
+void reprojectDisparityRow(const float *disparity,
+                           size_t v,
+                           size_t width,
+                           const RayTableT &ray_table,
+                           float *x,
+                           float *y,
+                           float *z,
+                           SimdLevel level = simdLevel());
+
+///
+/// @brief Coefficients which project the points of a ray table into the rectified aux image. Expanding the aux
+///        projection matrix with x = x_over_z[u] * z and y = y_over_z[v] * z, the point of pixel (u, v) with depth z
+///        projects to:
+///
+///        u_aux = (u_scale[u] * z + u_offset) / (z + z_offset)
+///        v_aux = (v_scale[v] * z + v_offset) / (z + z_offset)
+///
+struct AuxProjectionTableT
+{
+    OperatingResolutionT resolution;
+    std::vector<float> u_scale;
+    std::vector<float> v_scale;
+    float u_offset = 0.0f;
+    float v_offset = 0.0f;
+    float z_offset = 0.0f;
+};
+
+AuxProjectionTableT makeAuxProjectionTable(const RayTableT &ray_table,
+                                           const sensor_msgs::CameraInfo &aux_camera_info);
+
+///
+/// @brief Color one row of reprojected points by projecting them into a rectified aux color image and bilinearly
+///        interpolating the four neighboring pixels. Projections outside of the image are clamped to its border.
+///        Colors are packed as 0x00RRGGBB and agree with interpolate_color to within rounding
+/// @param v The row index of the points
+/// @param z Depths of the points of the row, as written by reprojectDisparityRow
+/// @param image Continuous CV_8UC3 rectified aux image
+/// @param colors Packed colors of the points. Must hold width values
+/// @param level The instruction set to use. Defaults to the widest instruction set supported by the host
+///
+void auxColorRow(const AuxProjectionTableT &table,
+                 size_t v,
+                 size_t width,
+                 const float *z,
+                 const cv::Mat &image,
+                 uint32_t *colors,
+                 SimdLevel level = simdLevel());
+
+///
+/// @brief Convert a disparity image into a 32 bit floating point depth image in meters and a 16 bit depth image in
+///        millimeters (OpenNI format). Invalid disparities are converted to NaN and 0 respectively. Either output may
+///        be nullptr, in which case it is not computed. Non-null outputs must each hold width * height values. 16 bit
+///        disparities are converted with the lookup tables of the ray table
+/// @param ray_table Ray table which matches the resolution of the disparity image, created with makeRayTable
+/// @param level The instruction set to use. Defaults to the widest instruction set supported by the host
+/// @return false if the disparity bit depth is unsupported
+///
+bool disparityToDepth(const crl::multisense::image::Header &disparity,
+                      const RayTableT &ray_table,
+                      float *depth,
+                      uint16_t *ni_depth,
+                      SimdLevel level = simdLevel());
+
+///
+/// @brief Convert a 16 bit disparity image in 1/16th pixels into a floating point disparity image in pixels, as
+///        published in stereo_msgs::DisparityImage
+/// @param size The number of disparities to convert. output must hold size values
+/// @param level The instruction set to use. Defaults to the widest instruction set supported by the host
+///
+void disparityToFloat(const uint16_t *disparity, size_t size, float *output, SimdLevel level = simdLevel());
+
 class StereoCalibrationManger
 {
 public:
@@ -231,11 +509,32 @@ public:
                                           size_t width,
                                           size_t height) const;
 
+    ///
+    /// @brief Get the rectification maps for the current operating stereo resolution. Maps for a new resolution are
+    ///        built in the background, so these return nullptr until the maps for the current resolution are ready
+    ///
     std::shared_ptr<RectificationRemapT> leftRemap() const;
     std::shared_ptr<RectificationRemapT> rightRemap() const;
 
+    ///
+    /// @brief Get the ray table for the current operating stereo resolution. The table is rebuilt whenever the
+    ///        resolution changes. Callers may hold onto the returned table while a new one is swapped in
+    ///
+    std::shared_ptr<const RayTableT> rayTable() const;
+
+    ///
+    /// @brief Get the aux projection table for the ray table of the current operating stereo resolution. Rebuilt
+    ///        along with the ray table
+    ///
+    std::shared_ptr<const AuxProjectionTableT> auxProjectionTable() const;
+
 private:
 
+    //
+    // Get the current rectification maps, picking up maps from the cache once they are built
+
+    StereoRectificationRemapT remaps() const;
+
     crl::multisense::image::Config config_;
     const crl::multisense::image::Calibration calibration_;
     const crl::multisense::system::DeviceInfo& device_info_;
@@ -254,8 +553,14 @@ private:
     sensor_msgs::CameraInfo right_camera_info_;
     sensor_msgs::CameraInfo aux_camera_info_;
 
-    std::shared_ptr<RectificationRemapT> left_remap_;
-    std::shared_ptr<RectificationRemapT> right_remap_;
+    //
+    // Rectification maps for the current config. Empty while the maps are being built
+
+    std::unique_ptr<RectificationRemapCache> remap_cache_;
+    mutable StereoRectificationRemapT remaps_;
+
+    std::shared_ptr<const RayTableT> ray_table_;
+    std::shared_ptr<const AuxProjectionTableT> aux_projection_table_;
 };
 
 }// namespace
@@ -43,6 +43,8 @@
 #include <sensor_msgs/Image.h>
 #include <sensor_msgs/CameraInfo.h>
 
+#include <multisense_ros/point_cloud_utilities.h>
+
 namespace multisense_ros{
 
 class ColorLaser
@@ -51,7 +53,8 @@ class ColorLaser
 
         ColorLaser(
             ros::NodeHandle& nh,
-            const std::string &tf_prefix
+            const std::string &tf_prefix,
+            PointLayout point_layout = PointLayout::XYZ_CHANNELS
         );
 
         ~ColorLaser() = default;
@@ -60,7 +63,7 @@ class ColorLaser
         // Callbacks for subscriptions to ROS topics
 
         void colorImageCallback(const sensor_msgs::Image::ConstPtr& message);
-        void laserPointCloudCallback(sensor_msgs::PointCloud2::Ptr message);
+        void laserPointCloudCallback(const sensor_msgs::PointCloud2::ConstPtr& message);
         void cameraInfoCallback(const sensor_msgs::CameraInfo::ConstPtr& message);
 
     private:
@@ -73,10 +76,14 @@ class ColorLaser
         void stopStreaming();
 
         //
-        // Messages for local storage of sensor data
+        // Messages for local storage of sensor data. The color image is held by
+        // reference so intra-process images are never copied
+
+        sensor_msgs::Image::ConstPtr color_image_;
+        sensor_msgs::CameraInfo      camera_info_;
 
-        sensor_msgs::Image       color_image_;
-        sensor_msgs::CameraInfo  camera_info_;
+        //
+        // Template for the fields of each outgoing color laser point cloud
 
         sensor_msgs::PointCloud2 color_laser_pointcloud_;
 
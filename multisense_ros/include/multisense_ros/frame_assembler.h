@@ -0,0 +1,213 @@
+/**
+ * @file frame_assembler.h
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef MULTISENSE_ROS_FRAME_ASSEMBLER_H
+#define MULTISENSE_ROS_FRAME_ASSEMBLER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <multisense_lib/MultiSenseChannel.hh>
+#include <multisense_ros/buffer_image.h>
+#include <multisense_ros/camera_utilities.h>
+
+namespace multisense_ros {
+
+///
+/// @brief Collects the images of a single frame which arrive on different driver callback threads. Each image holds
+///        its driver callback buffer until every consumer which needs it has been called, after which the frame is
+///        released
+///
+class AssembledFrame
+{
+public:
+    typedef std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>> ImageBufferT;
+
+    explicit AssembledFrame(int64_t frame_id = -1);
+
+    int64_t frameId() const noexcept;
+
+    ///
+    /// @brief The capture time of the frame, taken from its first image
+    ///
+    uint32_t timeSeconds() const noexcept;
+    uint32_t timeMicroSeconds() const noexcept;
+
+    ///
+    /// @brief The mask of every image source which is present in the frame
+    ///
+    crl::multisense::DataSource sources() const noexcept;
+
+    ///
+    /// @brief Get the image of a given source. Returns nullptr if the frame does not have an image of that source
+    ///
+    const crl::multisense::image::Header* image(crl::multisense::DataSource source) const;
+
+    void add(const ImageBufferT &image);
+
+private:
+
+    int64_t frame_id_ = -1;
+    uint32_t time_seconds_ = 0;
+    uint32_t time_microseconds_ = 0;
+    crl::multisense::DataSource sources_ = 0;
+    std::vector<std::pair<crl::multisense::DataSource, ImageBufferT>> images_;
+};
+
+///
+/// @brief Thread-safe assembler which groups images from multiple driver callbacks by frame id. Consumers register
+///        the set of sources they need, and are called exactly once per frame as soon as every one of those sources
+///        has arrived. Only a bounded number of frames are held at once. When a new frame arrives and the assembler
+///        is full, the oldest incomplete frame is evicted and its buffers are returned to the driver. If a buffer
+///        limiter is shared with the assembler, the buffers of pending frames count against its limit
+///
+class FrameAssembler
+{
+public:
+    ///
+    /// @brief Returns the sources a consumer requires for the next frame, or 0 if the consumer is inactive. Called on
+    ///        every insert, so it should be cheap (e.g. a check of subscriber counts)
+    ///
+    typedef std::function<crl::multisense::DataSource()> RequirementFunction;
+
+    ///
+    /// @brief Called with the assembled frame once all the required sources of a consumer have arrived. Called
+    ///        from the thread which inserted the last required image, without any assembler locks held
+    ///
+    typedef std::function<void(const AssembledFrame&)> CompletionCallback;
+
+    struct StatsT
+    {
+        uint64_t completed_frames = 0;
+        uint64_t evicted_frames = 0;
+        uint64_t late_images = 0;
+        uint64_t dropped_images = 0;
+        uint64_t restarts = 0;
+        size_t pending_frames = 0;
+    };
+
+    ///
+    /// @brief Frame ids further than this below the newest frame id are treated as a restart of the frame id
+    ///        sequence (e.g. a sensor reboot) rather than as late images
+    ///
+    static constexpr int64_t MAX_LATE_FRAMES = 64;
+
+    ///
+    /// @param buffer_limiter Optional limiter which the driver buffers of pending frames are reserved through. When
+    ///        the limit is reached the oldest pending frames are evicted to make room, and the image is dropped if
+    ///        no other frame is pending. Must outlive the assembler
+    ///
+    FrameAssembler(crl::multisense::Channel* driver,
+                   size_t max_frames,
+                   CallbackBufferLimiter* buffer_limiter = nullptr);
+
+    ///
+    /// @brief Register a consumer. All consumers must be registered before the first call to insert
+    ///
+    void addConsumer(const RequirementFunction &required, const CompletionCallback &callback);
+
+    ///
+    /// @brief Add an image to its frame. Must be called from within the image callback so the driver buffer can be
+    ///        reserved. Images which are not required by any active consumer are ignored without reserving a buffer
+    ///
+    void insert(const crl::multisense::image::Header &header);
+
+    ///
+    /// @brief Drop every pending frame and forget previously evicted frames. Called when the image stream restarts,
+    ///        after which frame ids may start over
+    ///
+    void reset();
+
+    StatsT stats() const;
+
+private:
+
+    FrameAssembler(const FrameAssembler&) = delete;
+    FrameAssembler operator=(const FrameAssembler&) = delete;
+
+    struct ConsumerT
+    {
+        RequirementFunction required;
+        CompletionCallback callback;
+    };
+
+    struct PendingFrameT
+    {
+        AssembledFrame frame;
+        std::vector<bool> completed_consumers;
+    };
+
+    typedef AssembledFrame::ImageBufferT ImageBufferT;
+
+    //
+    // Reserve the driver buffer of an image, through the buffer limiter if there is one. Returns nullptr if the
+    // image can not be held
+
+    ImageBufferT reserve(const crl::multisense::image::Header &header);
+
+    //
+    // Evict the oldest pending frame other than keep_frame_id. Returns false if there is no such frame. Must be called
+    // with mutex_ held
+
+    bool evictOldest(int64_t keep_frame_id);
+
+    crl::multisense::Channel* driver_ = nullptr;
+    const size_t max_frames_ = 0;
+    CallbackBufferLimiter* buffer_limiter_ = nullptr;
+
+    std::vector<ConsumerT> consumers_;
+
+    //
+    // Protects the pending frames and statistics. Held only for bookkeeping, never during a consumer callback
+
+    mutable std::mutex mutex_;
+
+    std::vector<PendingFrameT> pending_frames_;
+
+    //
+    // Frames are evicted oldest first, so any image at or below this frame id belongs to an evicted frame. Both frame
+    // ids are reset when the frame id sequence restarts
+
+    int64_t newest_frame_id_ = -1;
+    int64_t newest_evicted_frame_id_ = -1;
+
+    StatsT stats_;
+};
+
+}// namespace
+
+#endif
@@ -56,11 +56,13 @@ Eigen::Matrix<uint8_t, 3, 1> groundSurfaceClassToPixelColor(const uint8_t value)
 /// @brief Convert an eigen representation of a pointcloud to a ROS sensor_msgs::PointCloud2 format
 /// @param input Pointcloud to convert between eigen and sensor_msg format
 /// @param frame_id Base frame ID for resulting sensor_msg
+/// @param layout Point layout of the resulting sensor_msg
 /// @return Pointcloud in sensor_msg format
 ///
 sensor_msgs::PointCloud2 eigenToPointcloud(
     const std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f>> &input,
-    const std::string &frame_id);
+    const std::string &frame_id,
+    multisense_ros::PointLayout layout = multisense_ros::PointLayout::XYZ_CHANNELS);
 
 ///
 /// @brief Struct containing parameters for drawing a pointcloud representation of a B-Spline model
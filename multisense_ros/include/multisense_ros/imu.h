@@ -34,6 +34,7 @@
 #ifndef MULTISENSE_ROS_IMU_H
 #define MULTISENSE_ROS_IMU_H
 
+#include <memory>
 #include <mutex>
 
 #include <ros/ros.h>
@@ -42,13 +43,17 @@
 #include <geometry_msgs/Vector3Stamped.h>
 
 #include <multisense_lib/MultiSenseChannel.hh>
+#include <multisense_ros/latency_metrics.h>
 
 namespace multisense_ros {
 
 class Imu {
 public:
 
-    Imu(crl::multisense::Channel* driver, std::string tf_prefix);
+    Imu(crl::multisense::Channel* driver,
+        std::string tf_prefix,
+        const ros::NodeHandle& nh = ros::NodeHandle(""),
+        const std::shared_ptr<LatencyRegistry>& latency_registry = nullptr);
     ~Imu();
 
     void imuCallback(const crl::multisense::imu::Header& header);
@@ -102,6 +107,12 @@ private:
     const std::string gyro_frameId_;
     const std::string mag_frameId_;
 
+    //
+    // Publish latency tracking
+
+    std::shared_ptr<LatencyRegistry> latency_registry_;
+    LatencyTracker* imu_latency_ = nullptr;
+
 };
 
 }
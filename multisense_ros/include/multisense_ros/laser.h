@@ -34,6 +34,7 @@
 #ifndef MULTISENSE_ROS_LASER_H
 #define MULTISENSE_ROS_LASER_H
 
+#include <memory>
 #include <mutex>
 
 #include <ros/ros.h>
@@ -45,13 +46,18 @@
 #include <tf2_ros/static_transform_broadcaster.h>
 
 #include <multisense_lib/MultiSenseChannel.hh>
+#include <multisense_ros/latency_metrics.h>
+#include <multisense_ros/point_cloud_utilities.h>
 
 namespace multisense_ros {
 
 class Laser {
 public:
     Laser(crl::multisense::Channel* driver,
-          const std::string& tf_prefix);
+          const std::string& tf_prefix,
+          const ros::NodeHandle& device_nh = ros::NodeHandle(""),
+          const std::shared_ptr<LatencyRegistry>& latency_registry = nullptr,
+          PointLayout point_layout = PointLayout::XYZ_CHANNELS);
     ~Laser();
 
     void scanCallback(const crl::multisense::lidar::Header& header);
@@ -141,6 +147,12 @@ private:
 
     ros::Time previous_scan_time_;
 
+    //
+    // Publish latency tracking
+
+    std::shared_ptr<LatencyRegistry> latency_registry_;
+    LatencyTracker* scan_latency_ = nullptr;
+    LatencyTracker* point_cloud_latency_ = nullptr;
 
 }; // class
 
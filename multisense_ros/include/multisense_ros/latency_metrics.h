@@ -0,0 +1,146 @@
+/**
+ * @file latency_metrics.h
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef MULTISENSE_ROS_LATENCY_METRICS_H
+#define MULTISENSE_ROS_LATENCY_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+namespace multisense_ros {
+
+///
+/// @brief Histogram of durations with fixed, logarithmically spaced buckets. Each power of two microseconds is split
+///        into 4 buckets, so reported percentiles are within 25% of the true value. Recording is lock-free and may be
+///        called concurrently from any number of threads
+///
+class LatencyHistogram
+{
+public:
+    static constexpr size_t SUB_BUCKETS = 4;
+    static constexpr size_t BUCKETS = 96;
+
+    struct SummaryT
+    {
+        uint64_t count = 0;
+
+        //
+        // Percentiles are the upper bound of the bucket containing the percentile, in seconds
+
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    LatencyHistogram();
+
+    void record(uint64_t microseconds) noexcept;
+
+    ///
+    /// @brief Summarize the durations recorded since the previous call to collect, and reset the histogram
+    ///
+    SummaryT collect() noexcept;
+
+    static size_t bucket(uint64_t microseconds) noexcept;
+
+    ///
+    /// @brief The largest duration in microseconds which falls into a bucket
+    ///
+    static uint64_t bucketUpperBound(size_t bucket) noexcept;
+
+private:
+
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_;
+    std::atomic<uint64_t> max_;
+};
+
+///
+/// @brief Processing time and sensor-to-publish latency of a single topic. The processing time is measured from the
+///        start of the callback, and the latency from the sensor capture time, to when the callback has published
+///
+class LatencyTracker
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    static TimePoint now() noexcept;
+
+    void record(const ros::Time &sensor_stamp, const TimePoint &callback_start) noexcept;
+
+    LatencyHistogram processing;
+    LatencyHistogram latency;
+};
+
+///
+/// @brief Registry of the latency trackers of every instrumented topic
+///
+class LatencyRegistry
+{
+public:
+    struct TopicSummaryT
+    {
+        std::string name;
+        LatencyHistogram::SummaryT processing;
+        LatencyHistogram::SummaryT latency;
+    };
+
+    ///
+    /// @brief Get the tracker for a topic, creating it on first use. The returned tracker lives as long as the
+    ///        registry, so look it up once and record to it from the hot path
+    ///
+    LatencyTracker* tracker(const std::string &name);
+
+    ///
+    /// @brief Summarize every tracker since the previous call to collect, and reset them
+    ///
+    std::vector<TopicSummaryT> collect();
+
+private:
+
+    std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<LatencyTracker>> trackers_;
+};
+
+}// namespace
+
+#endif
@@ -0,0 +1,417 @@
+/**
+ * @file mock_channel.h
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef MULTISENSE_ROS_MOCK_CHANNEL_H
+#define MULTISENSE_ROS_MOCK_CHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <multisense_lib/MultiSenseChannel.hh>
+
+namespace multisense_ros {
+
+///
+/// @brief Local stand-in for a MultiSense sensor. Returns canned device information, calibration and configuration,
+///        and calls the registered isolated callbacks with synthetic or recorded payloads at a configurable rate,
+///        resolution and jitter. Each callback runs on its own dispatch thread behind a bounded queue which drops
+///        the oldest message when full, like the callback threads of LibMultiSense
+///
+class MockChannel : public crl::multisense::Channel
+{
+public:
+
+    enum class DeviceType
+    {
+        ///
+        /// @brief Stereo with an aux color camera and on-camera ground surface modeling
+        ///
+        S30,
+        ///
+        /// @brief Color stereo with a spinning lidar
+        ///
+        SL
+    };
+
+    struct ConfigT
+    {
+        DeviceType device = DeviceType::S30;
+
+        //
+        // Operating resolution of the stereo images. Must be a full, half or quarter of the imager resolution
+
+        uint32_t width = 960;
+        uint32_t height = 600;
+
+        double image_fps = 10.0;
+        double lidar_scan_rate = 40.0;
+        double imu_sample_rate = 200.0;
+        double pps_rate = 1.0;
+
+        ///
+        /// @brief Standard deviation of the time between messages as a fraction of the nominal period
+        ///
+        double jitter = 0.0;
+
+        ///
+        /// @brief Number of messages each callback can have queued before the oldest is dropped
+        ///
+        size_t queue_depth = 5;
+
+        ///
+        /// @brief Number of callback buffers which can be reserved at once before reserveCallbackBuffer fails
+        ///
+        size_t callback_buffers = 50;
+
+        //
+        // Optional recorded payloads. An 8 bit grayscale image for every luma stream and a 16 bit image of 1/16th
+        // pixel disparities. Both are resized to the operating resolution. Empty uses synthetic images
+
+        std::string luma_image;
+        std::string disparity_image;
+    };
+
+    struct StreamStatsT
+    {
+        std::string name;
+        std::string subsystem;
+
+        ///
+        /// @brief Messages handed to the callbacks of the stream (one per callback)
+        ///
+        uint64_t generated = 0;
+        uint64_t delivered = 0;
+
+        ///
+        /// @brief Messages dropped because a callback queue was full
+        ///
+        uint64_t dropped = 0;
+
+        ///
+        /// @brief Calls to reserveCallbackBuffer which failed because every callback buffer was in use
+        ///
+        uint64_t failed_reservations = 0;
+
+        ///
+        /// @brief Thread CPU time spent inside the callbacks of the stream
+        ///
+        double cpu_seconds = 0.0;
+    };
+
+    explicit MockChannel(const ConfigT &config);
+    ~MockChannel() override;
+
+    ///
+    /// @brief Cumulative statistics of every stream which has generated at least one message
+    ///
+    std::vector<StreamStatsT> stats() const;
+
+    crl::multisense::Status addIsolatedCallback(crl::multisense::image::Callback callback,
+                                                crl::multisense::DataSource imageSourceMask,
+                                                void *userDataP = nullptr) override;
+    crl::multisense::Status addIsolatedCallback(crl::multisense::lidar::Callback callback,
+                                                void *userDataP = nullptr) override;
+    crl::multisense::Status addIsolatedCallback(crl::multisense::pps::Callback callback,
+                                                void *userDataP = nullptr) override;
+    crl::multisense::Status addIsolatedCallback(crl::multisense::imu::Callback callback,
+                                                void *userDataP = nullptr) override;
+    crl::multisense::Status addIsolatedCallback(crl::multisense::compressed_image::Callback callback,
+                                                crl::multisense::DataSource imageSourceMask,
+                                                void *userDataP = nullptr) override;
+    crl::multisense::Status addIsolatedCallback(crl::multisense::ground_surface::Callback callback,
+                                                void *userDataP = nullptr) override;
+
+    crl::multisense::Status removeIsolatedCallback(crl::multisense::image::Callback callback) override;
+    crl::multisense::Status removeIsolatedCallback(crl::multisense::lidar::Callback callback) override;
+    crl::multisense::Status removeIsolatedCallback(crl::multisense::pps::Callback callback) override;
+    crl::multisense::Status removeIsolatedCallback(crl::multisense::imu::Callback callback) override;
+    crl::multisense::Status removeIsolatedCallback(crl::multisense::compressed_image::Callback callback) override;
+    crl::multisense::Status removeIsolatedCallback(crl::multisense::ground_surface::Callback callback) override;
+
+    void* reserveCallbackBuffer() override;
+    crl::multisense::Status releaseCallbackBuffer(void *referenceP) override;
+
+    crl::multisense::Status networkTimeSynchronization(bool enabled) override;
+    crl::multisense::Status ptpTimeSynchronization(bool enabled) override;
+
+    crl::multisense::Status startStreams(crl::multisense::DataSource mask) override;
+    crl::multisense::Status stopStreams(crl::multisense::DataSource mask) override;
+    crl::multisense::Status getEnabledStreams(crl::multisense::DataSource &mask) override;
+
+    crl::multisense::Status startDirectedStream(const crl::multisense::DirectedStream &stream) override;
+    crl::multisense::Status startDirectedStreams(const std::vector<crl::multisense::DirectedStream> &streams) override;
+    crl::multisense::Status stopDirectedStream(const crl::multisense::DirectedStream &stream) override;
+    crl::multisense::Status getDirectedStreams(std::vector<crl::multisense::DirectedStream> &streams) override;
+    crl::multisense::Status maxDirectedStreams(uint32_t &maximum) override;
+
+    crl::multisense::Status setTriggerSource(crl::multisense::TriggerSource s) override;
+    crl::multisense::Status setMotorSpeed(float rpm) override;
+
+    crl::multisense::Status getLightingConfig(crl::multisense::lighting::Config &c) override;
+    crl::multisense::Status setLightingConfig(const crl::multisense::lighting::Config &c) override;
+    crl::multisense::Status getLightingSensorStatus(crl::multisense::lighting::SensorStatus &status) override;
+
+    crl::multisense::Status getSensorVersion(crl::multisense::VersionType &version) override;
+    crl::multisense::Status getApiVersion(crl::multisense::VersionType &version) override;
+    crl::multisense::Status getVersionInfo(crl::multisense::system::VersionInfo &v) override;
+
+    crl::multisense::Status getImageConfig(crl::multisense::image::Config &c) override;
+    crl::multisense::Status setImageConfig(const crl::multisense::image::Config &c) override;
+    crl::multisense::Status getRemoteHeadConfig(crl::multisense::image::RemoteHeadConfig &c) override;
+    crl::multisense::Status setRemoteHeadConfig(const crl::multisense::image::RemoteHeadConfig &c) override;
+    crl::multisense::Status getImageCalibration(crl::multisense::image::Calibration &c) override;
+    crl::multisense::Status setImageCalibration(const crl::multisense::image::Calibration &c) override;
+    crl::multisense::Status getTransmitDelay(crl::multisense::image::TransmitDelay &c) override;
+    crl::multisense::Status setTransmitDelay(const crl::multisense::image::TransmitDelay &c) override;
+    crl::multisense::Status getImageHistogram(int64_t frameId, crl::multisense::image::Histogram &histogram) override;
+
+    crl::multisense::Status getLidarCalibration(crl::multisense::lidar::Calibration &c) override;
+    crl::multisense::Status setLidarCalibration(const crl::multisense::lidar::Calibration &c) override;
+
+    crl::multisense::Status getPtpStatus(int64_t frameId, crl::multisense::system::PtpStatus &ptpStatus) override;
+    crl::multisense::Status getDeviceModes(std::vector<crl::multisense::system::DeviceMode> &modes) override;
+    crl::multisense::Status getMtu(int32_t &mtu) override;
+    crl::multisense::Status setMtu(int32_t mtu) override;
+    crl::multisense::Status getMotorPos(int32_t &mtu) override;
+    crl::multisense::Status getNetworkConfig(crl::multisense::system::NetworkConfig &c) override;
+    crl::multisense::Status setNetworkConfig(const crl::multisense::system::NetworkConfig &c) override;
+    crl::multisense::Status getDeviceInfo(crl::multisense::system::DeviceInfo &info) override;
+    crl::multisense::Status setDeviceInfo(const std::string &key, const crl::multisense::system::DeviceInfo &i) override;
+    crl::multisense::Status getDeviceStatus(crl::multisense::system::StatusMessage &status) override;
+    crl::multisense::Status getExternalCalibration(crl::multisense::system::ExternalCalibration &calibration) override;
+    crl::multisense::Status setExternalCalibration(const crl::multisense::system::ExternalCalibration &calibration) override;
+    crl::multisense::Status setGroundSurfaceParams(const crl::multisense::system::GroundSurfaceParams &params) override;
+
+    crl::multisense::Status flashBitstream(const std::string &file) override;
+    crl::multisense::Status flashFirmware(const std::string &file) override;
+    crl::multisense::Status verifyBitstream(const std::string &file) override;
+    crl::multisense::Status verifyFirmware(const std::string &file) override;
+
+    crl::multisense::Status getImuInfo(uint32_t &maxSamplesPerMessage,
+                                       std::vector<crl::multisense::imu::Info> &info) override;
+    crl::multisense::Status getImuConfig(uint32_t &samplesPerMessage,
+                                         std::vector<crl::multisense::imu::Config> &c) override;
+    crl::multisense::Status setImuConfig(bool storeSettingsInFlash,
+                                         uint32_t samplesPerMessage,
+                                         const std::vector<crl::multisense::imu::Config> &c) override;
+
+    crl::multisense::Status getLargeBufferDetails(uint32_t &bufferCount, uint32_t &bufferSize) override;
+    crl::multisense::Status setLargeBuffers(const std::vector<uint8_t*> &buffers, uint32_t bufferSize) override;
+    crl::multisense::Status getLocalUdpPort(uint16_t &port) override;
+
+private:
+
+    MockChannel(const MockChannel&) = delete;
+    MockChannel operator=(const MockChannel&) = delete;
+
+    //
+    // Keeps the data a header points to alive while the message is queued, and while any callback buffer reserved
+    // during its dispatch is held
+
+    typedef std::shared_ptr<const void> PayloadT;
+
+    enum class CallbackType
+    {
+        IMAGE,
+        LIDAR,
+        PPS,
+        IMU,
+        COMPRESSED_IMAGE,
+        GROUND_SURFACE
+    };
+
+    ///
+    /// @brief A registered callback with its dispatch thread and bounded message queue
+    ///
+    class Listener
+    {
+    public:
+        ///
+        /// @brief Calls the user callback with a type erased header
+        ///
+        typedef std::function<void(const void*)> CallbackT;
+
+        Listener(MockChannel *channel,
+                 CallbackType type,
+                 uintptr_t key,
+                 crl::multisense::DataSource mask,
+                 const CallbackT &callback);
+        ~Listener();
+
+        CallbackType type() const noexcept { return type_; }
+        uintptr_t key() const noexcept { return key_; }
+        crl::multisense::DataSource mask() const noexcept { return mask_; }
+
+        ///
+        /// @brief Queue a message for dispatch. If the queue is full the oldest queued message is dropped and its
+        ///        stream is returned, otherwise returns an empty string
+        ///
+        std::string post(const std::string &stream, const PayloadT &payload, const std::shared_ptr<const void> &header);
+
+    private:
+
+        struct QueuedMessageT
+        {
+            std::string stream;
+            PayloadT payload;
+            std::shared_ptr<const void> header;
+        };
+
+        void run();
+
+        MockChannel *channel_ = nullptr;
+        const CallbackType type_;
+        const uintptr_t key_ = 0;
+        const crl::multisense::DataSource mask_ = 0;
+        const CallbackT callback_;
+
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::deque<QueuedMessageT> queue_;
+        bool shutdown_ = false;
+
+        std::thread thread_;
+    };
+
+    struct ImagePayloadT
+    {
+        crl::multisense::DataSource source = 0;
+        uint32_t bits_per_pixel = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        PayloadT data;
+        const void *data_p = nullptr;
+        uint32_t length = 0;
+    };
+
+    crl::multisense::Status addListener(CallbackType type,
+                                        uintptr_t key,
+                                        crl::multisense::DataSource mask,
+                                        const Listener::CallbackT &callback);
+    crl::multisense::Status removeListener(CallbackType type, uintptr_t key);
+
+    ///
+    /// @brief Post a message to every listener of a type. Image listeners only receive sources in their mask
+    ///
+    void dispatch(CallbackType type,
+                  crl::multisense::DataSource source,
+                  const std::string &stream,
+                  const PayloadT &payload,
+                  const std::shared_ptr<const void> &header);
+
+    ///
+    /// @brief Call generate at rate (read through the supplied function so it can change at runtime) with jitter
+    ///        until the channel is destroyed
+    ///
+    void runGenerator(const std::function<double()> &rate, const std::function<void()> &generate);
+
+    void generateImages();
+    void generateLidarScan();
+    void generateImu();
+    void generatePps();
+
+    ///
+    /// @brief Rebuild the image payloads for the current image config. Must be called with config_mutex_ held
+    ///
+    void buildImagePayloads();
+    ///
+    /// @brief Get the statistics of a stream, creating them if needed. Must be called with stats_mutex_ held
+    ///
+    StreamStatsT& streamStats(const std::string &stream);
+
+    void recordCallback(const std::string &stream, double cpu_seconds);
+    void recordGenerated(const std::string &stream, const std::string &dropped_stream);
+    void recordFailedReservation(const std::string &stream);
+
+    bool enabled(crl::multisense::DataSource source) const;
+
+    ConfigT config_;
+
+    crl::multisense::system::DeviceInfo device_info_;
+    crl::multisense::lidar::Calibration lidar_calibration_;
+    const std::chrono::steady_clock::time_point start_time_;
+
+    //
+    // Protects the image config and calibration, the image payloads built for them, and the external calibration
+
+    mutable std::mutex config_mutex_;
+    crl::multisense::image::Config image_config_;
+    crl::multisense::image::Calibration image_calibration_;
+    std::vector<ImagePayloadT> image_payloads_;
+    PayloadT ground_surface_payload_;
+    crl::multisense::system::ExternalCalibration external_calibration_;
+
+    PayloadT lidar_payload_;
+    uint32_t lidar_point_count_ = 0;
+
+    std::atomic<crl::multisense::DataSource> enabled_streams_{0};
+    std::atomic<double> image_fps_{0.0};
+    std::atomic<uint32_t> imu_samples_per_message_{4};
+    std::atomic<float> motor_rpm_{0.0f};
+    std::atomic<int32_t> spindle_angle_{0};
+    std::atomic<int32_t> mtu_{7200};
+    std::atomic<size_t> reserved_buffers_{0};
+
+    //
+    // Sequence numbers, each only touched by the thread of its generator
+
+    int64_t frame_id_ = 0;
+    uint32_t scan_id_ = 0;
+    uint32_t imu_sequence_ = 0;
+
+    mutable std::mutex listener_mutex_;
+    std::vector<std::unique_ptr<Listener>> listeners_;
+
+    mutable std::mutex stats_mutex_;
+    std::map<std::string, StreamStatsT> stats_;
+
+    std::mutex shutdown_mutex_;
+    std::condition_variable shutdown_condition_;
+    bool shutdown_ = false;
+
+    std::vector<std::thread> generators_;
+};
+
+}// namespace
+
+#endif
@@ -0,0 +1,180 @@
+/**
+ * @file parallel_utilities.h
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef MULTISENSE_ROS_PARALLEL_UTILITIES_H
+#define MULTISENSE_ROS_PARALLEL_UTILITIES_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace multisense_ros {
+
+///
+/// @brief Persistent pool of threads which process the rows of an image in contiguous bands. The calling thread
+///        always processes the first band, so an executor with a single thread runs entirely on the caller
+///
+class RowBandExecutor
+{
+public:
+    ///
+    /// @brief Function processing rows [begin_row, end_row) of the image as band number band
+    ///
+    typedef std::function<void(size_t band, size_t begin_row, size_t end_row)> BandFunction;
+
+    ///
+    /// @brief Create an executor with the requested number of threads including the calling thread. A value of 0 uses
+    ///        one thread per hardware thread
+    ///
+    explicit RowBandExecutor(size_t threads);
+    ~RowBandExecutor();
+
+    ///
+    /// @brief The number of bands each call to run splits the image into
+    ///
+    size_t bands() const noexcept;
+
+    ///
+    /// @brief Process rows [0, rows) split into bands() contiguous bands. Band b covers the rows
+    ///        [b * rows / bands(), (b + 1) * rows / bands()). Blocks until every band has been processed
+    ///
+    void run(size_t rows, const BandFunction &function);
+
+private:
+
+    RowBandExecutor(const RowBandExecutor&) = delete;
+    RowBandExecutor operator=(const RowBandExecutor&) = delete;
+
+    void worker(size_t band);
+
+    void processBand(size_t band);
+
+    size_t bands_ = 1;
+
+    std::vector<std::thread> workers_;
+
+    //
+    // Serialize calls to run
+
+    std::mutex run_mutex_;
+
+    //
+    // Work description shared with the worker threads
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+
+    const BandFunction *function_ = nullptr;
+    size_t rows_ = 0;
+    uint64_t generation_ = 0;
+    size_t pending_ = 0;
+    bool shutdown_ = false;
+};
+
+///
+/// @brief Fixed pool of threads which runs tasks posted to named queues. Each queue holds at most queue_depth tasks and
+///        drops its oldest task when a new task arrives on a full queue, so a slow queue never blocks the poster.
+///        Tasks from the same queue never run concurrently, while tasks from different queues are spread across the
+///        pool
+///
+class WorkerPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    struct QueueStatsT
+    {
+        std::string name;
+        size_t depth = 0;
+        size_t max_depth = 0;
+        uint64_t processed = 0;
+        uint64_t dropped = 0;
+    };
+
+    ///
+    /// @brief Create a pool of threads. If cpu_affinity is non-empty the threads are restricted to the listed CPUs
+    ///
+    WorkerPool(size_t threads, size_t queue_depth, const std::vector<int> &cpu_affinity = {});
+    ~WorkerPool();
+
+    ///
+    /// @brief Post a task to the named queue, creating the queue on first use. Never blocks on running tasks
+    ///
+    void post(const std::string &queue, Task task);
+
+    std::vector<QueueStatsT> stats() const;
+
+private:
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool operator=(const WorkerPool&) = delete;
+
+    struct QueueT
+    {
+        std::deque<Task> tasks;
+        bool running = false;
+        QueueStatsT stats;
+    };
+
+    void worker();
+
+    //
+    // Find a queue with pending tasks which is not already running. Must be called with mutex_ held
+
+    QueueT* nextQueue();
+
+    const size_t queue_depth_ = 1;
+
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+
+    //
+    // Queues are never removed, so pointers into the map remain valid
+
+    std::map<std::string, QueueT> queues_;
+    std::map<std::string, QueueT>::iterator next_queue_;
+    bool shutdown_ = false;
+};
+
+}// namespace
+
+#endif
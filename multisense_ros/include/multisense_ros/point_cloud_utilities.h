@@ -36,6 +36,11 @@
 
 #include <arpa/inet.h>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <ros/node_handle.h>
 #include <sensor_msgs/PointCloud2.h>
 
 namespace multisense_ros {
@@ -46,16 +51,16 @@ uint8_t message_format();
 template <typename T>
 sensor_msgs::PointCloud2 initialize_pointcloud(bool dense,
                                                const std::string& frame_id,
-                                               const std::string &color_channel)
+                                               const std::vector<std::string> &channels)
 {
     const auto datatype = message_format<T>();
 
     sensor_msgs::PointCloud2 point_cloud;
     point_cloud.is_bigendian    = (htonl(1) == 1);
     point_cloud.is_dense        = dense;
-    point_cloud.point_step      = 4 * sizeof(T);
+    point_cloud.point_step      = (3 + channels.size()) * sizeof(T);
     point_cloud.header.frame_id = frame_id;
-    point_cloud.fields.resize(4);
+    point_cloud.fields.resize(3 + channels.size());
     point_cloud.fields[0].name     = "x";
     point_cloud.fields[0].offset   = 0;
     point_cloud.fields[0].count    = 1;
@@ -68,14 +73,158 @@ sensor_msgs::PointCloud2 initialize_pointcloud(bool dense,
     point_cloud.fields[2].offset   = 2 * sizeof(T);
     point_cloud.fields[2].count    = 1;
     point_cloud.fields[2].datatype = datatype;
-    point_cloud.fields[3].name     = color_channel;
-    point_cloud.fields[3].offset   = 3 * sizeof(T);
-    point_cloud.fields[3].count    = 1;
-    point_cloud.fields[3].datatype = datatype;
+
+    for (size_t i = 0 ; i < channels.size() ; ++i)
+    {
+        point_cloud.fields[3 + i].name     = channels[i];
+        point_cloud.fields[3 + i].offset   = (3 + i) * sizeof(T);
+        point_cloud.fields[3 + i].count    = 1;
+        point_cloud.fields[3 + i].datatype = datatype;
+    }
 
     return point_cloud;
 }
 
+template <typename T>
+sensor_msgs::PointCloud2 initialize_pointcloud(bool dense,
+                                               const std::string& frame_id,
+                                               const std::string &color_channel)
+{
+    return initialize_pointcloud<T>(dense, frame_id, std::vector<std::string>{color_channel});
+}
+
+///
+/// @brief Memory layouts of published pointcloud points. Every layout starts with float32 x, y, and z
+///
+enum class PointLayout
+{
+    //
+    // x, y, z. The channels of the pointcloud are not published
+
+    XYZ,
+
+    //
+    // x, y, z, followed by each channel
+
+    XYZ_CHANNELS,
+
+    //
+    // x, y, z, padding, followed by each channel and padded to a multiple of 16 bytes. Matches the memory layout of
+    // the aligned PCL point types, such as pcl::PointXYZI and pcl::PointXYZRGB
+
+    XYZ_PAD_CHANNELS
+};
+
+///
+/// @brief A 32 bit channel of a pointcloud point. Channels default to float32, which is also the datatype PCL and
+///        RViz expect for packed rgb colors
+///
+struct PointChannel
+{
+    PointChannel(const char *name_, uint8_t datatype_ = sensor_msgs::PointField::FLOAT32):
+        name(name_),
+        datatype(datatype_)
+    {
+    }
+
+    PointChannel(const std::string &name_, uint8_t datatype_ = sensor_msgs::PointField::FLOAT32):
+        name(name_),
+        datatype(datatype_)
+    {
+    }
+
+    std::string name;
+    uint8_t datatype;
+};
+
+///
+/// @brief Compile time description of a point layout. The 32 bit channels of a pointcloud (intensity, rgb, ...)
+///        are stored in order starting at CHANNEL_OFFSET, each with its own datatype
+///
+template <PointLayout Layout>
+struct PointLayoutTraits
+{
+    static constexpr bool HAS_CHANNELS = Layout != PointLayout::XYZ;
+    static constexpr uint32_t CHANNEL_OFFSET = (Layout == PointLayout::XYZ_PAD_CHANNELS ? 4 : 3) * sizeof(float);
+    static constexpr uint32_t CHANNEL_SIZE = sizeof(uint32_t);
+
+    static constexpr uint32_t channelOffset(uint32_t channel)
+    {
+        return CHANNEL_OFFSET + channel * CHANNEL_SIZE;
+    }
+
+    static constexpr uint32_t pointStep(uint32_t channels)
+    {
+        return Layout == PointLayout::XYZ ? 3 * sizeof(float) :
+               Layout == PointLayout::XYZ_CHANNELS ? channelOffset(channels) :
+               16 * ((channelOffset(channels) + 15) / 16);
+    }
+};
+
+template <PointLayout Layout>
+constexpr bool PointLayoutTraits<Layout>::HAS_CHANNELS;
+
+template <PointLayout Layout>
+constexpr uint32_t PointLayoutTraits<Layout>::CHANNEL_OFFSET;
+
+template <PointLayout Layout>
+constexpr uint32_t PointLayoutTraits<Layout>::CHANNEL_SIZE;
+
+///
+/// @brief Create a pointcloud with float32 x, y, and z and the given channels, laid out as described by a point
+///        layout
+///
+template <PointLayout Layout>
+sensor_msgs::PointCloud2 initialize_pointcloud(bool dense,
+                                               const std::string& frame_id,
+                                               const std::vector<PointChannel> &channels)
+{
+    using Traits = PointLayoutTraits<Layout>;
+
+    auto point_cloud = initialize_pointcloud<float>(dense, frame_id, std::vector<std::string>{});
+
+    if (Traits::HAS_CHANNELS)
+    {
+        for (size_t i = 0 ; i < channels.size() ; ++i)
+        {
+            sensor_msgs::PointField field;
+            field.name     = channels[i].name;
+            field.offset   = Traits::channelOffset(i);
+            field.count    = 1;
+            field.datatype = channels[i].datatype;
+
+            point_cloud.fields.push_back(field);
+        }
+    }
+
+    point_cloud.point_step = Traits::pointStep(point_cloud.fields.size() - 3);
+
+    return point_cloud;
+}
+
+sensor_msgs::PointCloud2 initialize_pointcloud(PointLayout layout,
+                                               bool dense,
+                                               const std::string& frame_id,
+                                               const std::vector<PointChannel> &channels);
+
+///
+/// @brief Byte offset of the first channel of the points of a pointcloud created with initialize_pointcloud
+/// @return The offset, or 0 if the points have no channels
+///
+inline uint32_t channel_offset(const sensor_msgs::PointCloud2 &point_cloud)
+{
+    return point_cloud.fields.size() > 3 ? point_cloud.fields[3].offset : 0;
+}
+
+///
+/// @brief Read the point layout of a pointcloud topic from the parameter <topic>_layout. Valid values are "xyz",
+///        "xyz_channels", and "xyz_pad_channels"
+/// @return The layout, or default_layout if the parameter is not set or invalid
+///
+PointLayout point_layout_param(const ros::NodeHandle &nh,
+                               const std::string &topic,
+                               PointLayout default_layout = PointLayout::XYZ_CHANNELS);
+
 
 }// namespace
 
@@ -43,7 +43,7 @@ namespace multisense_ros {
 class Pps {
 public:
 
-    Pps(crl::multisense::Channel* driver);
+    Pps(crl::multisense::Channel* driver, const ros::NodeHandle& nh = ros::NodeHandle(""));
     ~Pps();
 
     void ppsCallback(const crl::multisense::pps::Header& header);
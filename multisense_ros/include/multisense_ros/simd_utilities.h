@@ -0,0 +1,64 @@
+/**
+ * @file simd_utilities.h
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef MULTISENSE_ROS_SIMD_UTILITIES_H
+#define MULTISENSE_ROS_SIMD_UTILITIES_H
+
+//
+// Vectorized kernels are only compiled for x86 targets. Every kernel also has a scalar implementation which is used
+// on all other architectures
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MULTISENSE_ROS_X86_SIMD 1
+#else
+#define MULTISENSE_ROS_X86_SIMD 0
+#endif
+
+namespace multisense_ros {
+
+enum class SimdLevel {SCALAR, SSE4, AVX2};
+
+///
+/// @brief Get the widest instruction set the vectorized kernels can use on the host CPU. The CPU is only queried
+///        once. Setting the MULTISENSE_ROS_DISABLE_SIMD environment variable forces the scalar kernels
+///
+SimdLevel simdLevel();
+
+///
+/// @brief Get a human readable name for a SIMD level
+///
+const char* simdLevelString(SimdLevel level);
+
+}// namespace
+
+#endif
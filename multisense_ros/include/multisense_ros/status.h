@@ -43,7 +43,7 @@ namespace multisense_ros {
 class Status {
 public:
 
-    Status(crl::multisense::Channel* driver);
+    Status(crl::multisense::Channel* driver, const ros::NodeHandle& nh = ros::NodeHandle(""));
     ~Status();
 
 private:
@@ -0,0 +1,209 @@
+/**
+ * @file stereo_point_cloud_utilities.h
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#ifndef MULTISENSE_ROS_STEREO_POINT_CLOUD_UTILITIES_H
+#define MULTISENSE_ROS_STEREO_POINT_CLOUD_UTILITIES_H
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <opencv2/opencv.hpp>
+
+#include <sensor_msgs/CameraInfo.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include <multisense_lib/MultiSenseTypes.hh>
+
+#include <multisense_ros/camera_utilities.h>
+
+namespace multisense_ros {
+
+//
+// Flags selecting which stereo pointclouds a pointcloud kernel generates, and how it colors them. AUX_COLOR colors
+// points by projecting them into the rectified aux image rather than sampling the rectified left image. SPARSE_COLOR
+// colors points by rectifying and converting only the left color pixels of the points which are written, rather than
+// sampling a fully rectified left image. AUX_COLOR and SPARSE_COLOR are mutually exclusive.
+// LUMA_COLOR_ORGANIZED_POINTCLOUD is an organized pointcloud carrying both the luma and color of each point
+
+static constexpr uint32_t LUMA_POINTCLOUD = 1 << 0;
+static constexpr uint32_t COLOR_POINTCLOUD = 1 << 1;
+static constexpr uint32_t LUMA_ORGANIZED_POINTCLOUD = 1 << 2;
+static constexpr uint32_t COLOR_ORGANIZED_POINTCLOUD = 1 << 3;
+static constexpr uint32_t AUX_COLOR = 1 << 4;
+static constexpr uint32_t SPARSE_COLOR = 1 << 5;
+static constexpr uint32_t LUMA_COLOR_ORGANIZED_POINTCLOUD = 1 << 6;
+static constexpr uint32_t ALL_STEREO_POINTCLOUD_OUTPUTS = (1 << 7) - 1;
+
+///
+/// @brief Half-open range of image columns [begin, end)
+///
+struct ColumnRangeT
+{
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+///
+/// @brief The columns of each image row which are not removed by the border clip. Both border clip shapes are convex
+///        so every row has a single contiguous range of valid columns
+///
+struct BorderClipMaskT
+{
+    BorderClip type = BorderClip::NONE;
+    double value = 0.0;
+    size_t width = 0;
+    size_t height = 0;
+    std::vector<ColumnRangeT> columns;
+};
+
+BorderClipMaskT makeBorderClipMask(const BorderClip &border_clip_type,
+                                   double border_clip_value,
+                                   size_t width,
+                                   size_t height);
+
+///
+/// @brief The nearest pixel of a color image for each pixel of a disparity image, for color images sampled at their
+///        own resolution rather than resized to the disparity resolution. Identity when the resolutions match
+///
+struct ColorPixelMapT
+{
+    size_t width = 0;
+    size_t height = 0;
+    size_t color_width = 0;
+    size_t color_height = 0;
+    std::vector<uint32_t> columns;
+    std::vector<uint32_t> rows;
+};
+
+ColorPixelMapT makeColorPixelMap(size_t width, size_t height, size_t color_width, size_t color_height);
+
+///
+/// @brief Determine if the pixel (u, v) is removed by the border clip
+///
+bool clipPoint(const BorderClip& border_clip_type,
+               double border_clip_value,
+               size_t width,
+               size_t height,
+               size_t u,
+               size_t v);
+
+///
+/// @brief Bilinearly interpolate a color pixel from a CV_8UC3 image
+///
+cv::Vec3b interpolate_color(const Eigen::Vector2f &pixel, const cv::Mat &image);
+
+bool isValidReprojectedPoint(const Eigen::Vector3f& pt, float squared_max_range);
+
+///
+/// @brief Everything needed to generate the stereo pointclouds for a single disparity image
+///
+struct StereoPointCloudFrameT
+{
+    const crl::multisense::image::Header *disparity = nullptr;
+
+    //
+    // Left rectified luma image. Required for the luma pointclouds
+
+    const crl::multisense::image::Header *luma = nullptr;
+
+    //
+    // Rectified color image. Required for the color pointclouds unless they are colored with SPARSE_COLOR. Must match
+    // the disparity resolution unless the points are colored using the aux camera, in which case it is sampled at its
+    // own resolution
+
+    const cv::Mat *rectified_color = nullptr;
+
+    //
+    // Unrectified left color image and its fixed point rectification maps. Required when coloring points with
+    // SPARSE_COLOR. Both must match the disparity resolution
+
+    const Ycbcr420ImageT *color = nullptr;
+    const RectificationRemapT *color_remap = nullptr;
+
+    const RayTableT *ray_table = nullptr;
+    const BorderClipMaskT *border_clip = nullptr;
+
+    //
+    // Required when coloring points using the aux camera. The projection table must match the disparity resolution,
+    // and the pixel map colors points without a valid disparity from the rectified color image
+
+    const AuxProjectionTableT *aux_projection = nullptr;
+    const ColorPixelMapT *aux_pixel_map = nullptr;
+
+    float squared_max_range = 0.0f;
+
+    //
+    // Write luma to the luma and luma organized pointclouds as float32 values. Otherwise the raw bits of the integer
+    // luma are stored in their float32 intensity fields, as published by earlier releases
+
+    bool float_intensity = false;
+
+    //
+    // Output pointclouds. Only the pointclouds selected by the kernel outputs are written, and they must already be
+    // sized to hold every pixel of the disparity image. Each pointcloud may use any point layout created by
+    // initialize_pointcloud. The channels of the luma and color pointcloud are a float32 luma and packed color, and
+    // of the others either luma or color
+
+    sensor_msgs::PointCloud2 *luma_point_cloud = nullptr;
+    sensor_msgs::PointCloud2 *color_point_cloud = nullptr;
+    sensor_msgs::PointCloud2 *luma_organized_point_cloud = nullptr;
+    sensor_msgs::PointCloud2 *color_organized_point_cloud = nullptr;
+    sensor_msgs::PointCloud2 *luma_color_organized_point_cloud = nullptr;
+};
+
+///
+/// @brief Generate pointcloud points for the disparity rows [begin_row, end_row). Unorganized points are written
+///        to the unorganized pointclouds starting at point point_offset, and organized points are written at their
+///        pixel index. row_buffer must hold 4 * width floats
+/// @return The number of points written to the unorganized pointclouds
+///
+typedef size_t (*StereoPointCloudKernel)(const StereoPointCloudFrameT &frame,
+                                         size_t begin_row,
+                                         size_t end_row,
+                                         size_t point_offset,
+                                         float *row_buffer);
+
+///
+/// @brief Select the pointcloud kernel specialized for a combination of pointcloud output flags, disparity
+///        depth, and luma depth. The specialized kernels have no per-pixel branches on any of these parameters
+///        AUX_COLOR and SPARSE_COLOR are ignored when no color pointcloud is requested
+/// @return The kernel, or nullptr if the disparity or luma depth is not supported, the output flags request no
+///         pointcloud, or the output flags are invalid
+///
+StereoPointCloudKernel selectStereoPointCloudKernel(uint32_t outputs, uint32_t disparity_bits, uint32_t luma_bits);
+
+}// namespace
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * @file buffer_image.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <multisense_ros/buffer_image.h>
+
+namespace multisense_ros {
+
+CallbackBufferLimiter::CallbackBufferLimiter(crl::multisense::Channel* driver, size_t max_buffers):
+    driver_(driver),
+    max_buffers_(max_buffers),
+    outstanding_(std::make_shared<std::atomic<size_t>>(0))
+{
+}
+
+std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>>
+CallbackBufferLimiter::reserve(const crl::multisense::image::Header& header)
+{
+    //
+    // Claim a slot before reserving the buffer so concurrent image callbacks can never exceed the limit
+
+    size_t outstanding = outstanding_->load();
+    do {
+        if (outstanding >= max_buffers_) {
+            return nullptr;
+        }
+    } while (!outstanding_->compare_exchange_weak(outstanding, outstanding + 1));
+
+    const auto counter = outstanding_;
+
+    //
+    // Share the existing reservation of an image dispatched to a worker thread
+
+    const auto dispatched = DispatchedImageScope::current();
+    if (nullptr != dispatched && (*dispatched)->data().imageDataP == header.imageDataP) {
+
+        const auto image = *dispatched;
+
+        return std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>>(
+            image.get(),
+            [counter, image](const BufferWrapper<crl::multisense::image::Header>*)
+            {
+                --(*counter);
+            });
+    }
+
+    return std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>>(
+        new BufferWrapper<crl::multisense::image::Header>(driver_, header),
+        [counter](const BufferWrapper<crl::multisense::image::Header> *buffer)
+        {
+            delete buffer;
+            --(*counter);
+        });
+}
+
+size_t CallbackBufferLimiter::outstanding() const noexcept
+{
+    return outstanding_->load();
+}
+
+namespace { // anonymous
+
+thread_local const std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>> *dispatched_image = nullptr;
+
+} // anonymous
+
+DispatchedImageScope::DispatchedImageScope(
+    const std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>> &image):
+    previous_(dispatched_image)
+{
+    dispatched_image = &image;
+}
+
+DispatchedImageScope::~DispatchedImageScope()
+{
+    dispatched_image = previous_;
+}
+
+const std::shared_ptr<const BufferWrapper<crl::multisense::image::Header>>* DispatchedImageScope::current() noexcept
+{
+    return dispatched_image;
+}
+
+}// namespace
@@ -32,12 +32,15 @@
  **/
 
 #include <arpa/inet.h>
+#include <cstring>
 #include <fstream>
 #include <turbojpeg.h>
 
+#include <boost/make_shared.hpp>
 #include <Eigen/Geometry>
 #include <opencv2/opencv.hpp>
 
+#include <sensor_msgs/CompressedImage.h>
 #include <sensor_msgs/distortion_models.h>
 #include <sensor_msgs/image_encodings.h>
 #include <tf2/LinearMath/Transform.h>
@@ -50,6 +53,7 @@
 #include <multisense_ros/DeviceInfo.h>
 #include <multisense_ros/Histogram.h>
 #include <multisense_ros/point_cloud_utilities.h>
+#include <multisense_ros/stereo_point_cloud_utilities.h>
 
 using namespace crl::multisense;
 
@@ -87,146 +91,118 @@ constexpr DataSource allImageSources = (Source_Luma_Left             |
                                         Source_Disparity_Cost        |
                                         Source_Jpeg_Left);
 
+//
+// Readable names of the image sources used for latency tracking
+
+std::string sourceName(DataSource source)
+{
+    switch (source) {
+        case Source_Luma_Left:                  return "luma_left";
+        case Source_Luma_Right:                 return "luma_right";
+        case Source_Luma_Aux:                   return "luma_aux";
+        case Source_Luma_Rectified_Left:        return "luma_rectified_left";
+        case Source_Luma_Rectified_Right:       return "luma_rectified_right";
+        case Source_Luma_Rectified_Aux:         return "luma_rectified_aux";
+        case Source_Chroma_Left:                return "chroma_left";
+        case Source_Chroma_Aux:                 return "chroma_aux";
+        case Source_Chroma_Rectified_Aux:       return "chroma_rectified_aux";
+        case Source_Disparity:                  return "disparity_left";
+        case Source_Disparity_Right:            return "disparity_right";
+        case Source_Disparity_Cost:             return "disparity_cost";
+        case Source_Jpeg_Left:                  return "jpeg_left";
+        case Source_Ground_Surface_Class_Image: return "ground_surface_class";
+        default:                                return std::to_string(source);
+    }
+}
+
 //
 // Shims for C-style driver callbacks
 
 void monoCB(const image::Header& header, void* userDataP)
-{ reinterpret_cast<Camera*>(userDataP)->monoCallback(header); }
+{ reinterpret_cast<Camera*>(userDataP)->dispatch("mono", header, &Camera::monoCallback); }
 void rectCB(const image::Header& header, void* userDataP)
-{ reinterpret_cast<Camera*>(userDataP)->rectCallback(header); }
+{ reinterpret_cast<Camera*>(userDataP)->dispatch("rect", header, &Camera::rectCallback); }
 void depthCB(const image::Header& header, void* userDataP)
-{ reinterpret_cast<Camera*>(userDataP)->depthCallback(header); }
-void pointCB(const image::Header& header, void* userDataP)
-{ reinterpret_cast<Camera*>(userDataP)->pointCloudCallback(header); }
-void rawCB(const image::Header& header, void* userDataP)
-{ reinterpret_cast<Camera*>(userDataP)->rawCamDataCallback(header); }
-void colorCB(const image::Header& header, void* userDataP)
-{ reinterpret_cast<Camera*>(userDataP)->colorImageCallback(header); }
+{ reinterpret_cast<Camera*>(userDataP)->dispatch("depth", header, &Camera::depthCallback); }
 void dispCB(const image::Header& header, void* userDataP)
-{ reinterpret_cast<Camera*>(userDataP)->disparityImageCallback(header); }
+{ reinterpret_cast<Camera*>(userDataP)->dispatch("disparity_image", header, &Camera::disparityImageCallback); }
 void jpegCB(const image::Header& header, void* userDataP)
-{ reinterpret_cast<Camera*>(userDataP)->jpegImageCallback(header); }
+{ reinterpret_cast<Camera*>(userDataP)->dispatch("jpeg", header, &Camera::jpegImageCallback); }
 void histCB(const image::Header& header, void* userDataP)
 { reinterpret_cast<Camera*>(userDataP)->histogramCallback(header); }
-void colorizeCB(const image::Header& header, void* userDataP)
-{ reinterpret_cast<Camera*>(userDataP)->colorizeCallback(header); }
+void assembleCB(const image::Header& header, void* userDataP)
+{ reinterpret_cast<Camera*>(userDataP)->assembleCallback(header); }
 void groundSurfaceCB(const image::Header& header, void* userDataP)
-{ reinterpret_cast<Camera*>(userDataP)->groundSurfaceCallback(header); }
+{ reinterpret_cast<Camera*>(userDataP)->dispatch("ground_surface", header, &Camera::groundSurfaceCallback); }
 void groundSurfaceSplineCB(const ground_surface::Header& header, void* userDataP)
 { reinterpret_cast<Camera*>(userDataP)->groundSurfaceSplineCallback(header); }
 
+//
+// turbojpeg decompressor which lives as long as the thread which created it. JPEG callbacks may run on any worker
+// thread, so each thread reuses its own decompressor rather than creating one per image
 
-bool isValidReprojectedPoint(const Eigen::Vector3f& pt, float squared_max_range)
-{
-    return pt[2] > 0.0f && std::isfinite(pt[2]) && pt.squaredNorm() < squared_max_range;
-}
-
-void writePoint(sensor_msgs::PointCloud2 &pointcloud, size_t index, const Eigen::Vector3f &point, uint32_t color)
+class JpegDecompressor
 {
-    float* cloudP = reinterpret_cast<float*>(&(pointcloud.data[index * pointcloud.point_step]));
-    cloudP[0] = point[0];
-    cloudP[1] = point[1];
-    cloudP[2] = point[2];
-
-    uint32_t* colorP = reinterpret_cast<uint32_t*>(&(cloudP[3]));
-    colorP[0] = color;
-}
+public:
+    JpegDecompressor(): handle_(tjInitDecompress()) {}
 
-void writePoint(sensor_msgs::PointCloud2 &pointcloud,
-                size_t pointcloud_index,
-                const Eigen::Vector3f &point,
-                size_t image_index,
-                const image::Header &image)
-{
-    switch (image.bitsPerPixel)
+    ~JpegDecompressor()
     {
-        case 8:
-        {
-            const uint32_t luma = static_cast<uint32_t>(reinterpret_cast<const uint8_t*>(image.imageDataP)[image_index]);
-            return writePoint(pointcloud, pointcloud_index, point, luma);
-        }
-        case 16:
-        {
-            const uint32_t luma = static_cast<uint32_t>(reinterpret_cast<const uint16_t*>(image.imageDataP)[image_index]);
-            return writePoint(pointcloud, pointcloud_index, point, luma);
-        }
-        case 32:
-        {
-            const uint32_t luma = reinterpret_cast<const uint32_t*>(image.imageDataP)[image_index];
-            return writePoint(pointcloud, pointcloud_index, point, luma);
+        if (handle_) {
+            tjDestroy(handle_);
         }
     }
-}
 
-bool clipPoint(const BorderClip& borderClipType,
-               double borderClipValue,
-               size_t height,
-               size_t width,
-               size_t u,
-               size_t v)
-{
-    switch (borderClipType)
-    {
-        case BorderClip::NONE:
-        {
-            return false;
-        }
-        case BorderClip::RECTANGULAR:
-        {
-            return !( u >= borderClipValue && u <= width - borderClipValue &&
-                      v >= borderClipValue && v <= height - borderClipValue);
-        }
-        case BorderClip::CIRCULAR:
-        {
-            const double halfWidth = static_cast<double>(width)/2.0;
-            const double halfHeight = static_cast<double>(height)/2.0;
+    tjhandle handle() const { return handle_; }
 
-            const double radius = sqrt( halfWidth * halfWidth + halfHeight * halfHeight ) - borderClipValue;
+private:
+    JpegDecompressor(const JpegDecompressor&) = delete;
+    JpegDecompressor& operator=(const JpegDecompressor&) = delete;
 
-            return !(Eigen::Vector2d{halfWidth - u, halfHeight - v}.norm() < radius);
-        }
-        default:
-        {
-            ROS_WARN("Camera: Unknown border clip type.");
-            break;
-        }
-    }
+    tjhandle handle_;
+};
 
-    return true;
+tjhandle threadJpegDecompressor()
+{
+    thread_local JpegDecompressor decompressor;
+
+    return decompressor.handle();
 }
 
-cv::Vec3b interpolate_color(const Eigen::Vector2f &pixel, const cv::Mat &image)
-{
-    const float width = image.cols;
-    const float height = image.rows;
+//
+// sensor_msgs does not define an encoding constant for NV12
 
-    const float &u = pixel(0);
-    const float &v = pixel(1);
+constexpr char NV12_ENCODING[] = "nv12";
 
-    //
-    // Implement a basic bileinar interpolation scheme
-    // https://en.wikipedia.org/wiki/Bilinear_interpolation
-    //
-    const size_t min_u = static_cast<size_t>(std::min(std::max(std::floor(u), 0.f), width - 1.f));
-    const size_t max_u = static_cast<size_t>(std::min(std::max(std::floor(u) + 1, 0.f), width - 1.f));
-    const size_t min_v = static_cast<size_t>(std::min(std::max(std::floor(v), 0.f), height - 1.f));
-    const size_t max_v = static_cast<size_t>(std::min(std::max(std::floor(v) + 1, 0.f), height - 1.f));
+//
+// Pack a luma image and its interleaved CbCr chroma image into a single NV12 image: the full resolution luma plane
+// followed by the half resolution interleaved CbCr plane. The camera already sends chroma in this layout, so the
+// image is two copies without any per-pixel conversion
+
+boost::shared_ptr<sensor_msgs::Image> makeNv12Image(const image::Header &luma,
+                                                    const image::Header &chroma,
+                                                    const std::string &frame_id,
+                                                    const ros::Time &t)
+{
+    const size_t luma_size = static_cast<size_t>(luma.width) * luma.height;
+    const size_t chroma_size = static_cast<size_t>(2 * (luma.width / 2)) * (luma.height / 2);
 
-    const cv::Vec3d element00 = image.at<cv::Vec3b>(width * min_v + min_u);
-    const cv::Vec3d element01 = image.at<cv::Vec3b>(width * min_v + max_u);
-    const cv::Vec3d element10 = image.at<cv::Vec3b>(width * max_v + min_u);
-    const cv::Vec3d element11 = image.at<cv::Vec3b>(width * max_v + max_u);
+    const auto nv12_image = boost::make_shared<sensor_msgs::Image>();
+    nv12_image->data.resize(luma_size + chroma_size);
 
-    const size_t delta_u = max_u - min_u;
-    const size_t delta_v = max_v - min_v;
+    nv12_image->header.frame_id = frame_id;
+    nv12_image->header.stamp    = t;
+    nv12_image->height          = luma.height;
+    nv12_image->width           = luma.width;
 
-    const double u_ratio = delta_u == 0 ? 1. : (static_cast<double>(max_u) - u) / static_cast<double>(delta_u);
-    const double v_ratio = delta_v == 0 ? 1. : (static_cast<double>(max_v) - v) / static_cast<double>(delta_v);
+    nv12_image->encoding        = NV12_ENCODING;
+    nv12_image->is_bigendian    = (htonl(1) == 1);
+    nv12_image->step            = luma.width;
 
-    const cv::Vec3b f_xy0 = element00 * u_ratio + element01 * (1. - u_ratio);
-    const cv::Vec3b f_xy1 = element10 * u_ratio + element11 * (1. - u_ratio);
+    memcpy(&(nv12_image->data[0]), luma.imageDataP, luma_size);
+    memcpy(&(nv12_image->data[luma_size]), chroma.imageDataP, chroma_size);
 
-    return (f_xy0 * v_ratio + f_xy1 * (1. - v_ratio));
+    return nv12_image;
 }
 
 } // anonymous
@@ -254,6 +230,7 @@ constexpr char Camera::RAW_CAM_CAL_TOPIC[];
 constexpr char Camera::RAW_CAM_CONFIG_TOPIC[];
 constexpr char Camera::RAW_CAM_DATA_TOPIC[];
 constexpr char Camera::HISTOGRAM_TOPIC[];
+constexpr char Camera::LATENCY_METRICS_TOPIC[];
 constexpr char Camera::MONO_TOPIC[];
 constexpr char Camera::RECT_TOPIC[];
 constexpr char Camera::DISPARITY_TOPIC[];
@@ -263,10 +240,17 @@ constexpr char Camera::OPENNI_DEPTH_TOPIC[];
 constexpr char Camera::COST_TOPIC[];
 constexpr char Camera::COLOR_TOPIC[];
 constexpr char Camera::RECT_COLOR_TOPIC[];
+constexpr char Camera::JPEG_COLOR_TOPIC[];
+constexpr char Camera::HALF_COLOR_TOPIC[];
+constexpr char Camera::QUARTER_COLOR_TOPIC[];
+constexpr char Camera::EIGHTH_COLOR_TOPIC[];
+constexpr char Camera::NV12_TOPIC[];
+constexpr char Camera::RECT_NV12_TOPIC[];
 constexpr char Camera::POINTCLOUD_TOPIC[];
 constexpr char Camera::COLOR_POINTCLOUD_TOPIC[];
 constexpr char Camera::ORGANIZED_POINTCLOUD_TOPIC[];
 constexpr char Camera::COLOR_ORGANIZED_POINTCLOUD_TOPIC[];
+constexpr char Camera::LUMA_COLOR_ORGANIZED_POINTCLOUD_TOPIC[];
 constexpr char Camera::MONO_CAMERA_INFO_TOPIC[];
 constexpr char Camera::RECT_CAMERA_INFO_TOPIC[];
 constexpr char Camera::COLOR_CAMERA_INFO_TOPIC[];
@@ -277,10 +261,17 @@ constexpr char Camera::COST_CAMERA_INFO_TOPIC[];
 constexpr char Camera::GROUND_SURFACE_IMAGE_TOPIC[];
 constexpr char Camera::GROUND_SURFACE_INFO_TOPIC[];
 constexpr char Camera::GROUND_SURFACE_POINT_SPLINE_TOPIC[];
-
-Camera::Camera(Channel* driver, const std::string& tf_prefix) :
+constexpr int Camera::DEFAULT_MAX_ZERO_COPY_BUFFERS;
+constexpr int Camera::DEFAULT_MAX_ASSEMBLED_FRAMES;
+constexpr int Camera::DEFAULT_WORKER_QUEUE_DEPTH;
+
+Camera::Camera(Channel* driver,
+               const std::string& tf_prefix,
+               const ros::NodeHandle& nh,
+               const ros::NodeHandle& private_nh,
+               const std::shared_ptr<LatencyRegistry>& latency_registry) :
     driver_(driver),
-    device_nh_(""),
+    device_nh_(nh),
     left_nh_(device_nh_, LEFT),
     right_nh_(device_nh_, RIGHT),
     aux_nh_(device_nh_, AUX),
@@ -314,8 +305,118 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
     pointcloud_max_range_(15.0),
     last_frame_id_(-1),
     border_clip_type_(BorderClip::NONE),
-    border_clip_value_(0.0)
+    border_clip_value_(0.0),
+    latency_registry_(latency_registry ? latency_registry : std::make_shared<LatencyRegistry>())
 {
+    //
+    // Split pointcloud generation across multiple threads if requested. A value of 0 uses every hardware thread
+
+    int pointcloud_threads = 1;
+    private_nh.param<int>("point_cloud_threads", pointcloud_threads, 1);
+    if (pointcloud_threads < 0)
+    {
+        ROS_WARN("Camera: invalid point_cloud_threads %d, using 1", pointcloud_threads);
+        pointcloud_threads = 1;
+    }
+
+    pointcloud_executor_ = std::unique_ptr<RowBandExecutor>(new RowBandExecutor(pointcloud_threads));
+
+    //
+    // Split YCbCr to BGR color conversion across multiple threads if requested. A value of 0 uses every hardware thread
+
+    int color_threads = 1;
+    private_nh.param<int>("color_conversion_threads", color_threads, 1);
+    if (color_threads < 0)
+    {
+        ROS_WARN("Camera: invalid color_conversion_threads %d, using 1", color_threads);
+        color_threads = 1;
+    }
+
+    color_executor_ = std::unique_ptr<RowBandExecutor>(new RowBandExecutor(color_threads));
+
+    //
+    // Optionally move the image processing off of the driver callback threads onto a pool of worker threads. Each
+    // output has its own bounded queue which drops its oldest image when the output can not keep up
+
+    int worker_threads = 0;
+    private_nh.param<int>("worker_threads", worker_threads, 0);
+
+    int worker_queue_depth = DEFAULT_WORKER_QUEUE_DEPTH;
+    private_nh.param<int>("worker_queue_depth", worker_queue_depth, DEFAULT_WORKER_QUEUE_DEPTH);
+    if (worker_queue_depth < 1)
+    {
+        ROS_WARN("Camera: invalid worker_queue_depth %d, using %d", worker_queue_depth, DEFAULT_WORKER_QUEUE_DEPTH);
+        worker_queue_depth = DEFAULT_WORKER_QUEUE_DEPTH;
+    }
+
+    std::vector<int> worker_cpu_affinity;
+    private_nh.param<std::vector<int>>("worker_cpu_affinity", worker_cpu_affinity, std::vector<int>());
+
+    if (worker_threads > 0)
+    {
+        worker_pool_ = std::unique_ptr<WorkerPool>(new WorkerPool(worker_threads, worker_queue_depth, worker_cpu_affinity));
+    }
+
+    //
+    // Look up the latency trackers of every dispatched callback upfront so recording never touches the registry.
+    // Image callbacks are tracked per source, assembled frame callbacks per queue
+
+    const std::vector<std::pair<std::string, DataSource>> image_queues{
+        {"mono", Source_Luma_Left | Source_Luma_Right | Source_Luma_Aux},
+        {"rect", Source_Luma_Rectified_Left | Source_Luma_Rectified_Right | Source_Luma_Rectified_Aux},
+        {"depth", Source_Disparity},
+        {"disparity_image", Source_Disparity | Source_Disparity_Right | Source_Disparity_Cost},
+        {"jpeg", Source_Jpeg_Left},
+        {"ground_surface", Source_Ground_Surface_Class_Image}};
+
+    for (const auto &queue : image_queues) {
+        for (uint32_t i = 0 ; i < 32 ; ++i) {
+            const DataSource source = 1 << i;
+            if (queue.second & source) {
+                latency_trackers_[std::make_pair(queue.first, source)] =
+                    latency_registry_->tracker(queue.first + "/" + sourceName(source));
+            }
+        }
+    }
+
+    for (const auto &queue : {"point_cloud", "raw_cam_data", "left_color", "aux_rect_color", "aux_color"}) {
+        latency_trackers_[std::make_pair(std::string(queue), static_cast<DataSource>(0))] = latency_registry_->tracker(queue);
+    }
+
+    //
+    // Optionally publish raw images which reference the driver buffers directly. LibMultiSense has a fixed pool of
+    // callback buffers, so the number of buffers held by published images is capped. Only subscribers in other
+    // processes and intra-process subscribers which subscribe with BufferImage avoid the copy. Intra-process
+    // sensor_msgs/Image subscribers receive a serialized copy instead of a shared message
+
+    bool zero_copy_images = false;
+    private_nh.param<bool>("zero_copy_images", zero_copy_images, false);
+
+    int max_zero_copy_buffers = DEFAULT_MAX_ZERO_COPY_BUFFERS;
+    private_nh.param<int>("max_zero_copy_buffers", max_zero_copy_buffers, DEFAULT_MAX_ZERO_COPY_BUFFERS);
+
+    if (zero_copy_images && max_zero_copy_buffers > 0)
+    {
+        callback_buffer_limiter_ = std::unique_ptr<CallbackBufferLimiter>(
+            new CallbackBufferLimiter(driver_, static_cast<size_t>(max_zero_copy_buffers)));
+    }
+
+    //
+    // Bound the number of partially received frames, each of which holds driver callback buffers. When zero-copy
+    // images are enabled those buffers also count against the zero-copy buffer limit
+
+    int max_assembled_frames = DEFAULT_MAX_ASSEMBLED_FRAMES;
+    private_nh.param<int>("max_assembled_frames", max_assembled_frames, DEFAULT_MAX_ASSEMBLED_FRAMES);
+    if (max_assembled_frames < 1)
+    {
+        ROS_WARN("Camera: invalid max_assembled_frames %d, using %d", max_assembled_frames, DEFAULT_MAX_ASSEMBLED_FRAMES);
+        max_assembled_frames = DEFAULT_MAX_ASSEMBLED_FRAMES;
+    }
+
+    frame_assembler_ = std::unique_ptr<FrameAssembler>(new FrameAssembler(driver_,
+                                                                           max_assembled_frames,
+                                                                           callback_buffer_limiter_.get()));
+
     //
     // Query device and version information from sensor
 
@@ -354,6 +455,7 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
     raw_cam_cal_pub_    = calibration_nh_.advertise<multisense_ros::RawCamCal>(RAW_CAM_CAL_TOPIC, 1, true);
     raw_cam_config_pub_ = calibration_nh_.advertise<multisense_ros::RawCamConfig>(RAW_CAM_CONFIG_TOPIC, 1, true);
     histogram_pub_      = device_nh_.advertise<multisense_ros::Histogram>(HISTOGRAM_TOPIC, 5);
+    latency_metrics_pub_ = device_nh_.advertise<multisense_ros::LatencyMetrics>(LATENCY_METRICS_TOPIC, 5);
 
     //
     // Create spline-based ground surface publishers for S27/S30 cameras
@@ -389,6 +491,33 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
                               std::bind(&Camera::connectStream, this, Source_Jpeg_Left),
                               std::bind(&Camera::disconnectStream, this, Source_Jpeg_Left));
 
+        //
+        // JPEGs from the sensor are forwarded without decoding. This is a separate base topic from image_color so
+        // image_transport's own compressed publisher does not share the topic, but image_transport subscribers can
+        // still receive it with the compressed transport
+
+        left_rgb_jpeg_pub_ = left_nh_.advertise<sensor_msgs::CompressedImage>(JPEG_COLOR_TOPIC, 5,
+                              std::bind(&Camera::connectStream, this, Source_Jpeg_Left),
+                              std::bind(&Camera::disconnectStream, this, Source_Jpeg_Left));
+
+        //
+        // Reduced resolution color images are decoded at the reduced resolution, so they are much cheaper to
+        // produce than a full resolution decode
+
+        const std::vector<std::pair<int, const char*>> scaled_color_topics{{2, HALF_COLOR_TOPIC},
+                                                                          {4, QUARTER_COLOR_TOPIC},
+                                                                          {8, EIGHTH_COLOR_TOPIC}};
+
+        for (const auto &topic : scaled_color_topics) {
+            ScaledColorPublisherT scaled_publisher;
+            scaled_publisher.denominator = topic.first;
+            scaled_publisher.publisher = left_rgb_transport_.advertiseCamera(topic.second, 5,
+                                         std::bind(&Camera::connectStream, this, Source_Jpeg_Left),
+                                         std::bind(&Camera::disconnectStream, this, Source_Jpeg_Left));
+
+            left_rgb_scaled_cam_pubs_.push_back(std::move(scaled_publisher));
+        }
+
         left_mono_cam_info_pub_  = left_nh_.advertise<sensor_msgs::CameraInfo>(MONO_CAMERA_INFO_TOPIC, 1, true);
         left_rgb_cam_info_pub_  = left_nh_.advertise<sensor_msgs::CameraInfo>(COLOR_CAMERA_INFO_TOPIC, 1, true);
         left_rgb_rect_cam_info_pub_  = left_nh_.advertise<sensor_msgs::CameraInfo>(RECT_COLOR_CAMERA_INFO_TOPIC, 1, true);
@@ -410,6 +539,9 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
         left_rgb_rect_cam_pub_ = left_rgb_rect_transport_.advertiseCamera(RECT_COLOR_TOPIC, 5,
                                  std::bind(&Camera::connectStream, this, Source_Luma_Left | Source_Chroma_Left),
                                  std::bind(&Camera::disconnectStream, this, Source_Luma_Left | Source_Chroma_Left));
+        left_nv12_cam_pub_  = left_rgb_transport_.advertise(NV12_TOPIC, 5,
+                              std::bind(&Camera::connectStream, this, Source_Luma_Left | Source_Chroma_Left),
+                              std::bind(&Camera::disconnectStream, this, Source_Luma_Left | Source_Chroma_Left));
 
         left_mono_cam_info_pub_     = left_nh_.advertise<sensor_msgs::CameraInfo>(MONO_CAMERA_INFO_TOPIC, 1, true);
         left_rect_cam_info_pub_     = left_nh_.advertise<sensor_msgs::CameraInfo>(RECT_CAMERA_INFO_TOPIC, 1, true);
@@ -452,6 +584,10 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
                                       std::bind(&Camera::connectStream, this, Source_Luma_Aux | Source_Chroma_Aux),
                                       std::bind(&Camera::disconnectStream, this, Source_Luma_Aux | Source_Chroma_Aux));
 
+                aux_nv12_cam_pub_  = aux_rgb_transport_.advertise(NV12_TOPIC, 5,
+                                      std::bind(&Camera::connectStream, this, Source_Luma_Aux | Source_Chroma_Aux),
+                                      std::bind(&Camera::disconnectStream, this, Source_Luma_Aux | Source_Chroma_Aux));
+
                 aux_rgb_cam_info_pub_  = aux_nh_.advertise<sensor_msgs::CameraInfo>(COLOR_CAMERA_INFO_TOPIC, 1, true);
 
                 aux_rect_cam_pub_ = aux_rect_transport_.advertiseCamera(RECT_TOPIC, 5,
@@ -464,6 +600,10 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
                                           std::bind(&Camera::connectStream, this, Source_Luma_Rectified_Aux | Source_Chroma_Rectified_Aux),
                                           std::bind(&Camera::disconnectStream, this, Source_Luma_Rectified_Aux | Source_Chroma_Rectified_Aux));
 
+                aux_nv12_rect_cam_pub_ = aux_rgb_rect_transport_.advertise(RECT_NV12_TOPIC, 5,
+                                          std::bind(&Camera::connectStream, this, Source_Luma_Rectified_Aux | Source_Chroma_Rectified_Aux),
+                                          std::bind(&Camera::disconnectStream, this, Source_Luma_Rectified_Aux | Source_Chroma_Rectified_Aux));
+
                 aux_rgb_rect_cam_info_pub_  = aux_nh_.advertise<sensor_msgs::CameraInfo>(RECT_COLOR_CAMERA_INFO_TOPIC, 1, true);
             }
             else {
@@ -479,6 +619,10 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
                                       std::bind(&Camera::connectStream, this, Source_Luma_Left | Source_Chroma_Left),
                                       std::bind(&Camera::disconnectStream, this, Source_Luma_Left | Source_Chroma_Left));
 
+                left_nv12_cam_pub_  = left_rgb_transport_.advertise(NV12_TOPIC, 5,
+                                      std::bind(&Camera::connectStream, this, Source_Luma_Left | Source_Chroma_Left),
+                                      std::bind(&Camera::disconnectStream, this, Source_Luma_Left | Source_Chroma_Left));
+
             }
 
             const auto point_cloud_color_topics = has_aux_camera_ ? Source_Luma_Rectified_Aux | Source_Chroma_Rectified_Aux :
@@ -495,6 +639,16 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
                                   std::bind(&Camera::disconnectStream, this,
                                   Source_Disparity | point_cloud_color_topics));
 
+            //
+            // A single organized pointcloud with both luma and color, for consumers which would otherwise subscribe
+            // to both organized pointclouds
+
+            luma_color_organized_point_cloud_pub_ = device_nh_.advertise<sensor_msgs::PointCloud2>(LUMA_COLOR_ORGANIZED_POINTCLOUD_TOPIC, 5,
+                                  std::bind(&Camera::connectStream, this,
+                                  Source_Disparity | Source_Luma_Rectified_Left | point_cloud_color_topics),
+                                  std::bind(&Camera::disconnectStream, this,
+                                  Source_Disparity | Source_Luma_Rectified_Left | point_cloud_color_topics));
+
         }
 
         luma_point_cloud_pub_ = device_nh_.advertise<sensor_msgs::PointCloud2>(POINTCLOUD_TOPIC, 5,
@@ -545,6 +699,34 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
         depth_cam_info_pub_ = device_nh_.advertise<sensor_msgs::CameraInfo>(DEPTH_CAMERA_INFO_TOPIC, 1, true);
     }
 
+    //
+    // Advertise the zero-copy image publishers alongside the image transports which are active for this device
+
+    if (callback_buffer_limiter_) {
+
+        const auto advertise_buffer_image = [this](const auto &transport_pub,
+                                                   DataSource source,
+                                                   ros::NodeHandle &nh,
+                                                   const char *topic)
+        {
+            if (transport_pub) {
+                buffer_image_pubs_[source] = BufferImagePublisher{
+                    nh.advertise<BufferImage>(topic, 5),
+                    [&transport_pub]() { return transport_pub.getNumSubscribers(); }};
+            }
+        };
+
+        advertise_buffer_image(left_mono_cam_pub_, Source_Luma_Left, left_nh_, MONO_TOPIC);
+        advertise_buffer_image(right_mono_cam_pub_, Source_Luma_Right, right_nh_, MONO_TOPIC);
+        advertise_buffer_image(aux_mono_cam_pub_, Source_Luma_Aux, aux_nh_, MONO_TOPIC);
+        advertise_buffer_image(left_rect_cam_pub_, Source_Luma_Rectified_Left, left_nh_, RECT_TOPIC);
+        advertise_buffer_image(right_rect_cam_pub_, Source_Luma_Rectified_Right, right_nh_, RECT_TOPIC);
+        advertise_buffer_image(aux_rect_cam_pub_, Source_Luma_Rectified_Aux, aux_nh_, RECT_TOPIC);
+        advertise_buffer_image(left_disparity_pub_, Source_Disparity, left_nh_, DISPARITY_TOPIC);
+        advertise_buffer_image(right_disparity_pub_, Source_Disparity_Right, right_nh_, DISPARITY_TOPIC);
+        advertise_buffer_image(left_disparity_cost_pub_, Source_Disparity_Cost, left_nh_, COST_TOPIC);
+    }
+
     //
     // All image streams off
 
@@ -691,12 +873,28 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
     updateConfig(image_config);
 
     //
-    // Initialize point cloud data structures
-
-    luma_point_cloud_ = initialize_pointcloud<float>(true, frame_id_rectified_left_, "intensity");
-    color_point_cloud_ = initialize_pointcloud<float>(true, frame_id_rectified_left_, "rgb");
-    luma_organized_point_cloud_ = initialize_pointcloud<float>(false, frame_id_rectified_left_, "intensity");
-    color_organized_point_cloud_ = initialize_pointcloud<float>(false, frame_id_rectified_left_, "rgb");
+    // Initialize point cloud data structures. The point layout of each pointcloud topic is selected by its
+    // <topic>_layout parameter, so fields which consumers do not use are not published. The intensity fields of the
+    // luma pointclouds hold the raw bits of the integer luma unless float_intensity is set
+
+    private_nh.param<bool>("float_intensity", pointcloud_float_intensity_, false);
+
+    luma_point_cloud_ = initialize_pointcloud(point_layout_param(private_nh, POINTCLOUD_TOPIC),
+                                              true, frame_id_rectified_left_, {"intensity"});
+    color_point_cloud_ = initialize_pointcloud(point_layout_param(private_nh, COLOR_POINTCLOUD_TOPIC),
+                                               true, frame_id_rectified_left_, {"rgb"});
+    luma_organized_point_cloud_ = initialize_pointcloud(point_layout_param(private_nh, ORGANIZED_POINTCLOUD_TOPIC),
+                                                        false, frame_id_rectified_left_, {"intensity"});
+    color_organized_point_cloud_ = initialize_pointcloud(point_layout_param(private_nh,
+                                                                            COLOR_ORGANIZED_POINTCLOUD_TOPIC),
+                                                         false, frame_id_rectified_left_, {"rgb"});
+    luma_color_organized_point_cloud_ = initialize_pointcloud(point_layout_param(private_nh,
+                                                                                 LUMA_COLOR_ORGANIZED_POINTCLOUD_TOPIC),
+                                                              false, frame_id_rectified_left_, {"intensity", "rgb"});
+
+    ground_surface_spline_layout_ = point_layout_param(private_nh,
+                                                       std::string("ground_surface_") +
+                                                       GROUND_SURFACE_POINT_SPLINE_TOPIC);
 
     //
     // Add driver-level callbacks.
@@ -712,14 +910,87 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
 
     } else {
 
-        driver_->addIsolatedCallback(colorizeCB, Source_Luma_Rectified_Aux | Source_Chroma_Rectified_Aux | Source_Luma_Aux |
-                                                 Source_Luma_Left | Source_Chroma_Left | Source_Luma_Rectified_Left, this);
+        //
+        // Pointclouds, raw cam data, and color images combine images from several sources. Those images are grouped
+        // by frame id in the frame assembler, which calls the matching consumer once all of its images have arrived.
+        // Every assembled image is inserted from a single driver callback thread, so without a worker pool a consumer
+        // never runs concurrently with itself
+
+        frame_assembler_->addConsumer(
+            [this]() -> DataSource
+            {
+                const bool luma_color = luma_color_organized_point_cloud_pub_.getNumSubscribers() > 0;
+                const bool luma = luma_point_cloud_pub_.getNumSubscribers() > 0 ||
+                                  luma_organized_point_cloud_pub_.getNumSubscribers() > 0 || luma_color;
+                const bool color = color_point_cloud_pub_.getNumSubscribers() > 0 ||
+                                   color_organized_point_cloud_pub_.getNumSubscribers() > 0 || luma_color;
+
+                if (!luma && !color) {
+                    return 0;
+                }
+
+                const DataSource color_sources = has_aux_camera_ ? (Source_Luma_Rectified_Aux | Source_Chroma_Rectified_Aux) :
+                                                                   (Source_Luma_Left | Source_Chroma_Left);
+
+                return Source_Disparity | (luma ? Source_Luma_Rectified_Left : 0) | (color ? color_sources : 0);
+            },
+            [this](const AssembledFrame &frame)
+            {
+                dispatch("point_cloud", frame, [this](const AssembledFrame &f) { pointCloudCallback(f); });
+            });
+
+        frame_assembler_->addConsumer(
+            [this]() -> DataSource
+            {
+                return raw_cam_data_pub_.getNumSubscribers() > 0 ? (Source_Disparity | Source_Luma_Rectified_Left) : 0;
+            },
+            [this](const AssembledFrame &frame)
+            {
+                dispatch("raw_cam_data", frame, [this](const AssembledFrame &f) { rawCamDataCallback(f); });
+            });
+
+        frame_assembler_->addConsumer(
+            [this]() -> DataSource
+            {
+                return (left_rgb_cam_pub_.getNumSubscribers() > 0 || left_rgb_rect_cam_pub_.getNumSubscribers() > 0 ||
+                        left_nv12_cam_pub_.getNumSubscribers() > 0) ? (Source_Luma_Left | Source_Chroma_Left) : 0;
+            },
+            [this](const AssembledFrame &frame)
+            {
+                dispatch("left_color", frame, [this](const AssembledFrame &f)
+                         { colorImageCallback(*f.image(Source_Luma_Left), *f.image(Source_Chroma_Left)); });
+            });
+
+        frame_assembler_->addConsumer(
+            [this]() -> DataSource
+            {
+                return (aux_rgb_rect_cam_pub_.getNumSubscribers() > 0 || aux_nv12_rect_cam_pub_.getNumSubscribers() > 0) ?
+                    (Source_Luma_Rectified_Aux | Source_Chroma_Rectified_Aux) : 0;
+            },
+            [this](const AssembledFrame &frame)
+            {
+                dispatch("aux_rect_color", frame, [this](const AssembledFrame &f)
+                         { colorImageCallback(*f.image(Source_Luma_Rectified_Aux), *f.image(Source_Chroma_Rectified_Aux)); });
+            });
+
+        frame_assembler_->addConsumer(
+            [this]() -> DataSource
+            {
+                return (aux_rgb_cam_pub_.getNumSubscribers() > 0 || aux_nv12_cam_pub_.getNumSubscribers() > 0) ?
+                    (Source_Luma_Aux | Source_Chroma_Aux) : 0;
+            },
+            [this](const AssembledFrame &frame)
+            {
+                dispatch("aux_color", frame, [this](const AssembledFrame &f)
+                         { colorImageCallback(*f.image(Source_Luma_Aux), *f.image(Source_Chroma_Aux)); });
+            });
+
+        driver_->addIsolatedCallback(assembleCB, Source_Luma_Rectified_Aux | Source_Chroma_Rectified_Aux | Source_Luma_Aux |
+                                                 Source_Chroma_Aux | Source_Luma_Left | Source_Chroma_Left |
+                                                 Source_Luma_Rectified_Left | Source_Disparity, this);
         driver_->addIsolatedCallback(monoCB,  Source_Luma_Left | Source_Luma_Right | Source_Luma_Aux, this);
         driver_->addIsolatedCallback(rectCB,  Source_Luma_Rectified_Left | Source_Luma_Rectified_Right | Source_Luma_Rectified_Aux, this);
         driver_->addIsolatedCallback(depthCB, Source_Disparity, this);
-        driver_->addIsolatedCallback(pointCB, Source_Disparity, this);
-        driver_->addIsolatedCallback(rawCB,   Source_Disparity | Source_Luma_Rectified_Left, this);
-        driver_->addIsolatedCallback(colorCB, Source_Chroma_Left | Source_Chroma_Rectified_Aux | Source_Chroma_Aux, this);
         driver_->addIsolatedCallback(dispCB,  Source_Disparity | Source_Disparity_Right | Source_Disparity_Cost, this);
     }
 
@@ -749,6 +1020,14 @@ Camera::Camera(Channel* driver, const std::string& tf_prefix) :
     diagnostic_updater_.setHardwareID(device_info_.name + " " + std::to_string(device_info_.hardwareRevision));
     diagnostic_updater_.add("device_info", this, &Camera::deviceInfoDiagnostic);
     diagnostic_updater_.add("device_status", this, &Camera::deviceStatusDiagnostic);
+    diagnostic_updater_.add("frame_assembler", this, &Camera::frameAssemblerDiagnostic);
+    if (worker_pool_) {
+        diagnostic_updater_.add("worker_pool", this, &Camera::workerPoolDiagnostic);
+    }
+    diagnostic_updater_.add("latency", this, &Camera::latencyDiagnostic);
+    if (system::DeviceInfo::HARDWARE_REV_BCAM == device_info_.hardwareRevision) {
+        diagnostic_updater_.add("jpeg", this, &Camera::jpegDiagnostic);
+    }
     diagnostic_trigger_ = device_nh_.createTimer(ros::Duration(1), &Camera::diagnosticTimerCallback, this);
 }
 
@@ -763,18 +1042,20 @@ Camera::~Camera()
 
     } else {
 
-        driver_->removeIsolatedCallback(colorizeCB);
+        driver_->removeIsolatedCallback(assembleCB);
         driver_->removeIsolatedCallback(monoCB);
         driver_->removeIsolatedCallback(rectCB);
         driver_->removeIsolatedCallback(depthCB);
-        driver_->removeIsolatedCallback(pointCB);
-        driver_->removeIsolatedCallback(rawCB);
-        driver_->removeIsolatedCallback(colorCB);
         driver_->removeIsolatedCallback(dispCB);
     }
 
     driver_->removeIsolatedCallback(groundSurfaceCB);
     driver_->removeIsolatedCallback(groundSurfaceSplineCB);
+
+    //
+    // Finish any running work and release the driver buffers held by queued work before our members are destroyed
+
+    worker_pool_.reset();
 }
 
 void Camera::borderClipChanged(const BorderClip &borderClipType, double borderClipValue)
@@ -875,50 +1156,178 @@ void Camera::jpegImageCallback(const image::Header& header)
     const uint32_t width     = header.width;
     const uint32_t rgbLength = height * width * 3;
 
-    left_rgb_image_.header.frame_id = frame_id_left_;
-    left_rgb_image_.height          = height;
-    left_rgb_image_.width           = width;
-    left_rgb_image_.encoding        = sensor_msgs::image_encodings::RGB8;
-    left_rgb_image_.is_bigendian    = (htonl(1) == 1);
-    left_rgb_image_.step            = 3 * width;
-    left_rgb_image_.header.stamp    = t;
+    const unsigned char *jpeg_data = reinterpret_cast<const unsigned char*>(header.imageDataP);
 
-    left_rgb_image_.data.resize(rgbLength);
-
-    tjhandle jpegDecompressor = tjInitDecompress();
-    tjDecompress2(jpegDecompressor,
-                  reinterpret_cast<unsigned char*>(const_cast<void*>(header.imageDataP)),
-                  header.imageLength,
-                  &(left_rgb_image_.data[0]),
-                  width, 0/*pitch*/, height, TJPF_RGB, 0);
-    tjDestroy(jpegDecompressor);
+    const bool publish_jpeg = left_rgb_jpeg_pub_.getNumSubscribers() > 0;
+    const bool publish_color = left_rgb_cam_pub_.getNumSubscribers() > 0;
+    const bool rectify = left_rgb_rect_cam_pub_.getNumSubscribers() > 0;
 
     const auto left_camera_info = stereo_calibration_manager_->leftCameraInfo(frame_id_left_, t);
 
-    left_rgb_cam_pub_.publish(left_rgb_image_);
-    left_rgb_cam_info_pub_.publish(left_camera_info);
+    //
+    // Forward the JPEG from the sensor unchanged
+
+    if (publish_jpeg) {
+        const auto left_jpeg_image = boost::make_shared<sensor_msgs::CompressedImage>();
+
+        left_jpeg_image->header.frame_id = frame_id_left_;
+        left_jpeg_image->header.stamp    = t;
+        left_jpeg_image->format          = "jpeg";
+        left_jpeg_image->data.assign(jpeg_data, jpeg_data + header.imageLength);
+
+        left_rgb_jpeg_pub_.publish(left_jpeg_image);
+    }
+
+    if (publish_jpeg || publish_color) {
+        left_rgb_cam_info_pub_.publish(left_camera_info);
+    }
+
+    //
+    // Only decode the JPEG if a decoded image is requested
+
+    std::vector<ScaledColorPublisherT*> scaled_publishers;
+    for (auto &scaled_publisher : left_rgb_scaled_cam_pubs_) {
+        if (scaled_publisher.publisher.getNumSubscribers() > 0) {
+            scaled_publishers.push_back(&scaled_publisher);
+        }
+    }
+
+    if (!publish_color && !rectify && scaled_publishers.empty()) {
+        return;
+    }
+
+    const tjhandle jpegDecompressor = threadJpegDecompressor();
+    if (!jpegDecompressor) {
+        ++jpeg_decode_failures_;
+        ROS_ERROR_THROTTLE(1.0, "Camera: failed to create a JPEG decompressor");
+        return;
+    }
+
+    const auto decode_failed = [this](const char *step) {
+        ++jpeg_decode_failures_;
+        ROS_WARN_THROTTLE(1.0, "Camera: %s failed: %s", step, tjGetErrorStr());
+    };
+
+    int jpeg_width = 0;
+    int jpeg_height = 0;
+    int jpeg_subsampling = -1;
+    int jpeg_colorspace = -1;
+    if (0 != tjDecompressHeader3(jpegDecompressor, jpeg_data, header.imageLength,
+                                 &jpeg_width, &jpeg_height, &jpeg_subsampling, &jpeg_colorspace)) {
+        decode_failed("reading the JPEG header");
+        return;
+    }
+
+    //
+    // Decode reduced resolution images directly at their resolution. The camera info keeps the full resolution
+    // calibration and describes the reduction with binning
+
+    for (auto *scaled_publisher : scaled_publishers) {
+        const tjscalingfactor scale{1, scaled_publisher->denominator};
+
+        const uint32_t scaled_width = TJSCALED(jpeg_width, scale);
+        const uint32_t scaled_height = TJSCALED(jpeg_height, scale);
+
+        const auto scaled_image = boost::make_shared<sensor_msgs::Image>();
+
+        scaled_image->header.frame_id = frame_id_left_;
+        scaled_image->header.stamp    = t;
+        scaled_image->height          = scaled_height;
+        scaled_image->width           = scaled_width;
+        scaled_image->encoding        = sensor_msgs::image_encodings::RGB8;
+        scaled_image->is_bigendian    = (htonl(1) == 1);
+        scaled_image->step            = 3 * scaled_width;
+        scaled_image->data.resize(3 * scaled_width * scaled_height);
+
+        if (0 != tjDecompress2(jpegDecompressor, jpeg_data, header.imageLength, &(scaled_image->data[0]),
+                               scaled_width, 0/*pitch*/, scaled_height, TJPF_RGB, 0)) {
+            decode_failed("scaled JPEG decode");
+            continue;
+        }
+
+        ++jpeg_decoded_frames_;
+
+        const auto scaled_camera_info = boost::make_shared<sensor_msgs::CameraInfo>(left_camera_info);
+        scaled_camera_info->binning_x = scaled_publisher->denominator;
+        scaled_camera_info->binning_y = scaled_publisher->denominator;
+
+        scaled_publisher->publisher.publish(scaled_image, scaled_camera_info);
+    }
+
+    //
+    // Skip the rectified image while the maps for a new resolution are being built, before decoding or allocating
+    // anything for it
+
+    auto left_remap = rectify ? stereo_calibration_manager_->leftRemap() : nullptr;
+    if (left_remap && !isValidRectificationRemap(*left_remap, width, height)) {
+        left_remap.reset();
+    }
+
+    if (!publish_color && !left_remap) {
+        return;
+    }
+
+    //
+    // Decode into the published image when it has subscribers. Otherwise the decoded image is only an input to
+    // rectification, so decode into a reused buffer rather than allocating a new image every frame
+
+    boost::shared_ptr<sensor_msgs::Image> left_rgb_image;
+    uint8_t *left_rgb = nullptr;
+
+    if (publish_color) {
+        left_rgb_image = boost::make_shared<sensor_msgs::Image>();
+
+        left_rgb_image->header.frame_id = frame_id_left_;
+        left_rgb_image->height          = height;
+        left_rgb_image->width           = width;
+        left_rgb_image->encoding        = sensor_msgs::image_encodings::RGB8;
+        left_rgb_image->is_bigendian    = (htonl(1) == 1);
+        left_rgb_image->step            = 3 * width;
+        left_rgb_image->header.stamp    = t;
+
+        left_rgb_image->data.resize(rgbLength);
+        left_rgb = &(left_rgb_image->data[0]);
+    } else {
+        jpeg_rgb_buffer_.resize(rgbLength);
+        left_rgb = &(jpeg_rgb_buffer_[0]);
+    }
+
+    if (0 != tjDecompress2(jpegDecompressor,
+                           jpeg_data,
+                           header.imageLength,
+                           left_rgb,
+                           width, 0/*pitch*/, height, TJPF_RGB, 0)) {
+        decode_failed("JPEG decode");
+        return;
+    }
+
+    ++jpeg_decoded_frames_;
 
-    if (left_rgb_rect_cam_pub_.getNumSubscribers() > 0) {
+    if (publish_color) {
+        left_rgb_cam_pub_.publish(left_rgb_image);
+    }
 
-        const auto left_rectified_camera_info = stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, t);
+    if (left_remap) {
 
-        left_rgb_rect_image_.data.resize(rgbLength);
+        const auto left_rectified_camera_info = boost::make_shared<sensor_msgs::CameraInfo>(
+            stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, t));
 
-        const cv::Mat rgb_image(height, width, CV_8UC3, &(left_rgb_image_.data[0]));
-        cv::Mat rect_rgb_image(height, width, CV_8UC3, &(left_rgb_rect_image_.data[0]));
+        const auto left_rgb_rect_image = boost::make_shared<sensor_msgs::Image>();
+        left_rgb_rect_image->data.resize(rgbLength);
 
-        const auto left_remap = stereo_calibration_manager_->leftRemap();
+        const cv::Mat rgb_image(height, width, CV_8UC3, left_rgb);
+        cv::Mat rect_rgb_image(height, width, CV_8UC3, &(left_rgb_rect_image->data[0]));
 
         cv::remap(rgb_image, rect_rgb_image, left_remap->map1, left_remap->map2, cv::INTER_LINEAR);
 
-        left_rgb_rect_image_.header.frame_id = frame_id_rectified_left_;
-        left_rgb_rect_image_.header.stamp    = t;
-        left_rgb_rect_image_.height          = height;
-        left_rgb_rect_image_.width           = width;
-        left_rgb_rect_image_.encoding        = sensor_msgs::image_encodings::RGB8;
-        left_rgb_rect_image_.is_bigendian    = (htonl(1) == 1);
-        left_rgb_rect_image_.step            = 3 * width;
-        left_rgb_rect_cam_pub_.publish(left_rgb_rect_image_, left_rectified_camera_info);
+        left_rgb_rect_image->header.frame_id = frame_id_rectified_left_;
+        left_rgb_rect_image->header.stamp    = t;
+        left_rgb_rect_image->height          = height;
+        left_rgb_rect_image->width           = width;
+        left_rgb_rect_image->encoding        = sensor_msgs::image_encodings::RGB8;
+        left_rgb_rect_image->is_bigendian    = (htonl(1) == 1);
+        left_rgb_rect_image->step            = 3 * width;
+        left_rgb_rect_cam_pub_.publish(left_rgb_rect_image, left_rectified_camera_info);
         left_rgb_rect_cam_info_pub_.publish(left_rectified_camera_info);
     }
 }
@@ -945,35 +1354,28 @@ void Camera::disparityImageCallback(const image::Header& header)
     case Source_Disparity:
     case Source_Disparity_Right:
     {
-        sensor_msgs::Image         *imageP   = NULL;
+        const auto imageP                    = boost::make_shared<sensor_msgs::Image>();
         image_transport::Publisher *pubP     = NULL;
         sensor_msgs::CameraInfo camInfo;
         ros::Publisher *camInfoPubP          = NULL;
         ros::Publisher *stereoDisparityPubP  = NULL;
-        stereo_msgs::DisparityImage *stereoDisparityImageP = NULL;
 
 
         if (Source_Disparity == header.source) {
             pubP                    = &left_disparity_pub_;
-            imageP                  = &left_disparity_image_;
             imageP->header.frame_id = frame_id_rectified_left_;
             camInfo                 = stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, t);
             camInfoPubP             = &left_disp_cam_info_pub_;
             stereoDisparityPubP     = &left_stereo_disparity_pub_;
-            stereoDisparityImageP   = &left_stereo_disparity_;
-            stereoDisparityImageP->header.frame_id = frame_id_rectified_left_;
         } else {
             pubP                    = &right_disparity_pub_;
-            imageP                  = &right_disparity_image_;
             imageP->header.frame_id = frame_id_rectified_right_;
             camInfo                 = stereo_calibration_manager_->rightCameraInfo(frame_id_rectified_right_, t);
             camInfoPubP             = &right_disp_cam_info_pub_;
             stereoDisparityPubP     = &right_stereo_disparity_pub_;
-            stereoDisparityImageP   = &right_stereo_disparity_;
-            stereoDisparityImageP->header.frame_id = frame_id_rectified_right_;
         }
 
-        if (pubP->getNumSubscribers() > 0)
+        if (pubP->getNumSubscribers() > 0 && !publishBufferImage(header, imageP->header.frame_id, t))
         {
             imageP->data.resize(imageSize);
             memcpy(&imageP->data[0], header.imageDataP, imageSize);
@@ -994,82 +1396,47 @@ void Camera::disparityImageCallback(const image::Header& header)
                     break;
             }
 
-            pubP->publish(*imageP);
+            pubP->publish(imageP);
         }
 
         if (stereoDisparityPubP->getNumSubscribers() > 0)
         {
-            //
-            // If our current image resolution is using non-square pixels, i.e.
-            // fx != fy then warn the user. This support is lacking in
-            // stereo_msgs::DisparityImage and stereo_image_proc
-
-            if (camInfo.P[0] != camInfo.P[5])
+            if (16 != header.bitsPerPixel)
             {
-                std::stringstream warning;
-                warning << "Current camera configuration has non-square pixels (fx != fy).";
-                warning << "The stereo_msgs/DisparityImage does not account for";
-                warning << " this. Be careful when reprojecting to a pointcloud.";
-                ROS_WARN("%s", warning.str().c_str());
+                ROS_ERROR("Camera: unsupported disparity image bpp: %d", header.bitsPerPixel);
             }
+            else
+            {
+                std::shared_ptr<const stereo_msgs::DisparityImage> stereo_disparity_template;
+                {
+                    std::lock_guard<std::mutex> lock(stereo_disparity_template_lock_);
+                    stereo_disparity_template = stereo_disparity_template_;
+                }
 
-            //
-            // Our final floating point image will be serialized into uint8_t
-            // meaning we need to allocate 4 bytes per pixel
-
-            uint32_t floatingPointImageSize = header.width * header.height * 4;
-            stereoDisparityImageP->image.data.resize(floatingPointImageSize);
-
-            stereoDisparityImageP->header.stamp = t;
-
-            stereoDisparityImageP->image.height = header.height;
-            stereoDisparityImageP->image.width = header.width;
-            stereoDisparityImageP->image.is_bigendian = (htonl(1) == 1);
-            stereoDisparityImageP->image.header.stamp = t;
-            stereoDisparityImageP->image.header.frame_id = stereoDisparityImageP->header.frame_id;
-            stereoDisparityImageP->image.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
-            stereoDisparityImageP->image.step = 4 * header.width;
-
-
-            //
-            // Fx is the same for both the right and left cameras
-
-            stereoDisparityImageP->f = camInfo.P[0];
-
-            //
-            // Our Tx is negative. The DisparityImage message expects Tx to be
-            // positive
-
-            stereoDisparityImageP->T = fabs(stereo_calibration_manager_->T());
-            stereoDisparityImageP->min_disparity = 0;
-            stereoDisparityImageP->max_disparity = stereo_calibration_manager_->config().disparities();
-            stereoDisparityImageP->delta_d = 1./16.;
-
-            //
-            // The stereo_msgs::DisparityImage message expects the disparity
-            // image to be floating point. We will use OpenCV to perform our
-            // element-wise division
-
+                const auto stereoDisparityImageP =
+                    boost::make_shared<stereo_msgs::DisparityImage>(*stereo_disparity_template);
 
-            cv::Mat_<uint16_t> tmpImage(header.height,
-                                        header.width,
-                                        reinterpret_cast<uint16_t*>(
-                                        const_cast<void*>(header.imageDataP)));
+                stereoDisparityImageP->header.frame_id = imageP->header.frame_id;
+                stereoDisparityImageP->header.stamp = t;
 
-            //
-            // We will copy our data directly into our output message
+                stereoDisparityImageP->image.header = stereoDisparityImageP->header;
+                stereoDisparityImageP->image.height = header.height;
+                stereoDisparityImageP->image.width = header.width;
+                stereoDisparityImageP->image.step = 4 * header.width;
 
-            cv::Mat_<float> floatingPointImage(header.height,
-                                               header.width,
-                                               reinterpret_cast<float*>(&stereoDisparityImageP->image.data[0]));
+                //
+                // The stereo_msgs::DisparityImage message expects the disparity
+                // image to be floating point. Convert directly into the 4 bytes
+                // per pixel of the output message
 
-            //
-            // Convert our disparity to floating point by dividing by 16 and
-            // copy the result to the output message
+                stereoDisparityImageP->image.data.resize(header.width * header.height * sizeof(float));
 
-            floatingPointImage = tmpImage / 16.0;
+                disparityToFloat(reinterpret_cast<const uint16_t*>(header.imageDataP),
+                                 header.width * header.height,
+                                 reinterpret_cast<float*>(&stereoDisparityImageP->image.data[0]));
 
-            stereoDisparityPubP->publish(*stereoDisparityImageP);
+                stereoDisparityPubP->publish(stereoDisparityImageP);
+            }
         }
 
         camInfoPubP->publish(camInfo);
@@ -1077,25 +1444,30 @@ void Camera::disparityImageCallback(const image::Header& header)
         break;
     }
     case Source_Disparity_Cost:
+    {
+        if (!publishBufferImage(header, frame_id_rectified_left_, t)) {
+            const auto left_disparity_cost_image = boost::make_shared<sensor_msgs::Image>();
 
-        left_disparity_cost_image_.data.resize(imageSize);
-        memcpy(&left_disparity_cost_image_.data[0], header.imageDataP, imageSize);
+            left_disparity_cost_image->data.resize(imageSize);
+            memcpy(&left_disparity_cost_image->data[0], header.imageDataP, imageSize);
 
-        left_disparity_cost_image_.header.frame_id = frame_id_rectified_left_;
-        left_disparity_cost_image_.header.stamp    = t;
-        left_disparity_cost_image_.height          = header.height;
-        left_disparity_cost_image_.width           = header.width;
+            left_disparity_cost_image->header.frame_id = frame_id_rectified_left_;
+            left_disparity_cost_image->header.stamp    = t;
+            left_disparity_cost_image->height          = header.height;
+            left_disparity_cost_image->width           = header.width;
 
-        left_disparity_cost_image_.encoding        = sensor_msgs::image_encodings::MONO8;
-        left_disparity_cost_image_.is_bigendian    = (htonl(1) == 1);
-        left_disparity_cost_image_.step            = header.width;
+            left_disparity_cost_image->encoding        = sensor_msgs::image_encodings::MONO8;
+            left_disparity_cost_image->is_bigendian    = (htonl(1) == 1);
+            left_disparity_cost_image->step            = header.width;
 
-        left_disparity_cost_pub_.publish(left_disparity_cost_image_);
+            left_disparity_cost_pub_.publish(left_disparity_cost_image);
+        }
 
         left_cost_cam_info_pub_.publish(stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, t));
 
         break;
     }
+    }
 }
 
 void Camera::monoCallback(const image::Header& header)
@@ -1114,28 +1486,32 @@ void Camera::monoCallback(const image::Header& header)
     case Source_Luma_Left:
     {
 
-        left_mono_image_.data.resize(header.imageLength);
-        memcpy(&left_mono_image_.data[0], header.imageDataP, header.imageLength);
-
-        left_mono_image_.header.frame_id = frame_id_left_;
-        left_mono_image_.header.stamp    = t;
-        left_mono_image_.height          = header.height;
-        left_mono_image_.width           = header.width;
-
-        switch(header.bitsPerPixel) {
-            case 8:
-                left_mono_image_.encoding = sensor_msgs::image_encodings::MONO8;
-                left_mono_image_.step     = header.width;
-                break;
-            case 16:
-                left_mono_image_.encoding = sensor_msgs::image_encodings::MONO16;
-                left_mono_image_.step     = header.width * 2;
-                break;
-        }
+        if (!publishBufferImage(header, frame_id_left_, t)) {
+            const auto left_mono_image = boost::make_shared<sensor_msgs::Image>();
+
+            left_mono_image->data.resize(header.imageLength);
+            memcpy(&left_mono_image->data[0], header.imageDataP, header.imageLength);
+
+            left_mono_image->header.frame_id = frame_id_left_;
+            left_mono_image->header.stamp    = t;
+            left_mono_image->height          = header.height;
+            left_mono_image->width           = header.width;
 
-        left_mono_image_.is_bigendian    = (htonl(1) == 1);
+            switch(header.bitsPerPixel) {
+                case 8:
+                    left_mono_image->encoding = sensor_msgs::image_encodings::MONO8;
+                    left_mono_image->step     = header.width;
+                    break;
+                case 16:
+                    left_mono_image->encoding = sensor_msgs::image_encodings::MONO16;
+                    left_mono_image->step     = header.width * 2;
+                    break;
+            }
 
-        left_mono_cam_pub_.publish(left_mono_image_);
+            left_mono_image->is_bigendian    = (htonl(1) == 1);
+
+            left_mono_cam_pub_.publish(left_mono_image);
+        }
 
         //
         // Publish a specific camera info message for the left mono image
@@ -1145,27 +1521,31 @@ void Camera::monoCallback(const image::Header& header)
     }
     case Source_Luma_Right:
     {
-        right_mono_image_.data.resize(header.imageLength);
-        memcpy(&right_mono_image_.data[0], header.imageDataP, header.imageLength);
-
-        right_mono_image_.header.frame_id = frame_id_right_;
-        right_mono_image_.header.stamp    = t;
-        right_mono_image_.height          = header.height;
-        right_mono_image_.width           = header.width;
-
-        switch(header.bitsPerPixel) {
-            case 8:
-                right_mono_image_.encoding = sensor_msgs::image_encodings::MONO8;
-                right_mono_image_.step     = header.width;
-                break;
-            case 16:
-                right_mono_image_.encoding = sensor_msgs::image_encodings::MONO16;
-                right_mono_image_.step     = header.width * 2;
-                break;
-        }
-        right_mono_image_.is_bigendian    = (htonl(1) == 1);
+        if (!publishBufferImage(header, frame_id_right_, t)) {
+            const auto right_mono_image = boost::make_shared<sensor_msgs::Image>();
+
+            right_mono_image->data.resize(header.imageLength);
+            memcpy(&right_mono_image->data[0], header.imageDataP, header.imageLength);
+
+            right_mono_image->header.frame_id = frame_id_right_;
+            right_mono_image->header.stamp    = t;
+            right_mono_image->height          = header.height;
+            right_mono_image->width           = header.width;
+
+            switch(header.bitsPerPixel) {
+                case 8:
+                    right_mono_image->encoding = sensor_msgs::image_encodings::MONO8;
+                    right_mono_image->step     = header.width;
+                    break;
+                case 16:
+                    right_mono_image->encoding = sensor_msgs::image_encodings::MONO16;
+                    right_mono_image->step     = header.width * 2;
+                    break;
+            }
+            right_mono_image->is_bigendian    = (htonl(1) == 1);
 
-        right_mono_cam_pub_.publish(right_mono_image_);
+            right_mono_cam_pub_.publish(right_mono_image);
+        }
 
         //
         // Publish a specific camera info message for the right mono image
@@ -1175,27 +1555,31 @@ void Camera::monoCallback(const image::Header& header)
     }
     case Source_Luma_Aux:
     {
-        aux_mono_image_.data.resize(header.imageLength);
-        memcpy(&aux_mono_image_.data[0], header.imageDataP, header.imageLength);
-
-        aux_mono_image_.header.frame_id = frame_id_aux_;
-        aux_mono_image_.header.stamp    = t;
-        aux_mono_image_.height          = header.height;
-        aux_mono_image_.width           = header.width;
-
-        switch(header.bitsPerPixel) {
-            case 8:
-                aux_mono_image_.encoding = sensor_msgs::image_encodings::MONO8;
-                aux_mono_image_.step     = header.width;
-                break;
-            case 16:
-                aux_mono_image_.encoding = sensor_msgs::image_encodings::MONO16;
-                aux_mono_image_.step     = header.width * 2;
-                break;
-        }
-        aux_mono_image_.is_bigendian    = (htonl(1) == 1);
+        if (!publishBufferImage(header, frame_id_aux_, t)) {
+            const auto aux_mono_image = boost::make_shared<sensor_msgs::Image>();
+
+            aux_mono_image->data.resize(header.imageLength);
+            memcpy(&aux_mono_image->data[0], header.imageDataP, header.imageLength);
+
+            aux_mono_image->header.frame_id = frame_id_aux_;
+            aux_mono_image->header.stamp    = t;
+            aux_mono_image->height          = header.height;
+            aux_mono_image->width           = header.width;
+
+            switch(header.bitsPerPixel) {
+                case 8:
+                    aux_mono_image->encoding = sensor_msgs::image_encodings::MONO8;
+                    aux_mono_image->step     = header.width;
+                    break;
+                case 16:
+                    aux_mono_image->encoding = sensor_msgs::image_encodings::MONO16;
+                    aux_mono_image->step     = header.width * 2;
+                    break;
+            }
+            aux_mono_image->is_bigendian    = (htonl(1) == 1);
 
-        aux_mono_cam_pub_.publish(aux_mono_image_);
+            aux_mono_cam_pub_.publish(aux_mono_image);
+        }
 
         //
         // Publish a specific camera info message for the aux mono image
@@ -1222,37 +1606,42 @@ void Camera::rectCallback(const image::Header& header)
     case Source_Luma_Rectified_Left:
     {
 
-        left_rect_image_.data.resize(header.imageLength);
-        memcpy(&left_rect_image_.data[0], header.imageDataP, header.imageLength);
+        const auto left_camera_info = boost::make_shared<sensor_msgs::CameraInfo>(
+            stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, t));
 
-        left_rect_image_.header.frame_id = frame_id_rectified_left_;
-        left_rect_image_.header.stamp    = t;
-        left_rect_image_.height          = header.height;
-        left_rect_image_.width           = header.width;
+        if (!publishBufferImage(header, frame_id_rectified_left_, t)) {
+            const auto left_rect_image = boost::make_shared<sensor_msgs::Image>();
 
-        switch(header.bitsPerPixel) {
-            case 8:
-                left_rect_image_.encoding = sensor_msgs::image_encodings::MONO8;
-                left_rect_image_.step     = header.width;
+            left_rect_image->data.resize(header.imageLength);
+            memcpy(&left_rect_image->data[0], header.imageDataP, header.imageLength);
 
-                break;
-            case 16:
-                left_rect_image_.encoding = sensor_msgs::image_encodings::MONO16;
-                left_rect_image_.step     = header.width * 2;
-
-                break;
-        }
+            left_rect_image->header.frame_id = frame_id_rectified_left_;
+            left_rect_image->header.stamp    = t;
+            left_rect_image->height          = header.height;
+            left_rect_image->width           = header.width;
 
-        left_rect_image_.is_bigendian = (htonl(1) == 1);
+            switch(header.bitsPerPixel) {
+                case 8:
+                    left_rect_image->encoding = sensor_msgs::image_encodings::MONO8;
+                    left_rect_image->step     = header.width;
+
+                    break;
+                case 16:
+                    left_rect_image->encoding = sensor_msgs::image_encodings::MONO16;
+                    left_rect_image->step     = header.width * 2;
 
-        const auto left_camera_info = stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, t);
+                    break;
+            }
+
+            left_rect_image->is_bigendian = (htonl(1) == 1);
+
+            left_rect_cam_pub_.publish(left_rect_image, left_camera_info);
+        }
 
         //
         // Continue to publish the rect camera info on the
         // <namespace>/left/camera_info topic for backward compatibility with
         // older versions of the driver
-        left_rect_cam_pub_.publish(left_rect_image_, left_camera_info);
-
         left_rect_cam_info_pub_.publish(left_camera_info);
 
         break;
@@ -1260,35 +1649,40 @@ void Camera::rectCallback(const image::Header& header)
     case Source_Luma_Rectified_Right:
     {
 
-        right_rect_image_.data.resize(header.imageLength);
-        memcpy(&right_rect_image_.data[0], header.imageDataP, header.imageLength);
-
-        right_rect_image_.header.frame_id = frame_id_rectified_right_;
-        right_rect_image_.header.stamp    = t;
-        right_rect_image_.height          = header.height;
-        right_rect_image_.width           = header.width;
-
-        switch(header.bitsPerPixel) {
-            case 8:
-                right_rect_image_.encoding = sensor_msgs::image_encodings::MONO8;
-                right_rect_image_.step     = header.width;
-                break;
-            case 16:
-                right_rect_image_.encoding = sensor_msgs::image_encodings::MONO16;
-                right_rect_image_.step     = header.width * 2;
-                break;
-        }
+        const auto right_camera_info = boost::make_shared<sensor_msgs::CameraInfo>(
+            stereo_calibration_manager_->rightCameraInfo(frame_id_rectified_right_, t));
+
+        if (!publishBufferImage(header, frame_id_rectified_right_, t)) {
+            const auto right_rect_image = boost::make_shared<sensor_msgs::Image>();
+
+            right_rect_image->data.resize(header.imageLength);
+            memcpy(&right_rect_image->data[0], header.imageDataP, header.imageLength);
+
+            right_rect_image->header.frame_id = frame_id_rectified_right_;
+            right_rect_image->header.stamp    = t;
+            right_rect_image->height          = header.height;
+            right_rect_image->width           = header.width;
+
+            switch(header.bitsPerPixel) {
+                case 8:
+                    right_rect_image->encoding = sensor_msgs::image_encodings::MONO8;
+                    right_rect_image->step     = header.width;
+                    break;
+                case 16:
+                    right_rect_image->encoding = sensor_msgs::image_encodings::MONO16;
+                    right_rect_image->step     = header.width * 2;
+                    break;
+            }
 
-        right_rect_image_.is_bigendian = (htonl(1) == 1);
+            right_rect_image->is_bigendian = (htonl(1) == 1);
 
-        const auto right_camera_info = stereo_calibration_manager_->rightCameraInfo(frame_id_rectified_right_, t);
+            right_rect_cam_pub_.publish(right_rect_image, right_camera_info);
+        }
 
         //
         // Continue to publish the rect camera info on the
         // <namespace>/right/camera_info topic for backward compatibility with
         // older versions of the driver
-        right_rect_cam_pub_.publish(right_rect_image_, right_camera_info);
-
         right_rect_cam_info_pub_.publish(right_camera_info);
 
         break;
@@ -1296,35 +1690,40 @@ void Camera::rectCallback(const image::Header& header)
     case Source_Luma_Rectified_Aux:
     {
 
-        aux_rect_image_.data.resize(header.imageLength);
-        memcpy(&aux_rect_image_.data[0], header.imageDataP, header.imageLength);
-
-        aux_rect_image_.header.frame_id = frame_id_rectified_aux_;
-        aux_rect_image_.header.stamp    = t;
-        aux_rect_image_.height          = header.height;
-        aux_rect_image_.width           = header.width;
-
-        switch(header.bitsPerPixel) {
-            case 8:
-                aux_rect_image_.encoding = sensor_msgs::image_encodings::MONO8;
-                aux_rect_image_.step     = header.width;
-                break;
-            case 16:
-                aux_rect_image_.encoding = sensor_msgs::image_encodings::MONO16;
-                aux_rect_image_.step     = header.width * 2;
-                break;
-        }
+        const auto aux_camera_info = boost::make_shared<sensor_msgs::CameraInfo>(
+            stereo_calibration_manager_->auxCameraInfo(frame_id_rectified_aux_, t, header.width, header.height));
+
+        if (!publishBufferImage(header, frame_id_rectified_aux_, t)) {
+            const auto aux_rect_image = boost::make_shared<sensor_msgs::Image>();
+
+            aux_rect_image->data.resize(header.imageLength);
+            memcpy(&aux_rect_image->data[0], header.imageDataP, header.imageLength);
+
+            aux_rect_image->header.frame_id = frame_id_rectified_aux_;
+            aux_rect_image->header.stamp    = t;
+            aux_rect_image->height          = header.height;
+            aux_rect_image->width           = header.width;
+
+            switch(header.bitsPerPixel) {
+                case 8:
+                    aux_rect_image->encoding = sensor_msgs::image_encodings::MONO8;
+                    aux_rect_image->step     = header.width;
+                    break;
+                case 16:
+                    aux_rect_image->encoding = sensor_msgs::image_encodings::MONO16;
+                    aux_rect_image->step     = header.width * 2;
+                    break;
+            }
 
-        aux_rect_image_.is_bigendian = (htonl(1) == 1);
+            aux_rect_image->is_bigendian = (htonl(1) == 1);
 
-        const auto aux_camera_info = stereo_calibration_manager_->auxCameraInfo(frame_id_rectified_aux_, t, header.width, header.height);
+            aux_rect_cam_pub_.publish(aux_rect_image, aux_camera_info);
+        }
 
         //
         // Continue to publish the rect camera info on the
         // <namespace>/aux/camera_info topic for backward compatibility with
         // older versions of the driver
-        aux_rect_cam_pub_.publish(aux_rect_image_, aux_camera_info);
-
         aux_rect_cam_info_pub_.publish(aux_camera_info);
 
         break;
@@ -1350,163 +1749,104 @@ void Camera::depthCallback(const image::Header& header)
 
     const ros::Time t(header.timeSeconds, 1000 * header.timeMicroSeconds);
 
-    const float    bad_point = std::numeric_limits<float>::quiet_NaN();
-    const uint32_t depthSize = header.height * header.width * sizeof(float);
-    const uint32_t niDepthSize = header.height * header.width * sizeof(uint16_t);
-    const uint32_t imageSize = header.width * header.height;
-
-    depth_image_.header.stamp    = t;
-    depth_image_.header.frame_id = frame_id_rectified_left_;
-    depth_image_.height          = header.height;
-    depth_image_.width           = header.width;
-    depth_image_.is_bigendian    = (htonl(1) == 1);
-
-    ni_depth_image_ = depth_image_;
-
-    ni_depth_image_.encoding           = sensor_msgs::image_encodings::MONO16;
-    ni_depth_image_.step               = header.width * 2;
-
-    depth_image_.encoding        = sensor_msgs::image_encodings::TYPE_32FC1;
-    depth_image_.step            = header.width * 4;
-
-    depth_image_.data.resize(depthSize);
-    ni_depth_image_.data.resize(niDepthSize);
-
-    float *depthImageP = reinterpret_cast<float*>(&depth_image_.data[0]);
-    uint16_t *niDepthImageP = reinterpret_cast<uint16_t*>(&ni_depth_image_.data[0]);
-
-    const uint16_t min_ni_depth = std::numeric_limits<uint16_t>::lowest();
-    const uint16_t max_ni_depth = std::numeric_limits<uint16_t>::max();
-
     //
-    // Disparity is in 32-bit floating point
+    // Only allocate and compute the depth images which have subscribers
 
-    if (32 == header.bitsPerPixel) {
+    sensor_msgs::ImagePtr depth_image = nullptr;
+    sensor_msgs::ImagePtr ni_depth_image = nullptr;
 
-        //
-        // Depth = focal_length*baseline/disparity
-        // From the Q matrix used to reproject disparity images using non-isotropic
-        // pixels we see that z = (fx*fy*Tx). Normalizing z so that
-        // the scale factor on the homogeneous Cartesian coordinate is 1 results
-        // in z =  (fx*fy*Tx)/(-fy*d) or z = (fx*Tx)/(-d).
-        // The 4th element of the right camera projection matrix is defined
-        // as fx*Tx.
-
-        const double scale = stereo_calibration_manager_->rightCameraInfo(frame_id_right_, t).P[3];
-
-        const float *disparityImageP = reinterpret_cast<const float*>(header.imageDataP);
-
-        for (uint32_t i = 0 ; i < imageSize ; ++i)
-        {
-            if (0.0 >= disparityImageP[i])
-            {
-                depthImageP[i] = bad_point;
-                niDepthImageP[i] = 0;
-            }
-            else
-            {
-                depthImageP[i] = scale / disparityImageP[i];
-                niDepthImageP[i] = static_cast<uint16_t>(std::min(static_cast<float>(max_ni_depth),
-                                                                  std::max(static_cast<float>(min_ni_depth),
-                                                                           depthImageP[i] * 1000)));
-            }
-        }
+    if (0 != depthSubscribers)
+    {
+        depth_image = boost::make_shared<sensor_msgs::Image>();
 
-    //
-    // Disparity is in 1/16th pixel, unsigned integer
+        depth_image->header.stamp    = t;
+        depth_image->header.frame_id = frame_id_rectified_left_;
+        depth_image->height          = header.height;
+        depth_image->width           = header.width;
+        depth_image->is_bigendian    = (htonl(1) == 1);
+        depth_image->encoding        = sensor_msgs::image_encodings::TYPE_32FC1;
+        depth_image->step            = header.width * sizeof(float);
 
-    } else if (16 == header.bitsPerPixel) {
+        depth_image->data.resize(header.height * header.width * sizeof(float));
+    }
 
-        //
-        // Depth = focal_length*baseline/disparity
-        // From the Q matrix used to reproject disparity images using non-isotropic
-        // pixels we see that z = (fx*fy*Tx). Normalizing z so that
-        // the scale factor on the homogeneous Cartesian coordinate is 1 results
-        // in z =  (fx*fy*Tx)/(-fy*d) or z = (fx*Tx)/(-d). Because our disparity
-        // image is 16 bits we must also divide by 16 making z = (fx*Tx*16)/(-d)
-        // The 4th element of the right camera projection matrix is defined
-        // as fx*Tx.
+    if (0 != niDepthSubscribers)
+    {
+        ni_depth_image = boost::make_shared<sensor_msgs::Image>();
 
+        ni_depth_image->header.stamp    = t;
+        ni_depth_image->header.frame_id = frame_id_rectified_left_;
+        ni_depth_image->height          = header.height;
+        ni_depth_image->width           = header.width;
+        ni_depth_image->is_bigendian    = (htonl(1) == 1);
+        ni_depth_image->encoding        = sensor_msgs::image_encodings::MONO16;
+        ni_depth_image->step            = header.width * sizeof(uint16_t);
 
-        const float scale = stereo_calibration_manager_->rightCameraInfo(frame_id_right_, t).P[3] * -16.0f;
+        ni_depth_image->data.resize(header.height * header.width * sizeof(uint16_t));
+    }
 
-        const uint16_t *disparityImageP = reinterpret_cast<const uint16_t*>(header.imageDataP);
+    float *depthImageP = depth_image ? reinterpret_cast<float*>(&depth_image->data[0]) : nullptr;
+    uint16_t *niDepthImageP = ni_depth_image ? reinterpret_cast<uint16_t*>(&ni_depth_image->data[0]) : nullptr;
 
-        for (uint32_t i = 0 ; i < imageSize ; ++i)
-        {
-            if (0 == disparityImageP[i])
-            {
-                depthImageP[i] = bad_point;
-                niDepthImageP[i] = 0;
-            }
-            else
-            {
-                depthImageP[i] = scale / disparityImageP[i];
-                niDepthImageP[i] = static_cast<uint16_t>(std::min(static_cast<float>(max_ni_depth),
-                                                                  std::max(static_cast<float>(min_ni_depth),
-                                                                           depthImageP[i] * 1000)));
-            }
-        }
+    const auto ray_table = stereo_calibration_manager_->rayTable();
 
-    } else {
+    if (!disparityToDepth(header, *ray_table, depthImageP, niDepthImageP)) {
         ROS_ERROR("Camera: unsupported disparity bpp: %d", header.bitsPerPixel);
         return;
     }
 
-    if (0 != niDepthSubscribers)
+    if (ni_depth_image)
     {
-        ni_depth_cam_pub_.publish(ni_depth_image_);
+        ni_depth_cam_pub_.publish(ni_depth_image);
     }
 
-    if (0 != depthSubscribers)
+    if (depth_image)
     {
-        depth_cam_pub_.publish(depth_image_);
+        depth_cam_pub_.publish(depth_image);
     }
 
     depth_cam_info_pub_.publish(stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, t));
 }
 
-void Camera::pointCloudCallback(const image::Header& header)
+void Camera::pointCloudCallback(const AssembledFrame& assembled_frame)
 {
-    if (Source_Disparity != header.source) {
+    const image::Header* disparity = assembled_frame.image(Source_Disparity);
+    if (nullptr == disparity) {
 
-        ROS_ERROR("Camera: unexpected pointcloud image source: 0x%x", header.source);
+        ROS_ERROR("Camera: pointcloud frame is missing a disparity image");
         return;
     }
 
-    //
-    // Get the corresponding visual images so we can colorize properly
+    const image::Header& header = *disparity;
 
-    std::shared_ptr<BufferWrapper<image::Header>> left_luma_rect = nullptr;
-    std::shared_ptr<BufferWrapper<image::Header>> left_luma = nullptr;
-    std::shared_ptr<BufferWrapper<image::Header>> left_chroma = nullptr;
-    std::shared_ptr<BufferWrapper<image::Header>> aux_luma_rectified = nullptr;
-    std::shared_ptr<BufferWrapper<image::Header>> aux_chroma_rectified = nullptr;
+    if (header.bitsPerPixel != 16 && header.bitsPerPixel != 32) {
 
-    const auto left_rect_image = image_buffers_.find(Source_Luma_Rectified_Left);
-    if (left_rect_image != std::end(image_buffers_) && left_rect_image->second->data().frameId == header.frameId) {
-        left_luma_rect = left_rect_image->second;
+        ROS_ERROR("Camera: unsupported disparity detph: %d", header.bitsPerPixel);
+        return;
     }
 
-    const auto left_luma_image = image_buffers_.find(Source_Luma_Left);
-    if (left_luma_image != std::end(image_buffers_) && left_luma_image->second->data().frameId == header.frameId) {
-        left_luma = left_luma_image->second;
-    }
+    //
+    // Reproject entire rows of disparities at once using the cached ray table so the reprojection can be vectorized
 
-    const auto chroma_image = image_buffers_.find(Source_Chroma_Left);
-    if (chroma_image != std::end(image_buffers_) && chroma_image->second->data().frameId == header.frameId) {
-        left_chroma = chroma_image->second;
-    }
+    const auto ray_table = stereo_calibration_manager_->rayTable();
+    const auto aux_projection_table = stereo_calibration_manager_->auxProjectionTable();
+    if (ray_table->resolution.width != header.width || ray_table->resolution.height != header.height ||
+        aux_projection_table->resolution.width != header.width ||
+        aux_projection_table->resolution.height != header.height) {
 
-    const auto aux_luma_rectified_image = image_buffers_.find(Source_Luma_Rectified_Aux);
-    if (aux_luma_rectified_image != std::end(image_buffers_) && aux_luma_rectified_image->second->data().frameId == header.frameId) {
-        aux_luma_rectified = aux_luma_rectified_image->second;
+        ROS_WARN("Camera: disparity resolution %ux%u does not match the calibration resolution, skipping pointcloud",
+                 header.width, header.height);
+        return;
     }
 
-    const auto aux_chroma_rectified_image = image_buffers_.find(Source_Chroma_Rectified_Aux);
-    if (aux_chroma_rectified_image != std::end(image_buffers_) && aux_chroma_rectified_image->second->data().frameId == header.frameId) {
-        aux_chroma_rectified = aux_chroma_rectified_image->second;
-    }
+    //
+    // Get the corresponding visual images so we can colorize properly
+
+    const image::Header* left_luma_rect = assembled_frame.image(Source_Luma_Rectified_Left);
+    const image::Header* left_luma = assembled_frame.image(Source_Luma_Left);
+    const image::Header* left_chroma = assembled_frame.image(Source_Chroma_Left);
+    const image::Header* aux_luma_rectified = assembled_frame.image(Source_Luma_Rectified_Aux);
+    const image::Header* aux_chroma_rectified = assembled_frame.image(Source_Chroma_Rectified_Aux);
 
     const bool color_data = (has_aux_camera_ && aux_luma_rectified && aux_chroma_rectified && stereo_calibration_manager_->validAux()) ||
                             (!has_aux_camera_ && left_luma && left_chroma);
@@ -1515,8 +1855,11 @@ void Camera::pointCloudCallback(const image::Header& header)
     const bool pub_color_pointcloud = color_point_cloud_pub_.getNumSubscribers() > 0 && color_data;
     const bool pub_organized_pointcloud = luma_organized_point_cloud_pub_.getNumSubscribers() > 0 && left_luma_rect;
     const bool pub_color_organized_pointcloud = color_organized_point_cloud_pub_.getNumSubscribers() > 0 && color_data;
+    const bool pub_luma_color_organized_pointcloud = luma_color_organized_point_cloud_pub_.getNumSubscribers() > 0 &&
+                                                     left_luma_rect && color_data;
 
-    if (!(pub_pointcloud || pub_color_pointcloud || pub_organized_pointcloud || pub_color_organized_pointcloud))
+    if (!(pub_pointcloud || pub_color_pointcloud || pub_organized_pointcloud || pub_color_organized_pointcloud ||
+          pub_luma_color_organized_pointcloud))
     {
         return;
     }
@@ -1524,274 +1867,326 @@ void Camera::pointCloudCallback(const image::Header& header)
     const ros::Time t(header.timeSeconds, 1000 * header.timeMicroSeconds);
 
     //
-    // Resize our corresponding pointclouds if we plan on publishing them
+    // Allocate and resize a new message for each pointcloud we plan on publishing. Published messages are handed to
+    // intra-process subscribers without a copy, so they are never reused. The point fields of each cloud are copied
+    // from the corresponding message template
+
+    sensor_msgs::PointCloud2Ptr luma_point_cloud = nullptr;
+    sensor_msgs::PointCloud2Ptr color_point_cloud = nullptr;
+    sensor_msgs::PointCloud2Ptr luma_organized_point_cloud = nullptr;
+    sensor_msgs::PointCloud2Ptr color_organized_point_cloud = nullptr;
+    sensor_msgs::PointCloud2Ptr luma_color_organized_point_cloud = nullptr;
 
     if (pub_pointcloud)
     {
-        luma_point_cloud_.header.stamp = t;
-        luma_point_cloud_.data.resize(header.width * header.height * luma_point_cloud_.point_step);
+        luma_point_cloud = boost::make_shared<sensor_msgs::PointCloud2>(luma_point_cloud_);
+        luma_point_cloud->header.stamp = t;
+        luma_point_cloud->data.resize(header.width * header.height * luma_point_cloud->point_step);
     }
 
     if (pub_color_pointcloud)
     {
-        color_point_cloud_.header.stamp = t;
-        color_point_cloud_.data.resize(header.width * header.height * color_point_cloud_.point_step);
+        color_point_cloud = boost::make_shared<sensor_msgs::PointCloud2>(color_point_cloud_);
+        color_point_cloud->header.stamp = t;
+        color_point_cloud->data.resize(header.width * header.height * color_point_cloud->point_step);
     }
 
     if (pub_organized_pointcloud)
     {
-        luma_organized_point_cloud_.header.stamp = t;
-        luma_organized_point_cloud_.data.resize(header.width * header.height * luma_organized_point_cloud_.point_step);
-        luma_organized_point_cloud_.width = header.width;
-        luma_organized_point_cloud_.height = header.height;
-        luma_organized_point_cloud_.row_step = header.width * luma_organized_point_cloud_.point_step;
+        luma_organized_point_cloud = boost::make_shared<sensor_msgs::PointCloud2>(luma_organized_point_cloud_);
+        luma_organized_point_cloud->header.stamp = t;
+        luma_organized_point_cloud->data.resize(header.width * header.height * luma_organized_point_cloud->point_step);
+        luma_organized_point_cloud->width = header.width;
+        luma_organized_point_cloud->height = header.height;
+        luma_organized_point_cloud->row_step = header.width * luma_organized_point_cloud->point_step;
     }
 
     if (pub_color_organized_pointcloud)
     {
-        color_organized_point_cloud_.header.stamp = t;
-        color_organized_point_cloud_.data.resize(header.width * header.height * color_organized_point_cloud_.point_step);
-        color_organized_point_cloud_.width = header.width;
-        color_organized_point_cloud_.height = header.height;
-        color_organized_point_cloud_.row_step = header.width * color_organized_point_cloud_.point_step;
+        color_organized_point_cloud = boost::make_shared<sensor_msgs::PointCloud2>(color_organized_point_cloud_);
+        color_organized_point_cloud->header.stamp = t;
+        color_organized_point_cloud->data.resize(header.width * header.height * color_organized_point_cloud->point_step);
+        color_organized_point_cloud->width = header.width;
+        color_organized_point_cloud->height = header.height;
+        color_organized_point_cloud->row_step = header.width * color_organized_point_cloud->point_step;
     }
 
-    const Eigen::Vector3f invalid_point(std::numeric_limits<float>::quiet_NaN(),
-                                        std::numeric_limits<float>::quiet_NaN(),
-                                        std::numeric_limits<float>::quiet_NaN());
+    if (pub_luma_color_organized_pointcloud)
+    {
+        luma_color_organized_point_cloud = boost::make_shared<sensor_msgs::PointCloud2>(luma_color_organized_point_cloud_);
+        luma_color_organized_point_cloud->header.stamp = t;
+        luma_color_organized_point_cloud->data.resize(header.width * header.height *
+                                                      luma_color_organized_point_cloud->point_step);
+        luma_color_organized_point_cloud->width = header.width;
+        luma_color_organized_point_cloud->height = header.height;
+        luma_color_organized_point_cloud->row_step = header.width * luma_color_organized_point_cloud->point_step;
+    }
 
     //
     // Create rectified color image upfront if we are planning to publish color pointclouds
 
     cv::Mat rectified_color;
-    if (!has_aux_camera_ && (pub_color_pointcloud || pub_color_organized_pointcloud))
+    Ycbcr420ImageT left_color;
+    std::shared_ptr<RectificationRemapT> left_remap = nullptr;
+    bool sparse_color = false;
+
+    const bool any_color_pointcloud = pub_color_pointcloud || pub_color_organized_pointcloud ||
+                                      pub_luma_color_organized_pointcloud;
+
+    if (!has_aux_camera_ && any_color_pointcloud)
     {
-        const auto &luma = left_luma->data();
+        const auto &luma = *left_luma;
 
-        pointcloud_color_buffer_.resize(3 * luma.width * luma.height);
-        pointcloud_rect_color_buffer_.resize(3 * luma.width * luma.height);
-        ycbcrToBgr(luma, left_chroma->data(), &(pointcloud_color_buffer_[0]));
+        left_color = makeYcbcr420Image(luma, *left_chroma);
+        left_remap = stereo_calibration_manager_->leftRemap();
 
-        cv::Mat rgb_image(luma.height, luma.width, CV_8UC3, &(pointcloud_color_buffer_[0]));
-        cv::Mat rect_rgb_image(luma.height, luma.width, CV_8UC3, &(pointcloud_rect_color_buffer_[0]));
+        //
+        // The unorganized color pointcloud only colors valid points, so unless an organized pointcloud with color is
+        // requested rectify and convert just the pixels of those points in the pointcloud kernel
 
-        const auto left_remap = stereo_calibration_manager_->leftRemap();
+        sparse_color = !pub_color_organized_pointcloud && !pub_luma_color_organized_pointcloud && left_remap &&
+                       header.width == luma.width && header.height == luma.height &&
+                       isValidRectificationRemap(*left_remap, luma.width, luma.height);
 
-        cv::remap(rgb_image, rect_rgb_image, left_remap->map1, left_remap->map2, cv::INTER_LINEAR);
+        if (!sparse_color)
+        {
+            pointcloud_color_buffer_.resize(3 * luma.width * luma.height);
+            pointcloud_rect_color_buffer_.resize(3 * luma.width * luma.height);
 
-        rectified_color = std::move(rect_rgb_image);
+            cv::Mat rect_rgb_image(luma.height, luma.width, CV_8UC3, &(pointcloud_rect_color_buffer_[0]));
+
+            //
+            // If the rectification maps for a new resolution are still being built, or are stale, color the points
+            // black for this frame
+
+            if (left_remap && isValidRectificationRemap(*left_remap, luma.width, luma.height))
+            {
+                ycbcrToBgr(luma, *left_chroma, &(pointcloud_color_buffer_[0]), *color_executor_);
+
+                const cv::Mat rgb_image(luma.height, luma.width, CV_8UC3, &(pointcloud_color_buffer_[0]));
+
+                cv::remap(rgb_image, rect_rgb_image, left_remap->map1, left_remap->map2, cv::INTER_LINEAR);
+            }
+            else
+            {
+                std::fill(pointcloud_rect_color_buffer_.begin(), pointcloud_rect_color_buffer_.end(), 0);
+            }
+
+            rectified_color = std::move(rect_rgb_image);
+        }
     }
-    else if(has_aux_camera_ && (pub_color_pointcloud || pub_color_organized_pointcloud))
+    else if(has_aux_camera_ && any_color_pointcloud)
     {
-        const auto &luma = aux_luma_rectified->data();
+        const auto &luma = *aux_luma_rectified;
 
         pointcloud_rect_color_buffer_.resize(3 * luma.width * luma.height);
 
-        ycbcrToBgr(luma, aux_chroma_rectified->data(), reinterpret_cast<uint8_t*>(&(pointcloud_rect_color_buffer_[0])));
+        ycbcrToBgr(luma,
+                   *aux_chroma_rectified,
+                   reinterpret_cast<uint8_t*>(&(pointcloud_rect_color_buffer_[0])),
+                   *color_executor_);
 
         cv::Mat rect_rgb_image(luma.height, luma.width, CV_8UC3, &(pointcloud_rect_color_buffer_[0]));
 
         //
-        // If we are running in full-aux mode and 1/4 res mode resize the rectified aux image to match the
-        // disparity resolution
+        // In full-aux mode at reduced stereo resolutions the aux image is larger than the disparity image. The aux
+        // projection is already in full resolution aux pixels, so the image is sampled directly rather than resized
+        // to the disparity resolution. Points without a valid disparity take the nearest aux pixel
 
-        if (stereo_calibration_manager_->config().cameraProfile() == Full_Res_Aux_Cam &&
-            (header.width != luma.width || header.height != luma.height))
+        if (pointcloud_aux_pixel_map_.width != header.width || pointcloud_aux_pixel_map_.height != header.height ||
+            pointcloud_aux_pixel_map_.color_width != luma.width ||
+            pointcloud_aux_pixel_map_.color_height != luma.height)
         {
-            cv::Mat resized_rect_rgb_image;
-            cv::resize(rect_rgb_image,
-                       resized_rect_rgb_image,
-                       cv::Size{static_cast<int>(header.width), static_cast<int>(header.height)},
-                       0, 0, cv::INTER_AREA);
-
-            rect_rgb_image = std::move(resized_rect_rgb_image);
+            pointcloud_aux_pixel_map_ = makeColorPixelMap(header.width, header.height, luma.width, luma.height);
         }
 
         rectified_color = std::move(rect_rgb_image);
     }
 
-    const auto left_camera_info = stereo_calibration_manager_->leftCameraInfo(frame_id_left_, t);
-    const auto right_camera_info = stereo_calibration_manager_->rightCameraInfo(frame_id_right_, t);
-    const auto aux_camera_info = stereo_calibration_manager_->auxCameraInfo(frame_id_rectified_aux_, t,
-                                                                            rectified_color.cols, rectified_color.rows);
-
     //
-    // Iterate through our disparity image once populating our pointcloud structures if we plan to publish them
-
-    uint32_t packed_color = 0;
+    // Border clipping is applied as a range of valid columns per row, which only needs to be recomputed when the
+    // clip settings or resolution change
 
-    const float squared_max_range = pointcloud_max_range_ * pointcloud_max_range_;
-
-    size_t valid_points = 0;
-    for (size_t y = 0 ; y < header.height ; ++y)
+    if (pointcloud_border_clip_.type != border_clip_type_ || pointcloud_border_clip_.value != border_clip_value_ ||
+        pointcloud_border_clip_.width != header.width || pointcloud_border_clip_.height != header.height)
     {
-        for (size_t x = 0 ; x < header.width ; ++x)
-        {
-            const size_t index = y * header.width + x;
-
-            float disparity = 0.0f;
-            switch(header.bitsPerPixel)
-            {
-                case 16:
-                {
-                    disparity = static_cast<float>(reinterpret_cast<const uint16_t*>(header.imageDataP)[index]) / 16.0f;
-                    break;
-                }
-                case 32:
-                {
-                    disparity = static_cast<float>(reinterpret_cast<const float*>(header.imageDataP)[index]);
-                    break;
-                }
-                default:
-                {
-                    ROS_ERROR("Camera: unsupported disparity detph: %d", header.bitsPerPixel);
-                    return;
-                }
-            }
-
-            const Eigen::Vector3f point = stereo_calibration_manager_->reproject(x, y, disparity,
-                                                                                 left_camera_info, right_camera_info);
+        pointcloud_border_clip_ = makeBorderClipMask(border_clip_type_, border_clip_value_, header.width, header.height);
+    }
 
-            //
-            // We have a valid rectified color image meaning we plan to publish color pointcloud topics. Assemble the
-            // color pixel here since it may be needed in our organized pointclouds
+    //
+    // Select the kernel specialized for the pointclouds we plan to publish
 
-            if (!rectified_color.empty())
-            {
-                packed_color = 0;
+    const uint32_t outputs = (pub_pointcloud ? LUMA_POINTCLOUD : 0) |
+                             (pub_color_pointcloud ? COLOR_POINTCLOUD : 0) |
+                             (pub_organized_pointcloud ? LUMA_ORGANIZED_POINTCLOUD : 0) |
+                             (pub_color_organized_pointcloud ? COLOR_ORGANIZED_POINTCLOUD : 0) |
+                             (pub_luma_color_organized_pointcloud ? LUMA_COLOR_ORGANIZED_POINTCLOUD : 0) |
+                             (has_aux_camera_ ? AUX_COLOR : 0) |
+                             (sparse_color ? SPARSE_COLOR : 0);
 
-                const auto color_pixel = (has_aux_camera_ && disparity != 0.0) ?
-                    interpolate_color(stereo_calibration_manager_->rectifiedAuxProject(point, aux_camera_info),
-                                      rectified_color) :
-                    rectified_color.at<cv::Vec3b>(y, x);
+    const uint32_t luma_bits = left_luma_rect ? left_luma_rect->bitsPerPixel : 8;
 
+    const auto kernel = selectStereoPointCloudKernel(outputs, header.bitsPerPixel, luma_bits);
+    if (nullptr == kernel)
+    {
+        ROS_ERROR("Camera: unsupported pointcloud configuration: outputs 0x%x, luma depth %d", outputs, luma_bits);
+        return;
+    }
 
-                packed_color |= color_pixel[2] << 16 | color_pixel[1] << 8 | color_pixel[0];
-            }
+    StereoPointCloudFrameT frame;
+    frame.disparity = &header;
+    frame.luma = left_luma_rect;
+    frame.rectified_color = &rectified_color;
+    frame.color = &left_color;
+    frame.color_remap = left_remap.get();
+    frame.ray_table = ray_table.get();
+    frame.border_clip = &pointcloud_border_clip_;
+    frame.aux_projection = aux_projection_table.get();
+    frame.aux_pixel_map = &pointcloud_aux_pixel_map_;
+    frame.squared_max_range = pointcloud_max_range_ * pointcloud_max_range_;
+    frame.float_intensity = pointcloud_float_intensity_;
+    frame.luma_point_cloud = luma_point_cloud.get();
+    frame.color_point_cloud = color_point_cloud.get();
+    frame.luma_organized_point_cloud = luma_organized_point_cloud.get();
+    frame.color_organized_point_cloud = color_organized_point_cloud.get();
+    frame.luma_color_organized_point_cloud = luma_color_organized_point_cloud.get();
 
-            //
-            // If our disparity is 0 pixels our corresponding 3D point is infinite. If we plan to publish organized
-            // pointclouds we will need to add a invalid point to our pointcloud(s)
+    //
+    // Iterate through our disparity image once populating our pointcloud structures if we plan to publish them. The
+    // image is split into bands of rows which are processed concurrently
 
-            if (disparity == 0.0 || clipPoint(border_clip_type_, border_clip_value_, header.width, header.height, x, y))
-            {
-                if (pub_organized_pointcloud)
-                {
-                    writePoint(luma_organized_point_cloud_, index, invalid_point, index, left_luma_rect->data());
-                }
+    const size_t bands = pointcloud_executor_->bands();
 
-                if (pub_color_organized_pointcloud)
-                {
-                    writePoint(color_organized_point_cloud_, index, invalid_point, packed_color);
-                }
+    pointcloud_row_buffer_.resize(4 * header.width * bands);
+    pointcloud_band_points_.assign(bands, std::make_pair(0, 0));
 
-                continue;
-            }
+    pointcloud_executor_->run(header.height, [&](size_t band, size_t begin_row, size_t end_row)
+    {
+        //
+        // Each band writes its unorganized points starting at the index of its first pixel. The preceding bands
+        // can never produce more points than that, so the bands never overlap before they are compacted
 
-            const bool valid = isValidReprojectedPoint(point, squared_max_range);
+        const size_t band_offset = begin_row * header.width;
 
-            if (pub_pointcloud && valid)
-            {
-                writePoint(luma_point_cloud_, valid_points, point, index, left_luma_rect->data());
-            }
+        const size_t valid_points = kernel(frame, begin_row, end_row, band_offset,
+                                           &(pointcloud_row_buffer_[4 * header.width * band]));
 
-            if(pub_color_pointcloud && valid)
-            {
-                writePoint(color_point_cloud_, valid_points, point, packed_color);
-            }
+        pointcloud_band_points_[band] = std::make_pair(band_offset, valid_points);
+    });
 
-            if (pub_organized_pointcloud)
-            {
-                writePoint(luma_organized_point_cloud_, index, valid ? point : invalid_point, index, left_luma_rect->data());
-            }
+    //
+    // Compact the unorganized points of each band into one contiguous block. The bands are processed in order so the
+    // points are ordered exactly as if the image was processed serially
 
-            if (pub_color_organized_pointcloud)
+    size_t valid_points = 0;
+    for (const auto &band_points : pointcloud_band_points_)
+    {
+        if (band_points.first != valid_points && band_points.second > 0)
+        {
+            if (pub_pointcloud)
             {
-                writePoint(color_organized_point_cloud_, index, valid ? point : invalid_point, packed_color);
+                std::memmove(&(luma_point_cloud->data[valid_points * luma_point_cloud->point_step]),
+                             &(luma_point_cloud->data[band_points.first * luma_point_cloud->point_step]),
+                             band_points.second * luma_point_cloud->point_step);
             }
 
-            if (valid)
+            if (pub_color_pointcloud)
             {
-                ++valid_points;
+                std::memmove(&(color_point_cloud->data[valid_points * color_point_cloud->point_step]),
+                             &(color_point_cloud->data[band_points.first * color_point_cloud->point_step]),
+                             band_points.second * color_point_cloud->point_step);
             }
         }
+
+        valid_points += band_points.second;
     }
 
     if (pub_pointcloud)
     {
-        luma_point_cloud_.height = 1;
-        luma_point_cloud_.row_step = valid_points * luma_point_cloud_.point_step;
-        luma_point_cloud_.width = valid_points;
-        luma_point_cloud_.data.resize(valid_points * luma_point_cloud_.point_step);
-        luma_point_cloud_pub_.publish(luma_point_cloud_);
+        luma_point_cloud->height = 1;
+        luma_point_cloud->row_step = valid_points * luma_point_cloud->point_step;
+        luma_point_cloud->width = valid_points;
+        luma_point_cloud->data.resize(valid_points * luma_point_cloud->point_step);
+        luma_point_cloud_pub_.publish(luma_point_cloud);
     }
 
     if(pub_color_pointcloud)
     {
-        color_point_cloud_.height = 1;
-        color_point_cloud_.row_step = valid_points * color_point_cloud_.point_step;
-        color_point_cloud_.width = valid_points;
-        color_point_cloud_.data.resize(valid_points * color_point_cloud_.point_step);
-        color_point_cloud_pub_.publish(color_point_cloud_);
+        color_point_cloud->height = 1;
+        color_point_cloud->row_step = valid_points * color_point_cloud->point_step;
+        color_point_cloud->width = valid_points;
+        color_point_cloud->data.resize(valid_points * color_point_cloud->point_step);
+        color_point_cloud_pub_.publish(color_point_cloud);
     }
 
     if (pub_organized_pointcloud)
     {
-        luma_organized_point_cloud_pub_.publish(luma_organized_point_cloud_);
+        luma_organized_point_cloud_pub_.publish(luma_organized_point_cloud);
     }
 
     if (pub_color_organized_pointcloud)
     {
-        color_organized_point_cloud_pub_.publish(color_organized_point_cloud_);
+        color_organized_point_cloud_pub_.publish(color_organized_point_cloud);
+    }
+
+    if (pub_luma_color_organized_pointcloud)
+    {
+        luma_color_organized_point_cloud_pub_.publish(luma_color_organized_point_cloud);
     }
 
 }
 
-void Camera::rawCamDataCallback(const image::Header& header)
+void Camera::rawCamDataCallback(const AssembledFrame& frame)
 {
     if (0 == raw_cam_data_pub_.getNumSubscribers()) {
         return;
     }
 
-    if(Source_Disparity == header.source)
-    {
-        const auto image = image_buffers_.find(Source_Luma_Rectified_Left);
-        if (image != std::end(image_buffers_) && image->second->data().frameId == header.frameId)
-        {
-            const auto luma_ptr = image->second;
-            const auto &left_luma_rect = luma_ptr->data();
+    const image::Header* disparity = frame.image(Source_Disparity);
+    const image::Header* left_luma_rect_image = frame.image(Source_Luma_Rectified_Left);
+
+    if (nullptr == disparity || nullptr == left_luma_rect_image) {
+        return;
+    }
 
-            const uint32_t left_luma_image_size = left_luma_rect.width * left_luma_rect.height;
+    const auto &header = *disparity;
+    const auto &left_luma_rect = *left_luma_rect_image;
 
-            raw_cam_data_.gray_scale_image.resize(left_luma_image_size);
-            memcpy(&(raw_cam_data_.gray_scale_image[0]),
-                   left_luma_rect.imageDataP,
-                   left_luma_image_size * sizeof(uint8_t));
+    const uint32_t left_luma_image_size = left_luma_rect.width * left_luma_rect.height;
 
-            raw_cam_data_.frames_per_second = left_luma_rect.framesPerSecond;
-            raw_cam_data_.gain              = left_luma_rect.gain;
-            raw_cam_data_.exposure_time     = left_luma_rect.exposure;
-            raw_cam_data_.frame_count       = left_luma_rect.frameId;
-            raw_cam_data_.time_stamp        = ros::Time(left_luma_rect.timeSeconds, 1000 * left_luma_rect.timeMicroSeconds);
-            raw_cam_data_.width             = left_luma_rect.width;
-            raw_cam_data_.height            = left_luma_rect.height;
+    const auto raw_cam_data = boost::make_shared<multisense_ros::RawCamData>();
 
-            const uint32_t disparity_size = header.width * header.height;
+    raw_cam_data->gray_scale_image.resize(left_luma_image_size);
+    memcpy(&(raw_cam_data->gray_scale_image[0]),
+           left_luma_rect.imageDataP,
+           left_luma_image_size * sizeof(uint8_t));
 
-            raw_cam_data_.disparity_image.resize(disparity_size);
-            memcpy(&(raw_cam_data_.disparity_image[0]),
-                   header.imageDataP,
-                   disparity_size * header.bitsPerPixel == 16 ? sizeof(uint16_t) : sizeof(uint32_t));
+    raw_cam_data->frames_per_second = left_luma_rect.framesPerSecond;
+    raw_cam_data->gain              = left_luma_rect.gain;
+    raw_cam_data->exposure_time     = left_luma_rect.exposure;
+    raw_cam_data->frame_count       = left_luma_rect.frameId;
+    raw_cam_data->time_stamp        = ros::Time(left_luma_rect.timeSeconds, 1000 * left_luma_rect.timeMicroSeconds);
+    raw_cam_data->width             = left_luma_rect.width;
+    raw_cam_data->height            = left_luma_rect.height;
 
-            raw_cam_data_pub_.publish(raw_cam_data_);
-        }
-    }
+    //
+    // disparity_image is a uint16 array, so 32 bit disparity images take two elements per pixel
+
+    const uint32_t disparity_size = header.width * header.height;
+    const size_t disparity_bytes = disparity_size * (header.bitsPerPixel == 16 ? sizeof(uint16_t) : sizeof(uint32_t));
+
+    raw_cam_data->disparity_image.resize(disparity_bytes / sizeof(uint16_t));
+    memcpy(&(raw_cam_data->disparity_image[0]),
+           header.imageDataP,
+           disparity_bytes);
+
+    raw_cam_data_pub_.publish(raw_cam_data);
 }
 
-void Camera::colorImageCallback(const image::Header& header)
+void Camera::colorImageCallback(const image::Header& luma, const image::Header& header)
 {
     //
-    // The left-luma image is currently published before the matching chroma image so this can just trigger on that
+    // Called by the frame assembler with the luma and chroma images of the same frame
 
     if (Source_Chroma_Left != header.source &&
         Source_Chroma_Rectified_Aux != header.source &&
@@ -1811,180 +2206,205 @@ void Camera::colorImageCallback(const image::Header& header)
         const auto color_subscribers = left_rgb_cam_pub_.getNumSubscribers();
         const auto color_rect_subscribers = left_rgb_rect_cam_pub_.getNumSubscribers();
 
-        if (color_subscribers == 0 && color_rect_subscribers == 0)
-        {
-            return;
+        if (left_nv12_cam_pub_.getNumSubscribers() > 0) {
+            left_nv12_cam_pub_.publish(makeNv12Image(luma, header, frame_id_left_, t));
+
+            if (color_subscribers == 0) {
+                left_rgb_cam_info_pub_.publish(stereo_calibration_manager_->leftCameraInfo(frame_id_left_, t));
+            }
         }
 
-        const auto left_luma = image_buffers_.find(Source_Luma_Left);
-        if (left_luma == std::end(image_buffers_)) {
+        if (color_subscribers == 0 && color_rect_subscribers == 0)
+        {
             return;
         }
 
-        const auto luma_ptr = left_luma->second;
+        const uint32_t height    = luma.height;
+        const uint32_t width     = luma.width;
+        const uint32_t imageSize = 3 * height * width;
 
-        if (header.frameId == luma_ptr->data().frameId) {
+        //
+        // Convert YCbCr 4:2:0 to RGB once for both images. Without unrectified subscribers the conversion goes to a
+        // scratch buffer which is only used for rectification
 
-            const uint32_t height    = luma_ptr->data().height;
-            const uint32_t width     = luma_ptr->data().width;
-            const uint32_t imageSize = 3 * height * width;
+        uint8_t *left_rgb = nullptr;
 
-            left_rgb_image_.data.resize(imageSize);
+        if (color_subscribers != 0) {
+            const auto left_rgb_image = boost::make_shared<sensor_msgs::Image>();
+            left_rgb_image->data.resize(imageSize);
 
-            left_rgb_image_.header.frame_id = frame_id_left_;
-            left_rgb_image_.header.stamp    = t;
-            left_rgb_image_.height          = height;
-            left_rgb_image_.width           = width;
+            left_rgb_image->header.frame_id = frame_id_left_;
+            left_rgb_image->header.stamp    = t;
+            left_rgb_image->height          = height;
+            left_rgb_image->width           = width;
 
-            left_rgb_image_.encoding        = sensor_msgs::image_encodings::BGR8;
-            left_rgb_image_.is_bigendian    = (htonl(1) == 1);
-            left_rgb_image_.step            = 3 * width;
+            left_rgb_image->encoding        = sensor_msgs::image_encodings::BGR8;
+            left_rgb_image->is_bigendian    = (htonl(1) == 1);
+            left_rgb_image->step            = 3 * width;
 
-            //
-            // Convert YCbCr 4:2:0 to RGB
+            left_rgb = reinterpret_cast<uint8_t*>(&(left_rgb_image->data[0]));
 
-            ycbcrToBgr(luma_ptr->data(), header, reinterpret_cast<uint8_t*>(&(left_rgb_image_.data[0])));
+            ycbcrToBgr(luma, header, left_rgb, *color_executor_);
 
             const auto left_camera_info = stereo_calibration_manager_->leftCameraInfo(frame_id_left_, t);
 
-            if (color_subscribers != 0) {
-                left_rgb_cam_pub_.publish(left_rgb_image_);
+            left_rgb_cam_pub_.publish(left_rgb_image);
 
-                left_rgb_cam_info_pub_.publish(left_camera_info);
-            }
+            left_rgb_cam_info_pub_.publish(left_camera_info);
+        } else {
+            left_color_buffer_.resize(imageSize);
+            left_rgb = &(left_color_buffer_[0]);
 
-            if (color_rect_subscribers > 0) {
-                left_rgb_rect_image_.data.resize(imageSize);
+            ycbcrToBgr(luma, header, left_rgb, *color_executor_);
+        }
 
-                const auto left_rectified_camera_info = stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, t);
+        if (color_rect_subscribers > 0) {
+            //
+            // Skip the rectified image while the maps for a new resolution are being built
 
-                const auto remaps = stereo_calibration_manager_->leftRemap();
+            const auto remaps = stereo_calibration_manager_->leftRemap();
+            if (!remaps || !isValidRectificationRemap(*remaps, width, height)) {
+                return;
+            }
 
-                const cv::Mat rgb_image(height, width, CV_8UC3, &(left_rgb_image_.data[0]));
-                cv::Mat rect_rgb_image(height, width, CV_8UC3, &(left_rgb_rect_image_.data[0]));
+            const auto left_rgb_rect_image = boost::make_shared<sensor_msgs::Image>();
+            left_rgb_rect_image->data.resize(imageSize);
 
-                cv::remap(rgb_image, rect_rgb_image, remaps->map1, remaps->map2, cv::INTER_LINEAR);
+            const auto left_rectified_camera_info = boost::make_shared<sensor_msgs::CameraInfo>(
+                stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, t));
 
-                left_rgb_rect_image_.header.frame_id = frame_id_rectified_left_;
-                left_rgb_rect_image_.header.stamp    = t;
-                left_rgb_rect_image_.height          = height;
-                left_rgb_rect_image_.width           = width;
+            const cv::Mat rgb_image(height, width, CV_8UC3, left_rgb);
+            cv::Mat rect_rgb_image(height, width, CV_8UC3, &(left_rgb_rect_image->data[0]));
 
-                left_rgb_rect_image_.encoding        = sensor_msgs::image_encodings::BGR8;
-                left_rgb_rect_image_.is_bigendian    = (htonl(1) == 1);
-                left_rgb_rect_image_.step            = 3 * width;
+            cv::remap(rgb_image, rect_rgb_image, remaps->map1, remaps->map2, cv::INTER_LINEAR);
 
-                left_rgb_rect_cam_pub_.publish(left_rgb_rect_image_, left_rectified_camera_info);
+            left_rgb_rect_image->header.frame_id = frame_id_rectified_left_;
+            left_rgb_rect_image->header.stamp    = t;
+            left_rgb_rect_image->height          = height;
+            left_rgb_rect_image->width           = width;
 
-                left_rgb_rect_cam_info_pub_.publish(left_rectified_camera_info);
-            }
+            left_rgb_rect_image->encoding        = sensor_msgs::image_encodings::BGR8;
+            left_rgb_rect_image->is_bigendian    = (htonl(1) == 1);
+            left_rgb_rect_image->step            = 3 * width;
+
+            left_rgb_rect_cam_pub_.publish(left_rgb_rect_image, left_rectified_camera_info);
+
+            left_rgb_rect_cam_info_pub_.publish(left_rectified_camera_info);
         }
 
         break;
     }
     case Source_Chroma_Rectified_Aux:
     {
-        if (aux_rgb_rect_cam_pub_.getNumSubscribers() == 0) {
-            return;
+        const auto color_rect_subscribers = aux_rgb_rect_cam_pub_.getNumSubscribers();
+
+        if (aux_nv12_rect_cam_pub_.getNumSubscribers() > 0) {
+            aux_nv12_rect_cam_pub_.publish(makeNv12Image(luma, header, frame_id_rectified_aux_, t));
+
+            if (color_rect_subscribers == 0) {
+                aux_rgb_rect_cam_info_pub_.publish(
+                    stereo_calibration_manager_->auxCameraInfo(frame_id_rectified_aux_, t, luma.width, luma.height));
+            }
         }
 
-        const auto aux_luma = image_buffers_.find(Source_Luma_Rectified_Aux);
-        if (aux_luma == std::end(image_buffers_)) {
+        if (color_rect_subscribers == 0) {
             return;
         }
 
-        const auto luma_ptr = aux_luma->second;
-
-        if (header.frameId == luma_ptr->data().frameId) {
-
-            const uint32_t height    = luma_ptr->data().height;
-            const uint32_t width     = luma_ptr->data().width;
-            const uint32_t imageSize = 3 * height * width;
+        const uint32_t height    = luma.height;
+        const uint32_t width     = luma.width;
+        const uint32_t imageSize = 3 * height * width;
 
-            aux_rgb_rect_image_.data.resize(imageSize);
+        const auto aux_rgb_rect_image = boost::make_shared<sensor_msgs::Image>();
+        aux_rgb_rect_image->data.resize(imageSize);
 
-            aux_rgb_rect_image_.header.frame_id = frame_id_rectified_aux_;
-            aux_rgb_rect_image_.header.stamp    = t;
-            aux_rgb_rect_image_.height          = height;
-            aux_rgb_rect_image_.width           = width;
+        aux_rgb_rect_image->header.frame_id = frame_id_rectified_aux_;
+        aux_rgb_rect_image->header.stamp    = t;
+        aux_rgb_rect_image->height          = height;
+        aux_rgb_rect_image->width           = width;
 
-            aux_rgb_rect_image_.encoding        = sensor_msgs::image_encodings::BGR8;
-            aux_rgb_rect_image_.is_bigendian    = (htonl(1) == 1);
-            aux_rgb_rect_image_.step            = 3 * width;
+        aux_rgb_rect_image->encoding        = sensor_msgs::image_encodings::BGR8;
+        aux_rgb_rect_image->is_bigendian    = (htonl(1) == 1);
+        aux_rgb_rect_image->step            = 3 * width;
 
-            //
-            // Convert YCbCr 4:2:0 to RGB
+        //
+        // Convert YCbCr 4:2:0 to RGB
 
-            ycbcrToBgr(luma_ptr->data(), header, reinterpret_cast<uint8_t*>(&(aux_rgb_rect_image_.data[0])));
+        ycbcrToBgr(luma, header, reinterpret_cast<uint8_t*>(&(aux_rgb_rect_image->data[0])), *color_executor_);
 
-            const auto aux_camera_info = stereo_calibration_manager_->auxCameraInfo(frame_id_rectified_aux_, t, width, height);
+        const auto aux_camera_info = boost::make_shared<sensor_msgs::CameraInfo>(
+            stereo_calibration_manager_->auxCameraInfo(frame_id_rectified_aux_, t, width, height));
 
-            aux_rgb_rect_cam_pub_.publish(aux_rgb_rect_image_, aux_camera_info);
+        aux_rgb_rect_cam_pub_.publish(aux_rgb_rect_image, aux_camera_info);
 
-            aux_rgb_rect_cam_info_pub_.publish(aux_camera_info);
-        }
+        aux_rgb_rect_cam_info_pub_.publish(aux_camera_info);
 
         break;
     }
     case Source_Chroma_Aux:
     {
-        if (aux_rgb_cam_pub_.getNumSubscribers() == 0) {
-            return;
+        const auto color_subscribers = aux_rgb_cam_pub_.getNumSubscribers();
+
+        if (aux_nv12_cam_pub_.getNumSubscribers() > 0) {
+            aux_nv12_cam_pub_.publish(makeNv12Image(luma, header, frame_id_aux_, t));
+
+            if (color_subscribers == 0) {
+                aux_rgb_cam_info_pub_.publish(
+                    stereo_calibration_manager_->auxCameraInfo(frame_id_aux_, t, luma.width, luma.height));
+            }
         }
 
-        const auto aux_luma = image_buffers_.find(Source_Luma_Aux);
-        if (aux_luma == std::end(image_buffers_)) {
+        if (color_subscribers == 0) {
             return;
         }
 
-        const auto luma_ptr = aux_luma->second;
-
-        if (header.frameId == luma_ptr->data().frameId) {
-            const uint32_t height    = luma_ptr->data().height;
-            const uint32_t width     = luma_ptr->data().width;
-            const uint32_t imageSize = 3 * height * width;
+        const uint32_t height    = luma.height;
+        const uint32_t width     = luma.width;
+        const uint32_t imageSize = 3 * height * width;
 
-            aux_rgb_image_.data.resize(imageSize);
+        const auto aux_rgb_image = boost::make_shared<sensor_msgs::Image>();
+        aux_rgb_image->data.resize(imageSize);
 
-            aux_rgb_image_.header.frame_id = frame_id_aux_;
-            aux_rgb_image_.header.stamp    = t;
-            aux_rgb_image_.height          = height;
-            aux_rgb_image_.width           = width;
+        aux_rgb_image->header.frame_id = frame_id_aux_;
+        aux_rgb_image->header.stamp    = t;
+        aux_rgb_image->height          = height;
+        aux_rgb_image->width           = width;
 
-            aux_rgb_image_.encoding        = sensor_msgs::image_encodings::BGR8;
-            aux_rgb_image_.is_bigendian    = (htonl(1) == 1);
-            aux_rgb_image_.step            = 3 * width;
+        aux_rgb_image->encoding        = sensor_msgs::image_encodings::BGR8;
+        aux_rgb_image->is_bigendian    = (htonl(1) == 1);
+        aux_rgb_image->step            = 3 * width;
 
-            //
-            // Convert YCbCr 4:2:0 to RGB
+        //
+        // Convert YCbCr 4:2:0 to RGB
 
-            ycbcrToBgr(luma_ptr->data(), header, reinterpret_cast<uint8_t*>(&(aux_rgb_image_.data[0])));
+        ycbcrToBgr(luma, header, reinterpret_cast<uint8_t*>(&(aux_rgb_image->data[0])), *color_executor_);
 
-            const auto aux_camera_info = stereo_calibration_manager_->auxCameraInfo(frame_id_aux_, t, width, height);
+        const auto aux_camera_info = stereo_calibration_manager_->auxCameraInfo(frame_id_aux_, t, width, height);
 
-            aux_rgb_cam_pub_.publish(aux_rgb_image_);
+        aux_rgb_cam_pub_.publish(aux_rgb_image);
 
-            aux_rgb_cam_info_pub_.publish(aux_camera_info);
+        aux_rgb_cam_info_pub_.publish(aux_camera_info);
 
-            break;
-        }
+        break;
     }
     }
 }
 
-void Camera::colorizeCallback(const image::Header& header)
+void Camera::assembleCallback(const image::Header& header)
 {
     if (Source_Luma_Rectified_Aux != header.source &&
         Source_Chroma_Rectified_Aux != header.source &&
         Source_Luma_Aux != header.source &&
+        Source_Chroma_Aux != header.source &&
         Source_Luma_Left != header.source &&
         Source_Chroma_Left != header.source &&
-        Source_Luma_Rectified_Left != header.source) {
-        ROS_WARN("Camera: unexpected colorized image source: 0x%x", header.source);
+        Source_Luma_Rectified_Left != header.source &&
+        Source_Disparity != header.source) {
+        ROS_WARN("Camera: unexpected assembled image source: 0x%x", header.source);
         return;
     }
 
-    image_buffers_[header.source] = std::make_shared<BufferWrapper<crl::multisense::image::Header>>(driver_, header);
+    frame_assembler_->insert(header);
 }
 
 void Camera::groundSurfaceCallback(const image::Header& header)
@@ -2010,37 +2430,38 @@ void Camera::groundSurfaceCallback(const image::Header& header)
         const uint32_t width     = header.width;
         const uint32_t imageSize = 3 * height * width;
 
-        ground_surface_image_.data.resize(imageSize);
+        const auto ground_surface_image = boost::make_shared<sensor_msgs::Image>();
+        ground_surface_image->data.resize(imageSize);
 
-        ground_surface_image_.header.frame_id = frame_id_rectified_left_;
-        ground_surface_image_.header.stamp    = t;
-        ground_surface_image_.height          = height;
-        ground_surface_image_.width           = width;
+        ground_surface_image->header.frame_id = frame_id_rectified_left_;
+        ground_surface_image->header.stamp    = t;
+        ground_surface_image->height          = height;
+        ground_surface_image->width           = width;
 
-        ground_surface_image_.encoding        = sensor_msgs::image_encodings::RGB8;
-        ground_surface_image_.is_bigendian    = (htonl(1) == 1);
-        ground_surface_image_.step            = 3* width;
+        ground_surface_image->encoding        = sensor_msgs::image_encodings::RGB8;
+        ground_surface_image->is_bigendian    = (htonl(1) == 1);
+        ground_surface_image->step            = 3* width;
 
         // Get pointer to output image
-        uint8_t* output = reinterpret_cast<uint8_t*>(&(ground_surface_image_.data[0]));
+        uint8_t* output = reinterpret_cast<uint8_t*>(&(ground_surface_image->data[0]));
 
         // Colorize image with classes
-        const size_t rgb_stride = ground_surface_image_.width * 3;
+        const size_t rgb_stride = ground_surface_image->width * 3;
 
-        for(uint32_t y = 0; y < ground_surface_image_.height; ++y)
+        for(uint32_t y = 0; y < ground_surface_image->height; ++y)
         {
             const size_t row_offset = y * rgb_stride;
 
-            for(uint32_t x = 0; x < ground_surface_image_.width; ++x)
+            for(uint32_t x = 0; x < ground_surface_image->width; ++x)
             {
                 const uint8_t *imageP = reinterpret_cast<const uint8_t*>(header.imageDataP);
 
-                const size_t image_offset = (y * ground_surface_image_.width) + x;
+                const size_t image_offset = (y * ground_surface_image->width) + x;
                 memcpy(output + row_offset + (3 * x), ground_surface_utilities::groundSurfaceClassToPixelColor(imageP[image_offset]).data(), 3);
             }
         }
 
-        ground_surface_cam_pub_.publish(ground_surface_image_);
+        ground_surface_cam_pub_.publish(ground_surface_image);
 
         // Publish info
         const auto ground_surface_info = stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, t);
@@ -2089,13 +2510,61 @@ void Camera::groundSurfaceSplineCallback(const ground_surface::Header& header)
         config.tx());
 
     // Send pointcloud message
-    ground_surface_spline_pub_.publish(ground_surface_utilities::eigenToPointcloud(eigen_pcl, frame_id_origin_));
+    ground_surface_spline_pub_.publish(boost::make_shared<sensor_msgs::PointCloud2>(
+        ground_surface_utilities::eigenToPointcloud(eigen_pcl, frame_id_origin_, ground_surface_spline_layout_)));
 }
 
 void Camera::updateConfig(const image::Config& config)
 {
     stereo_calibration_manager_->updateConfig(config);
 
+    //
+    // Frames pending under the previous config are never completed, and the sensor may restart its frame ids
+
+    frame_assembler_->reset();
+
+    //
+    // Rebuild the calibration dependent fields of the disparity images once per config rather than per image
+
+    const auto camera_info = stereo_calibration_manager_->leftCameraInfo(frame_id_rectified_left_, ros::Time());
+
+    auto stereo_disparity_template = std::make_shared<stereo_msgs::DisparityImage>();
+
+    stereo_disparity_template->image.is_bigendian = (htonl(1) == 1);
+    stereo_disparity_template->image.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+
+    //
+    // Fx is the same for both the right and left cameras
+
+    stereo_disparity_template->f = camera_info.P[0];
+
+    //
+    // Our Tx is negative. The DisparityImage message expects Tx to be
+    // positive
+
+    stereo_disparity_template->T = fabs(stereo_calibration_manager_->T());
+    stereo_disparity_template->min_disparity = 0;
+    stereo_disparity_template->max_disparity = config.disparities();
+    stereo_disparity_template->delta_d = 1./16.;
+
+    {
+        std::lock_guard<std::mutex> lock(stereo_disparity_template_lock_);
+
+        //
+        // If our current image resolution is using non-square pixels, i.e.
+        // fx != fy then warn the user once for each new calibration. This
+        // support is lacking in stereo_msgs::DisparityImage and stereo_image_proc
+
+        if (camera_info.P[0] != camera_info.P[5] &&
+            (!stereo_disparity_template_ || stereo_disparity_template_->f != stereo_disparity_template->f))
+        {
+            ROS_WARN("Current camera configuration has non-square pixels (fx != fy). The stereo_msgs/DisparityImage "
+                     "does not account for this. Be careful when reprojecting to a pointcloud.");
+        }
+
+        stereo_disparity_template_ = std::move(stereo_disparity_template);
+    }
+
     //
     // Publish the "raw" config message
 
@@ -2126,6 +2595,117 @@ void Camera::updateConfig(const image::Config& config)
     publishAllCameraInfo();
 }
 
+bool Camera::publishBufferImage(const image::Header& header, const std::string& frame_id, const ros::Time& stamp)
+{
+    if (!callback_buffer_limiter_ || (header.bitsPerPixel != 8 && header.bitsPerPixel != 16)) {
+        return false;
+    }
+
+    const auto pub = buffer_image_pubs_.find(header.source);
+    if (pub == std::end(buffer_image_pubs_)) {
+        return false;
+    }
+
+    //
+    // Image transport plugins (compressed, theora, ...) only receive images published through image_transport, which
+    // also serves the raw topic. The zero-copy publisher shares the raw topic, so any subscribers of the image
+    // transport beyond the raw subscribers are plugin subscribers
+
+    const uint32_t raw_subscribers = pub->second.raw.getNumSubscribers();
+    if (0 == raw_subscribers || pub->second.transport_subscribers() > raw_subscribers) {
+        return false;
+    }
+
+    const auto buffer = callback_buffer_limiter_->reserve(header);
+    if (!buffer) {
+        return false;
+    }
+
+    const auto image = boost::make_shared<BufferImage>();
+
+    image->header.frame_id = frame_id;
+    image->header.stamp    = stamp;
+    image->height          = header.height;
+    image->width           = header.width;
+    image->encoding        = header.bitsPerPixel == 8 ? sensor_msgs::image_encodings::MONO8 :
+                                                        sensor_msgs::image_encodings::MONO16;
+    image->is_bigendian    = (htonl(1) == 1);
+    image->step            = header.width * (header.bitsPerPixel / 8);
+    image->data            = reinterpret_cast<const uint8_t*>(buffer->data().imageDataP);
+    image->size            = header.imageLength;
+    image->owner           = buffer;
+
+    pub->second.raw.publish(image);
+
+    return true;
+}
+
+void Camera::dispatch(const std::string& queue,
+                      const image::Header& header,
+                      void (Camera::*callback)(const image::Header&))
+{
+    const auto tracker = latency_trackers_.find(std::make_pair(queue, header.source));
+    LatencyTracker* latency = tracker == std::end(latency_trackers_) ? nullptr : tracker->second;
+
+    if (!worker_pool_) {
+        const auto callback_start = LatencyTracker::now();
+
+        (this->*callback)(header);
+
+        if (latency) {
+            latency->record(ros::Time(header.timeSeconds, 1000 * header.timeMicroSeconds), callback_start);
+        }
+
+        return;
+    }
+
+    //
+    // Hold the driver buffer until the worker is done with the image. Zero-copy publishing on the worker shares this
+    // reservation since buffers can only be reserved on the driver callback thread
+
+    const auto image = std::make_shared<const BufferWrapper<image::Header>>(driver_, header);
+
+    worker_pool_->post(queue, [this, image, callback, latency]()
+    {
+        const auto callback_start = LatencyTracker::now();
+
+        {
+            const DispatchedImageScope scope(image);
+            (this->*callback)(image->data());
+        }
+
+        if (latency) {
+            latency->record(ros::Time(image->data().timeSeconds, 1000 * image->data().timeMicroSeconds), callback_start);
+        }
+    });
+}
+
+void Camera::dispatch(const std::string& queue,
+                      const AssembledFrame& frame,
+                      const std::function<void(const AssembledFrame&)>& callback)
+{
+    const auto tracker = latency_trackers_.find(std::make_pair(queue, static_cast<DataSource>(0)));
+    LatencyTracker* latency = tracker == std::end(latency_trackers_) ? nullptr : tracker->second;
+
+    const auto task = [frame, callback, latency]()
+    {
+        const auto callback_start = LatencyTracker::now();
+
+        callback(frame);
+
+        if (latency) {
+            latency->record(ros::Time(frame.timeSeconds(), 1000 * frame.timeMicroSeconds()), callback_start);
+        }
+    };
+
+    if (!worker_pool_) {
+        task();
+        return;
+    }
+
+    worker_pool_->post(queue, task);
+}
+
 void Camera::publishAllCameraInfo()
 {
     const auto stamp = ros::Time::now();
@@ -2276,8 +2856,103 @@ void Camera::deviceStatusDiagnostic(diagnostic_updater::DiagnosticStatusWrapper&
     }
 }
 
+void Camera::frameAssemblerDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat)
+{
+    const auto stats = frame_assembler_->stats();
+
+    stat.add("completed frames", stats.completed_frames);
+    stat.add("evicted frames",   stats.evicted_frames);
+    stat.add("late images",      stats.late_images);
+    stat.add("dropped images",   stats.dropped_images);
+    stat.add("restarts",         stats.restarts);
+    stat.add("pending frames",   stats.pending_frames);
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "MultiSense Frame Assembler");
+}
+
+void Camera::workerPoolDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat)
+{
+    uint64_t dropped = 0;
+
+    for (const auto &queue : worker_pool_->stats()) {
+        stat.add(queue.name + " depth",     queue.depth);
+        stat.add(queue.name + " max depth", queue.max_depth);
+        stat.add(queue.name + " processed", queue.processed);
+        stat.add(queue.name + " dropped",   queue.dropped);
+
+        dropped += queue.dropped;
+    }
+
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "MultiSense Worker Pool: " + std::to_string(dropped) + " dropped");
+}
+
+void Camera::latencyDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat)
+{
+    for (const auto &topic : latency_summaries_) {
+        if (0 == topic.latency.count) {
+            continue;
+        }
+
+        stat.add(topic.name + " count",          topic.latency.count);
+        stat.add(topic.name + " processing p50", topic.processing.p50);
+        stat.add(topic.name + " processing p95", topic.processing.p95);
+        stat.add(topic.name + " processing p99", topic.processing.p99);
+        stat.add(topic.name + " processing max", topic.processing.max);
+        stat.add(topic.name + " latency p50",    topic.latency.p50);
+        stat.add(topic.name + " latency p95",    topic.latency.p95);
+        stat.add(topic.name + " latency p99",    topic.latency.p99);
+        stat.add(topic.name + " latency max",    topic.latency.max);
+    }
+
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "MultiSense Latency");
+}
+
+void Camera::jpegDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat)
+{
+    const uint64_t failures = jpeg_decode_failures_;
+
+    stat.add("decoded images",  jpeg_decoded_frames_.load());
+    stat.add("decode failures", failures);
+
+    if (failures > 0) {
+        stat.summary(diagnostic_msgs::DiagnosticStatus::WARN,
+                     "MultiSense JPEG: " + std::to_string(failures) + " decode failures");
+    } else {
+        stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "MultiSense JPEG");
+    }
+}
+
 void Camera::diagnosticTimerCallback(const ros::TimerEvent&)
 {
+    //
+    // Summarize the latency histograms once per period and share the summary between diagnostics and the metrics topic
+
+    latency_summaries_ = latency_registry_->collect();
+
+    if (latency_metrics_pub_.getNumSubscribers() > 0) {
+
+        const auto metrics = boost::make_shared<multisense_ros::LatencyMetrics>();
+        metrics->time_stamp = ros::Time::now();
+
+        for (const auto &topic : latency_summaries_) {
+            multisense_ros::TopicLatency topic_latency;
+
+            topic_latency.name           = topic.name;
+            topic_latency.count          = topic.latency.count;
+            topic_latency.processing_p50 = topic.processing.p50;
+            topic_latency.processing_p95 = topic.processing.p95;
+            topic_latency.processing_p99 = topic.processing.p99;
+            topic_latency.processing_max = topic.processing.max;
+            topic_latency.latency_p50    = topic.latency.p50;
+            topic_latency.latency_p95    = topic.latency.p95;
+            topic_latency.latency_p99    = topic.latency.p99;
+            topic_latency.latency_max    = topic.latency.max;
+
+            metrics->topics.push_back(topic_latency);
+        }
+
+        latency_metrics_pub_.publish(metrics);
+    }
+
     diagnostic_updater_.update();
 }
 
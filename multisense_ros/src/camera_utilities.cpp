@@ -32,11 +32,18 @@
  **/
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
 
 #include <sensor_msgs/distortion_models.h>
 
 #include <multisense_ros/camera_utilities.h>
 
+#if MULTISENSE_ROS_X86_SIMD
+#include <immintrin.h>
+#endif
+
 namespace multisense_ros {
 
 namespace {
@@ -49,209 +56,1721 @@ struct ScaleT
     double cy_offset = 0.0;
 };
 
-ScaleT compute_scale(const crl::multisense::image::Config &config,
-                     const crl::multisense::system::DeviceInfo& device_info)
+ScaleT compute_scale(const crl::multisense::image::Config &config,
+                     const crl::multisense::system::DeviceInfo& device_info)
+{
+    const auto crop = config.camMode() == 2000 &&
+                      (device_info.imagerType == crl::multisense::system::DeviceInfo::IMAGER_TYPE_CMV4000_GREY ||
+                      device_info.imagerType == crl::multisense::system::DeviceInfo::IMAGER_TYPE_CMV4000_COLOR);
+
+    // crop mode causes the imager to behave completely like a CMV2000, but the device info imager height does not get modified
+    const auto imagerHeight = crop ? 1088 : device_info.imagerHeight;
+
+    const double x_scale = 1.0 / ((static_cast<double>(device_info.imagerWidth) /
+                                   static_cast<double>(config.width())));
+
+    const double y_scale = 1.0 / ((static_cast<double>(imagerHeight) /
+                                   static_cast<double>(config.height())));
+
+    //
+    // In crop mode we want to offset our cx/cy values
+    // by the current crop offset. This is because the pixel size does not change in crop mode, and instead a cropped
+    // region of the original image is returned
+
+    return ScaleT{x_scale,
+                  y_scale,
+                  0.0,
+                  crop ? -config.offset()*y_scale : 0.0};
+}
+
+}// namespace
+
+namespace {
+
+//
+// Fixed point YCbCr to BGR coefficients with YCBCR_SHIFT fractional bits. This is the finest precision for which the
+// scaled luma and chroma terms sum within int16 range. Each coefficient is within 0.5 / 64 of the floating point
+// coefficient, so every channel is within 1 of ycbcrToBgr<uint8_t>
+
+static constexpr int YCBCR_SHIFT = 6;
+static constexpr int16_t CR_TO_R = 90;  // 1.402
+static constexpr int16_t CB_TO_G = 22;  // 0.34414
+static constexpr int16_t CR_TO_G = 46;  // 0.71414
+static constexpr int16_t CB_TO_B = 113; // 1.772
+
+inline uint8_t ycbcrClamp(int32_t value)
+{
+    return value < 0 ? 0 : static_cast<uint8_t>(std::min(value >> YCBCR_SHIFT, 255));
+}
+
+//
+// Row kernels convert one or two luma rows which share a chroma row. luma_1 and output_1 are nullptr when converting
+// a single row
+
+void ycbcrToBgrRowsScalar(const uint8_t *luma_0,
+                          const uint8_t *luma_1,
+                          const uint8_t *chroma,
+                          size_t begin,
+                          size_t end,
+                          uint8_t *output_0,
+                          uint8_t *output_1)
+{
+    for (size_t u = begin ; u < end ; ++u)
+    {
+        const int32_t cb = static_cast<int32_t>(chroma[2 * (u / 2) + 0]) - 128;
+        const int32_t cr = static_cast<int32_t>(chroma[2 * (u / 2) + 1]) - 128;
+
+        const int32_t r_term = CR_TO_R * cr;
+        const int32_t g_term = -(CB_TO_G * cb + CR_TO_G * cr);
+        const int32_t b_term = CB_TO_B * cb;
+
+        const int32_t y_0 = static_cast<int32_t>(luma_0[u]) << YCBCR_SHIFT;
+        output_0[3 * u + 0] = ycbcrClamp(y_0 + b_term);
+        output_0[3 * u + 1] = ycbcrClamp(y_0 + g_term);
+        output_0[3 * u + 2] = ycbcrClamp(y_0 + r_term);
+
+        if (luma_1)
+        {
+            const int32_t y_1 = static_cast<int32_t>(luma_1[u]) << YCBCR_SHIFT;
+            output_1[3 * u + 0] = ycbcrClamp(y_1 + b_term);
+            output_1[3 * u + 1] = ycbcrClamp(y_1 + g_term);
+            output_1[3 * u + 2] = ycbcrClamp(y_1 + r_term);
+        }
+    }
+}
+
+#if MULTISENSE_ROS_X86_SIMD
+
+//
+// The vectorized kernels perform exactly the same integer operations as the scalar kernel, so all implementations
+// produce identical results. Each 16 bit lane holds one pixel, and the chroma terms of a 2x2 block are computed once
+// for both rows. They return the first column they did not process
+
+__attribute__((target("sse4.1")))
+inline void ycbcrToBgrStoreSse4(__m128i b, __m128i g, __m128i r, uint8_t *output)
+{
+    //
+    // Interleave 16 blue, green and red values into 48 bytes of BGR
+
+    const __m128i b_0 = _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5);
+    const __m128i g_0 = _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1);
+    const __m128i r_0 = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+    const __m128i b_1 = _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1);
+    const __m128i g_1 = _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10);
+    const __m128i r_1 = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1);
+    const __m128i b_2 = _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1);
+    const __m128i g_2 = _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1);
+    const __m128i r_2 = _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15);
+
+    const __m128i out_0 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(b, b_0), _mm_shuffle_epi8(g, g_0)),
+                                       _mm_shuffle_epi8(r, r_0));
+    const __m128i out_1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(b, b_1), _mm_shuffle_epi8(g, g_1)),
+                                       _mm_shuffle_epi8(r, r_1));
+    const __m128i out_2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(b, b_2), _mm_shuffle_epi8(g, g_2)),
+                                       _mm_shuffle_epi8(r, r_2));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), out_0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16), out_1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 32), out_2);
+}
+
+__attribute__((target("sse4.1")))
+inline __m128i ycbcrToBgrChannelSse4(__m128i y_lo, __m128i y_hi, __m128i term_lo, __m128i term_hi)
+{
+    return _mm_packus_epi16(_mm_srai_epi16(_mm_add_epi16(y_lo, term_lo), YCBCR_SHIFT),
+                            _mm_srai_epi16(_mm_add_epi16(y_hi, term_hi), YCBCR_SHIFT));
+}
+
+__attribute__((target("sse4.1")))
+inline void ycbcrToBgrRowSse4(const uint8_t *luma,
+                              __m128i r_lo, __m128i r_hi,
+                              __m128i g_lo, __m128i g_hi,
+                              __m128i b_lo, __m128i b_hi,
+                              uint8_t *output)
+{
+    const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(luma));
+    const __m128i y_lo = _mm_slli_epi16(_mm_cvtepu8_epi16(y), YCBCR_SHIFT);
+    const __m128i y_hi = _mm_slli_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(y, 8)), YCBCR_SHIFT);
+
+    ycbcrToBgrStoreSse4(ycbcrToBgrChannelSse4(y_lo, y_hi, b_lo, b_hi),
+                        ycbcrToBgrChannelSse4(y_lo, y_hi, g_lo, g_hi),
+                        ycbcrToBgrChannelSse4(y_lo, y_hi, r_lo, r_hi),
+                        output);
+}
+
+__attribute__((target("sse4.1")))
+size_t ycbcrToBgrRowsSse4(const uint8_t *luma_0,
+                          const uint8_t *luma_1,
+                          const uint8_t *chroma,
+                          size_t width,
+                          uint8_t *output_0,
+                          uint8_t *output_1)
+{
+    const __m128i cb_shuffle = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14);
+    const __m128i cr_shuffle = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15);
+    const __m128i chroma_offset = _mm_set1_epi16(128);
+    const __m128i cr_to_r = _mm_set1_epi16(CR_TO_R);
+    const __m128i cb_to_g = _mm_set1_epi16(CB_TO_G);
+    const __m128i cr_to_g = _mm_set1_epi16(CR_TO_G);
+    const __m128i cb_to_b = _mm_set1_epi16(CB_TO_B);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t u = 0;
+    for ( ; u + 16 <= width ; u += 16)
+    {
+        //
+        // 16 bytes of interleaved CbCr cover 16 pixels. Duplicate each chroma sample for the two pixels it covers
+
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chroma + u));
+        const __m128i cb = _mm_shuffle_epi8(c, cb_shuffle);
+        const __m128i cr = _mm_shuffle_epi8(c, cr_shuffle);
+
+        const __m128i cb_lo = _mm_sub_epi16(_mm_cvtepu8_epi16(cb), chroma_offset);
+        const __m128i cb_hi = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(cb, 8)), chroma_offset);
+        const __m128i cr_lo = _mm_sub_epi16(_mm_cvtepu8_epi16(cr), chroma_offset);
+        const __m128i cr_hi = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(cr, 8)), chroma_offset);
+
+        const __m128i r_lo = _mm_mullo_epi16(cr_lo, cr_to_r);
+        const __m128i r_hi = _mm_mullo_epi16(cr_hi, cr_to_r);
+        const __m128i g_lo = _mm_sub_epi16(zero, _mm_add_epi16(_mm_mullo_epi16(cb_lo, cb_to_g),
+                                                               _mm_mullo_epi16(cr_lo, cr_to_g)));
+        const __m128i g_hi = _mm_sub_epi16(zero, _mm_add_epi16(_mm_mullo_epi16(cb_hi, cb_to_g),
+                                                               _mm_mullo_epi16(cr_hi, cr_to_g)));
+        const __m128i b_lo = _mm_mullo_epi16(cb_lo, cb_to_b);
+        const __m128i b_hi = _mm_mullo_epi16(cb_hi, cb_to_b);
+
+        ycbcrToBgrRowSse4(luma_0 + u, r_lo, r_hi, g_lo, g_hi, b_lo, b_hi, output_0 + 3 * u);
+
+        if (luma_1)
+        {
+            ycbcrToBgrRowSse4(luma_1 + u, r_lo, r_hi, g_lo, g_hi, b_lo, b_hi, output_1 + 3 * u);
+        }
+    }
+
+    return u;
+}
+
+__attribute__((target("avx2")))
+inline __m256i ycbcrToBgrChannelAvx2(__m256i y_lo, __m256i y_hi, __m256i term_lo, __m256i term_hi)
+{
+    //
+    // Packing interleaves the 128 bit lanes of the two halves, so restore pixel order afterwards
+
+    const __m256i packed = _mm256_packus_epi16(_mm256_srai_epi16(_mm256_add_epi16(y_lo, term_lo), YCBCR_SHIFT),
+                                               _mm256_srai_epi16(_mm256_add_epi16(y_hi, term_hi), YCBCR_SHIFT));
+
+    return _mm256_permute4x64_epi64(packed, 0xD8);
+}
+
+__attribute__((target("avx2")))
+inline void ycbcrToBgrRowAvx2(const uint8_t *luma,
+                              __m256i r_lo, __m256i r_hi,
+                              __m256i g_lo, __m256i g_hi,
+                              __m256i b_lo, __m256i b_hi,
+                              uint8_t *output)
+{
+    const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(luma));
+    const __m256i y_lo = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(y)), YCBCR_SHIFT);
+    const __m256i y_hi = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(y, 1)), YCBCR_SHIFT);
+
+    const __m256i b = ycbcrToBgrChannelAvx2(y_lo, y_hi, b_lo, b_hi);
+    const __m256i g = ycbcrToBgrChannelAvx2(y_lo, y_hi, g_lo, g_hi);
+    const __m256i r = ycbcrToBgrChannelAvx2(y_lo, y_hi, r_lo, r_hi);
+
+    //
+    // Interleave each 128 bit lane of 16 pixels into 48 bytes of BGR with the same shuffles as the SSE4 kernel
+
+    const __m256i b_0 = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5));
+    const __m256i g_0 = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1));
+    const __m256i r_0 = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1));
+    const __m256i b_1 = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1));
+    const __m256i g_1 = _mm256_broadcastsi128_si256(_mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10));
+    const __m256i r_1 = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1));
+    const __m256i b_2 = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1));
+    const __m256i g_2 = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1));
+    const __m256i r_2 = _mm256_broadcastsi128_si256(_mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15));
+
+    const __m256i out_0 = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(b, b_0), _mm256_shuffle_epi8(g, g_0)),
+                                          _mm256_shuffle_epi8(r, r_0));
+    const __m256i out_1 = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(b, b_1), _mm256_shuffle_epi8(g, g_1)),
+                                          _mm256_shuffle_epi8(r, r_1));
+    const __m256i out_2 = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(b, b_2), _mm256_shuffle_epi8(g, g_2)),
+                                          _mm256_shuffle_epi8(r, r_2));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), _mm256_permute2x128_si256(out_0, out_1, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 32), _mm256_permute2x128_si256(out_2, out_0, 0x30));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 64), _mm256_permute2x128_si256(out_1, out_2, 0x31));
+}
+
+__attribute__((target("avx2")))
+size_t ycbcrToBgrRowsAvx2(const uint8_t *luma_0,
+                          const uint8_t *luma_1,
+                          const uint8_t *chroma,
+                          size_t width,
+                          uint8_t *output_0,
+                          uint8_t *output_1)
+{
+    const __m256i cb_shuffle = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14));
+    const __m256i cr_shuffle = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15));
+    const __m256i chroma_offset = _mm256_set1_epi16(128);
+    const __m256i cr_to_r = _mm256_set1_epi16(CR_TO_R);
+    const __m256i cb_to_g = _mm256_set1_epi16(CB_TO_G);
+    const __m256i cr_to_g = _mm256_set1_epi16(CR_TO_G);
+    const __m256i cb_to_b = _mm256_set1_epi16(CB_TO_B);
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t u = 0;
+    for ( ; u + 32 <= width ; u += 32)
+    {
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(chroma + u));
+        const __m256i cb = _mm256_shuffle_epi8(c, cb_shuffle);
+        const __m256i cr = _mm256_shuffle_epi8(c, cr_shuffle);
+
+        const __m256i cb_lo = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(cb)), chroma_offset);
+        const __m256i cb_hi = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(cb, 1)), chroma_offset);
+        const __m256i cr_lo = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(cr)), chroma_offset);
+        const __m256i cr_hi = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(cr, 1)), chroma_offset);
+
+        const __m256i r_lo = _mm256_mullo_epi16(cr_lo, cr_to_r);
+        const __m256i r_hi = _mm256_mullo_epi16(cr_hi, cr_to_r);
+        const __m256i g_lo = _mm256_sub_epi16(zero, _mm256_add_epi16(_mm256_mullo_epi16(cb_lo, cb_to_g),
+                                                                     _mm256_mullo_epi16(cr_lo, cr_to_g)));
+        const __m256i g_hi = _mm256_sub_epi16(zero, _mm256_add_epi16(_mm256_mullo_epi16(cb_hi, cb_to_g),
+                                                                     _mm256_mullo_epi16(cr_hi, cr_to_g)));
+        const __m256i b_lo = _mm256_mullo_epi16(cb_lo, cb_to_b);
+        const __m256i b_hi = _mm256_mullo_epi16(cb_hi, cb_to_b);
+
+        ycbcrToBgrRowAvx2(luma_0 + u, r_lo, r_hi, g_lo, g_hi, b_lo, b_hi, output_0 + 3 * u);
+
+        if (luma_1)
+        {
+            ycbcrToBgrRowAvx2(luma_1 + u, r_lo, r_hi, g_lo, g_hi, b_lo, b_hi, output_1 + 3 * u);
+        }
+    }
+
+    return u;
+}
+
+#endif
+
+void ycbcrToBgrRows(const uint8_t *luma_0,
+                    const uint8_t *luma_1,
+                    const uint8_t *chroma,
+                    size_t width,
+                    uint8_t *output_0,
+                    uint8_t *output_1,
+                    SimdLevel level)
+{
+    size_t begin = 0;
+
+#if MULTISENSE_ROS_X86_SIMD
+
+    //
+    // Only vectorize columns whose chroma sample lies within the chroma row
+
+    const size_t vector_width = width & ~static_cast<size_t>(1);
+
+    switch (level)
+    {
+        case SimdLevel::AVX2:
+            begin = ycbcrToBgrRowsAvx2(luma_0, luma_1, chroma, vector_width, output_0, output_1);
+            break;
+        case SimdLevel::SSE4:
+            begin = ycbcrToBgrRowsSse4(luma_0, luma_1, chroma, vector_width, output_0, output_1);
+            break;
+        case SimdLevel::SCALAR:
+            break;
+    }
+#else
+    (void) level;
+#endif
+
+    //
+    // Finish any columns which did not fill an entire vector
+
+    ycbcrToBgrRowsScalar(luma_0, luma_1, chroma, begin, width, output_0, output_1);
+}
+
+}// namespace
+
+void ycbcrToBgr(const crl::multisense::image::Header &luma,
+                const crl::multisense::image::Header &chroma,
+                size_t begin_row,
+                size_t end_row,
+                uint8_t *output,
+                SimdLevel level)
+{
+    const uint8_t *lumaP = reinterpret_cast<const uint8_t*>(luma.imageDataP);
+    const uint8_t *chromaP = reinterpret_cast<const uint8_t*>(chroma.imageDataP);
+
+    const size_t width = luma.width;
+    const size_t rgb_stride = width * 3;
+    const size_t chroma_stride = 2 * (width / 2);
+
+    size_t v = begin_row;
+    while (v < end_row)
+    {
+        //
+        // Convert rows which share a chroma row together, unless the range starts or ends within a pair
+
+        const bool pair = (v % 2 == 0) && (v + 1 < end_row);
+
+        ycbcrToBgrRows(lumaP + v * width,
+                       pair ? lumaP + (v + 1) * width : nullptr,
+                       chromaP + (v / 2) * chroma_stride,
+                       width,
+                       output + v * rgb_stride,
+                       pair ? output + (v + 1) * rgb_stride : nullptr,
+                       level);
+
+        v += pair ? 2 : 1;
+    }
+}
+
+void ycbcrToBgr(const crl::multisense::image::Header &luma,
+                const crl::multisense::image::Header &chroma,
+                uint8_t *output,
+                SimdLevel level)
+{
+    ycbcrToBgr(luma, chroma, 0, luma.height, output, level);
+}
+
+void ycbcrToBgr(const crl::multisense::image::Header &luma,
+                const crl::multisense::image::Header &chroma,
+                uint8_t *output,
+                RowBandExecutor &executor,
+                SimdLevel level)
+{
+    //
+    // Split the image on row pairs so no 2x2 chroma block is split between bands
+
+    const size_t height = luma.height;
+
+    executor.run((height + 1) / 2, [&](size_t, size_t begin_pair, size_t end_pair)
+    {
+        ycbcrToBgr(luma, chroma, 2 * begin_pair, std::min(2 * end_pair, height), output, level);
+    });
+}
+
+Ycbcr420ImageT makeYcbcr420Image(const crl::multisense::image::Header &luma,
+                                 const crl::multisense::image::Header &chroma)
+{
+    const uint8_t *chromaP = reinterpret_cast<const uint8_t*>(chroma.imageDataP);
+
+    Ycbcr420ImageT image;
+    image.width = luma.width;
+    image.height = luma.height;
+    image.luma = reinterpret_cast<const uint8_t*>(luma.imageDataP);
+    image.luma_stride = luma.width;
+    image.cb = chromaP;
+    image.cr = chromaP + 1;
+    image.chroma_width = luma.width / 2;
+    image.chroma_height = luma.height / 2;
+    image.chroma_step = 2;
+    image.chroma_stride = 2 * (luma.width / 2);
+
+    return image;
+}
+
+namespace {
+
+///
+/// @brief Convert a single YCbCr420 pixel to BGR with the same fixed point arithmetic as ycbcrToBgr. Pixels outside of
+///        the image are black, matching the constant border of cv::remap
+///
+inline void ycbcrPixelToBgr(const Ycbcr420ImageT &image, int x, int y, int32_t *bgr)
+{
+    if (x < 0 || y < 0 || x >= static_cast<int>(image.width) || y >= static_cast<int>(image.height))
+    {
+        bgr[0] = bgr[1] = bgr[2] = 0;
+        return;
+    }
+
+    //
+    // Each chroma sample covers a 2x2 block of luma pixels. Clamp for odd image dimensions
+
+    const size_t chroma_x = std::min(static_cast<size_t>(x / 2), image.chroma_width - 1);
+    const size_t chroma_y = std::min(static_cast<size_t>(y / 2), image.chroma_height - 1);
+    const size_t chroma_offset = chroma_y * image.chroma_stride + chroma_x * image.chroma_step;
+
+    const int32_t luma = static_cast<int32_t>(image.luma[y * image.luma_stride + x]) << YCBCR_SHIFT;
+    const int32_t cb = static_cast<int32_t>(image.cb[chroma_offset]) - 128;
+    const int32_t cr = static_cast<int32_t>(image.cr[chroma_offset]) - 128;
+
+    bgr[0] = ycbcrClamp(luma + CB_TO_B * cb);
+    bgr[1] = ycbcrClamp(luma - (CB_TO_G * cb + CR_TO_G * cr));
+    bgr[2] = ycbcrClamp(luma + CR_TO_R * cr);
+}
+
+//
+// cv::remap bilinear weights have REMAP_COEF_BITS fractional bits
+
+static constexpr int REMAP_COEF_BITS = 15;
+
+}// namespace
+
+bool isValidRectificationRemap(const RectificationRemapT &remap, size_t width, size_t height)
+{
+    return remap.map1.type() == CV_16SC2 && remap.map2.type() == CV_16UC1 &&
+           static_cast<size_t>(remap.map1.cols) == width && static_cast<size_t>(remap.map1.rows) == height &&
+           remap.map1.size() == remap.map2.size();
+}
+
+void ycbcrToRectifiedBgrPixel(const Ycbcr420ImageT &image,
+                              const RectificationRemapT &remap,
+                              size_t u,
+                              size_t v,
+                              uint8_t *output)
+{
+    const int16_t *map_xy = remap.map1.ptr<int16_t>(v) + 2 * u;
+    const uint16_t map_offset = remap.map2.ptr<uint16_t>(v)[u];
+
+    const int x0 = map_xy[0];
+    const int y0 = map_xy[1];
+
+    //
+    // Pixels which map entirely outside of the image are black
+
+    if (x0 < -1 || y0 < -1 || x0 >= static_cast<int>(image.width) || y0 >= static_cast<int>(image.height))
+    {
+        output[0] = output[1] = output[2] = 0;
+        return;
+    }
+
+    //
+    // Interpolate with the integer weights of cv::remap, which are exact products of the INTER_TAB_SIZE sub-pixel
+    // offsets
+
+    const int32_t fx = map_offset & (cv::INTER_TAB_SIZE - 1);
+    const int32_t fy = map_offset >> cv::INTER_BITS;
+    constexpr int32_t scale = (1 << REMAP_COEF_BITS) / (cv::INTER_TAB_SIZE * cv::INTER_TAB_SIZE);
+
+    const int32_t weights[4] = {(cv::INTER_TAB_SIZE - fx) * (cv::INTER_TAB_SIZE - fy) * scale,
+                                fx * (cv::INTER_TAB_SIZE - fy) * scale,
+                                (cv::INTER_TAB_SIZE - fx) * fy * scale,
+                                fx * fy * scale};
+
+    int32_t samples[4][3];
+    ycbcrPixelToBgr(image, x0, y0, samples[0]);
+    ycbcrPixelToBgr(image, x0 + 1, y0, samples[1]);
+    ycbcrPixelToBgr(image, x0, y0 + 1, samples[2]);
+    ycbcrPixelToBgr(image, x0 + 1, y0 + 1, samples[3]);
+
+    for (size_t c = 0 ; c < 3 ; ++c)
+    {
+        const int32_t sum = samples[0][c] * weights[0] + samples[1][c] * weights[1] +
+                            samples[2][c] * weights[2] + samples[3][c] * weights[3];
+
+        output[c] = static_cast<uint8_t>(std::min((sum + (1 << (REMAP_COEF_BITS - 1))) >> REMAP_COEF_BITS, 255));
+    }
+}
+
+Eigen::Matrix4d makeQ(const crl::multisense::image::Config& config,
+                      const crl::multisense::image::Calibration& calibration,
+                      const crl::multisense::system::DeviceInfo& device_info)
+{
+    Eigen::Matrix4d q_matrix = Eigen::Matrix4d::Zero();
+
+    const auto scale = compute_scale(config, device_info);
+
+    //
+    // Compute the Q matrix here, as image_geometery::StereoCameraModel does
+    // not allow for non-square pixels.
+    //
+    //  FyTx    0     0    -FyCxTx
+    //   0     FxTx   0    -FxCyTx
+    //   0      0     0     FxFyTx
+    //   0      0    -Fy    Fy(Cx - Cx')
+    //
+    const auto fx = calibration.left.P[0][0] * scale.x_scale;
+    const auto cx = calibration.left.P[0][2] * scale.x_scale + scale.cx_offset;
+    const auto fy = calibration.left.P[1][1] * scale.y_scale;
+    const auto cy = calibration.left.P[1][2] * scale.y_scale + scale.cy_offset;
+    const auto tx = calibration.right.P[0][3] / calibration.right.P[0][0];
+    const auto cx_prime = calibration.left.P[0][2] * scale.x_scale + scale.cx_offset;
+
+    q_matrix(0,0) =  fy * tx;
+    q_matrix(1,1) =  fx * tx;
+    q_matrix(0,3) = -fy * cx * tx;
+    q_matrix(1,3) = -fx * cy * tx;
+    q_matrix(2,3) =  fx * fy * tx;
+    q_matrix(3,2) = -fy;
+    q_matrix(3,3) =  fy * (cx - cx_prime);
+
+    return q_matrix;
+}
+
+sensor_msgs::CameraInfo makeCameraInfo(const crl::multisense::image::Config& config,
+                                       const crl::multisense::image::Calibration::Data& calibration,
+                                       const ScaleT &scale)
+{
+    sensor_msgs::CameraInfo camera_info;
+
+    camera_info.width = config.width();
+    camera_info.height = config.height();
+
+    camera_info.P[0] = calibration.P[0][0] * scale.x_scale;
+    camera_info.P[1] = calibration.P[0][1];
+    camera_info.P[2] = calibration.P[0][2] * scale.x_scale + scale.cx_offset;
+    camera_info.P[3] = calibration.P[0][3] * scale.x_scale;
+    camera_info.P[4] = calibration.P[1][0];
+    camera_info.P[5] = calibration.P[1][1] * scale.y_scale;
+    camera_info.P[6] = calibration.P[1][2] * scale.y_scale + scale.cy_offset;
+    camera_info.P[7] = calibration.P[1][3];
+    camera_info.P[8] = calibration.P[2][0];
+    camera_info.P[9] = calibration.P[2][1];
+    camera_info.P[10] = calibration.P[2][2];
+    camera_info.P[11] = calibration.P[2][3];
+
+    camera_info.K[0] = calibration.M[0][0] * scale.x_scale;
+    camera_info.K[1] = calibration.M[0][1];
+    camera_info.K[2] = calibration.M[0][2] * scale.x_scale + scale.cx_offset;
+    camera_info.K[3] = calibration.M[1][0];
+    camera_info.K[4] = calibration.M[1][1] * scale.y_scale;
+    camera_info.K[5] = calibration.M[1][2] * scale.y_scale + scale.cy_offset;
+    camera_info.K[6] = calibration.M[2][0];
+    camera_info.K[7] = calibration.M[2][1];
+    camera_info.K[8] = calibration.M[2][2];
+
+    camera_info.R[0] = calibration.R[0][0];
+    camera_info.R[1] = calibration.R[0][1];
+    camera_info.R[2] = calibration.R[0][2];
+    camera_info.R[3] = calibration.R[1][0];
+    camera_info.R[4] = calibration.R[1][1];
+    camera_info.R[5] = calibration.R[1][2];
+    camera_info.R[6] = calibration.R[2][0];
+    camera_info.R[7] = calibration.R[2][1];
+    camera_info.R[8] = calibration.R[2][2];
+
+    //
+    // Distortion coefficients follow OpenCV's convention.
+    // k1, k2, p1, p2, k3, k4, k5, k6
+
+    camera_info.D.resize(8);
+    for (size_t i=0 ; i < 8 ; ++i)
+    {
+        camera_info.D[i] = calibration.D[i];
+    }
+
+    //
+    // MultiSense cameras support both the full 8 parameter rational_polynomial
+    // model and the simplified 5 parameter plum_bob model. If the last 3
+    // parameters of the distortion model are 0 then the camera is using
+    // the simplified plumb_bob model
+
+    if (calibration.D[7] == 0.0 && calibration.D[6] == 0.0 && calibration.D[5] == 0.0)
+    {
+        camera_info.distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
+    }
+    else
+    {
+        camera_info.distortion_model = sensor_msgs::distortion_models::RATIONAL_POLYNOMIAL;
+    }
+
+    return camera_info;
+}
+
+RectificationRemapT makeRectificationRemap(const crl::multisense::image::Config& config,
+                                           const crl::multisense::image::Calibration::Data& calibration,
+                                           const crl::multisense::system::DeviceInfo& device_info)
+{
+    RectificationRemapT remap;
+
+    const auto scale = compute_scale(config, device_info);
+
+    const cv::Matx33d K(calibration.M[0][0] * scale.x_scale,
+                        calibration.M[0][1],
+                        calibration.M[0][2] * scale.x_scale + scale.cx_offset,
+                        calibration.M[1][0],
+                        calibration.M[1][1] * scale.y_scale,
+                        calibration.M[1][2] * scale.y_scale + scale.cy_offset,
+                        calibration.M[2][0],
+                        calibration.M[2][1],
+                        calibration.M[2][2]);
+
+    const cv::Matx33d R(calibration.R[0][0],
+                        calibration.R[0][1],
+                        calibration.R[0][2],
+                        calibration.R[1][0],
+                        calibration.R[1][1],
+                        calibration.R[1][2],
+                        calibration.R[2][0],
+                        calibration.R[2][1],
+                        calibration.R[2][2]);
+
+    const cv::Matx34d P(calibration.P[0][0] * scale.x_scale,
+                        calibration.P[0][1],
+                        calibration.P[0][2] * scale.x_scale + scale.cx_offset,
+                        calibration.P[0][3] * scale.x_scale,
+                        calibration.P[1][0],
+                        calibration.P[1][1] * scale.y_scale,
+                        calibration.P[1][2] * scale.y_scale + scale.cy_offset,
+                        calibration.P[1][3],
+                        calibration.P[2][0],
+                        calibration.P[2][1],
+                        calibration.P[2][2],
+                        calibration.P[2][3]);
+
+    const bool plumbob = calibration.D[7] == 0.0 && calibration.D[6] == 0.0 && calibration.D[5] == 0.0;
+
+    cv::Mat D(plumbob ? 5 : 8, 1, CV_64FC1);
+    for (int i = 0; i < D.rows ; ++i)
+    {
+        D.at<double>(i) = calibration.D[i];
+    }
+
+    //
+    // Fixed point maps remap considerably faster than floating point maps and use half of the memory
+
+    cv::initUndistortRectifyMap(K, D, R, P, cv::Size(config.width(), config.height()), CV_16SC2, remap.map1, remap.map2);
+
+    return remap;
+}
+
+constexpr size_t RectificationRemapCache::DEFAULT_CAPACITY;
+
+RectificationRemapCache::RectificationRemapCache(const crl::multisense::image::Calibration &calibration,
+                                                 const crl::multisense::system::DeviceInfo &device_info,
+                                                 size_t capacity):
+    calibration_(calibration),
+    device_info_(device_info),
+    capacity_(std::max(capacity, static_cast<size_t>(1))),
+    builder_(1, 1)
+{
+}
+
+StereoRectificationRemapT RectificationRemapCache::build(const crl::multisense::image::Config &config)
+{
+    const auto key = makeKey(config);
+
+    StereoRectificationRemapT remaps;
+    if (find(key, remaps))
+    {
+        return remaps;
+    }
+
+    remaps.left = std::make_shared<RectificationRemapT>(makeRectificationRemap(config, calibration_.left, device_info_));
+    remaps.right = std::make_shared<RectificationRemapT>(makeRectificationRemap(config, calibration_.right, device_info_));
+
+    insert(key, remaps);
+
+    return remaps;
+}
+
+StereoRectificationRemapT RectificationRemapCache::get(const crl::multisense::image::Config &config)
+{
+    StereoRectificationRemapT remaps;
+    if (find(makeKey(config), remaps))
+    {
+        return remaps;
+    }
+
+    //
+    // Requests for the same config while it is being built queue a build which finds the cached maps. A request for
+    // a different config replaces any queued build which has not started
+
+    builder_.post("remap", [this, config]()
+    {
+        build(config);
+    });
+
+    return remaps;
+}
+
+RectificationRemapCache::KeyT RectificationRemapCache::makeKey(const crl::multisense::image::Config &config)
+{
+    KeyT key;
+    key.width = config.width();
+    key.height = config.height();
+    key.offset = config.offset();
+
+    return key;
+}
+
+bool RectificationRemapCache::find(const KeyT &key, StereoRectificationRemapT &remaps)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto entry = std::find_if(std::begin(entries_), std::end(entries_),
+                                    [&key](const std::pair<KeyT, StereoRectificationRemapT> &entry)
+                                    {
+                                        return entry.first == key;
+                                    });
+
+    if (entry == std::end(entries_))
+    {
+        return false;
+    }
+
+    entries_.splice(std::begin(entries_), entries_, entry);
+    remaps = entry->second;
+
+    return true;
+}
+
+void RectificationRemapCache::insert(const KeyT &key, const StereoRectificationRemapT &remaps)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    entries_.remove_if([&key](const std::pair<KeyT, StereoRectificationRemapT> &entry)
+                       {
+                           return entry.first == key;
+                       });
+
+    entries_.emplace_front(key, remaps);
+
+    while (entries_.size() > capacity_)
+    {
+        entries_.pop_back();
+    }
+}
+
+namespace {
+
+//
+// Ratio between raw disparity values and disparities in pixels
+
+template <typename T>
+constexpr float disparityScale();
+
+template <>
+constexpr float disparityScale<uint16_t>()
+{
+    return 16.0f;
+}
+
+template <>
+constexpr float disparityScale<float>()
+{
+    return 1.0f;
+}
+
+//
+// Depth of a single disparity without the depth offset. 16 bit disparities use the lookup table of the ray table,
+// which holds exactly the result of the division
+
+inline float disparityDepth(uint16_t disparity, float, const RayTableT &ray_table)
+{
+    return ray_table.depth_lut[disparity];
+}
+
+inline float disparityDepth(float disparity, float depth_scale, const RayTableT &)
+{
+    return depth_scale / disparity;
+}
+
+template <typename T>
+void reprojectDisparityRowScalar(const T *disparity,
+                                 size_t v,
+                                 size_t begin,
+                                 size_t end,
+                                 const RayTableT &ray_table,
+                                 float *x,
+                                 float *y,
+                                 float *z)
+{
+    const float invalid = std::numeric_limits<float>::max();
+    const float depth_scale = ray_table.depth_scale * disparityScale<T>();
+    const float y_over_z = ray_table.y_over_z[v];
+
+    for (size_t u = begin ; u < end ; ++u)
+    {
+        const float d = static_cast<float>(disparity[u]);
+
+        if (d == 0.0f)
+        {
+            x[u] = invalid;
+            y[u] = invalid;
+            z[u] = invalid;
+            continue;
+        }
+
+        const float depth = disparityDepth(disparity[u], depth_scale, ray_table) + ray_table.depth_offset;
+
+        x[u] = ray_table.x_over_z[u] * depth;
+        y[u] = y_over_z * depth;
+        z[u] = depth;
+    }
+}
+
+#if MULTISENSE_ROS_X86_SIMD
+
+//
+// The vectorized kernels perform exactly the same single precision operations in the same order as the scalar
+// kernel, so all implementations produce identical results. They return the first column they did not process
+
+__attribute__((target("avx2")))
+inline __m256 loadDisparityAvx2(const uint16_t *disparity)
+{
+    const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(disparity));
+    return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(raw));
+}
+
+__attribute__((target("avx2")))
+inline __m256 loadDisparityAvx2(const float *disparity)
+{
+    return _mm256_loadu_ps(disparity);
+}
+
+//
+// Vectorized disparityDepth. d holds the disparities converted to float, which are exact for 16 bit disparities
+
+__attribute__((target("avx2")))
+inline __m256 disparityDepthAvx2(const uint16_t *, __m256 d, __m256, const RayTableT &ray_table)
+{
+    return _mm256_i32gather_ps(ray_table.depth_lut.data(), _mm256_cvttps_epi32(d), sizeof(float));
+}
+
+__attribute__((target("avx2")))
+inline __m256 disparityDepthAvx2(const float *, __m256 d, __m256 depth_scale, const RayTableT &)
+{
+    return _mm256_div_ps(depth_scale, d);
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+size_t reprojectDisparityRowAvx2(const T *disparity,
+                                 size_t v,
+                                 size_t width,
+                                 const RayTableT &ray_table,
+                                 float *x,
+                                 float *y,
+                                 float *z)
+{
+    const __m256 invalid = _mm256_set1_ps(std::numeric_limits<float>::max());
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 depth_scale = _mm256_set1_ps(ray_table.depth_scale * disparityScale<T>());
+    const __m256 depth_offset = _mm256_set1_ps(ray_table.depth_offset);
+    const __m256 y_over_z = _mm256_set1_ps(ray_table.y_over_z[v]);
+    const float *x_over_z = ray_table.x_over_z.data();
+
+    size_t u = 0;
+    for ( ; u + 8 <= width ; u += 8)
+    {
+        const __m256 d = loadDisparityAvx2(disparity + u);
+        const __m256 invalid_mask = _mm256_cmp_ps(d, zero, _CMP_EQ_OQ);
+
+        const __m256 depth = _mm256_add_ps(disparityDepthAvx2(disparity, d, depth_scale, ray_table), depth_offset);
+
+        const __m256 px = _mm256_mul_ps(_mm256_loadu_ps(x_over_z + u), depth);
+        const __m256 py = _mm256_mul_ps(y_over_z, depth);
+
+        _mm256_storeu_ps(x + u, _mm256_blendv_ps(px, invalid, invalid_mask));
+        _mm256_storeu_ps(y + u, _mm256_blendv_ps(py, invalid, invalid_mask));
+        _mm256_storeu_ps(z + u, _mm256_blendv_ps(depth, invalid, invalid_mask));
+    }
+
+    return u;
+}
+
+__attribute__((target("sse4.1")))
+inline __m128 loadDisparitySse4(const uint16_t *disparity)
+{
+    const __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(disparity));
+    return _mm_cvtepi32_ps(_mm_cvtepu16_epi32(raw));
+}
+
+__attribute__((target("sse4.1")))
+inline __m128 loadDisparitySse4(const float *disparity)
+{
+    return _mm_loadu_ps(disparity);
+}
+
+template <typename T>
+__attribute__((target("sse4.1")))
+size_t reprojectDisparityRowSse4(const T *disparity,
+                                 size_t v,
+                                 size_t width,
+                                 const RayTableT &ray_table,
+                                 float *x,
+                                 float *y,
+                                 float *z)
+{
+    const __m128 invalid = _mm_set1_ps(std::numeric_limits<float>::max());
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 depth_scale = _mm_set1_ps(ray_table.depth_scale * disparityScale<T>());
+    const __m128 depth_offset = _mm_set1_ps(ray_table.depth_offset);
+    const __m128 y_over_z = _mm_set1_ps(ray_table.y_over_z[v]);
+    const float *x_over_z = ray_table.x_over_z.data();
+
+    size_t u = 0;
+    for ( ; u + 4 <= width ; u += 4)
+    {
+        const __m128 d = loadDisparitySse4(disparity + u);
+        const __m128 invalid_mask = _mm_cmpeq_ps(d, zero);
+
+        const __m128 depth = _mm_add_ps(_mm_div_ps(depth_scale, d), depth_offset);
+
+        const __m128 px = _mm_mul_ps(_mm_loadu_ps(x_over_z + u), depth);
+        const __m128 py = _mm_mul_ps(y_over_z, depth);
+
+        _mm_storeu_ps(x + u, _mm_blendv_ps(px, invalid, invalid_mask));
+        _mm_storeu_ps(y + u, _mm_blendv_ps(py, invalid, invalid_mask));
+        _mm_storeu_ps(z + u, _mm_blendv_ps(depth, invalid, invalid_mask));
+    }
+
+    return u;
+}
+
+#endif
+
+template <typename T>
+void reprojectDisparityRowImpl(const T *disparity,
+                               size_t v,
+                               size_t width,
+                               const RayTableT &ray_table,
+                               float *x,
+                               float *y,
+                               float *z,
+                               SimdLevel level)
+{
+    size_t begin = 0;
+
+#if MULTISENSE_ROS_X86_SIMD
+    switch (level)
+    {
+        case SimdLevel::AVX2:
+            begin = reprojectDisparityRowAvx2(disparity, v, width, ray_table, x, y, z);
+            break;
+        case SimdLevel::SSE4:
+            begin = reprojectDisparityRowSse4(disparity, v, width, ray_table, x, y, z);
+            break;
+        case SimdLevel::SCALAR:
+            break;
+    }
+#else
+    (void) level;
+#endif
+
+    //
+    // Finish any columns which did not fill an entire vector
+
+    reprojectDisparityRowScalar(disparity, v, begin, width, ray_table, x, y, z);
+}
+
+//
+// Depth conversion kernels are specialized on which of the two depth images are requested so that unrequested
+// outputs cost nothing. Zero disparities (or negative floating point disparities) produce a NaN depth and a 0 OpenNI
+// depth. OpenNI depths are millimeters truncated and clamped to the range of a uint16_t
+
+template <typename T, bool Depth, bool NiDepth>
+void disparityToDepthScalar(const T *disparity,
+                            size_t begin,
+                            size_t end,
+                            float depth_scale,
+                            float *depth,
+                            uint16_t *ni_depth)
+{
+    const float bad_point = std::numeric_limits<float>::quiet_NaN();
+    const float max_ni_depth = static_cast<float>(std::numeric_limits<uint16_t>::max());
+
+    for (size_t i = begin ; i < end ; ++i)
+    {
+        const float d = static_cast<float>(disparity[i]);
+
+        if (d <= 0.0f)
+        {
+            if (Depth)
+            {
+                depth[i] = bad_point;
+            }
+
+            if (NiDepth)
+            {
+                ni_depth[i] = 0;
+            }
+
+            continue;
+        }
+
+        const float z = depth_scale / d;
+
+        if (Depth)
+        {
+            depth[i] = z;
+        }
+
+        if (NiDepth)
+        {
+            ni_depth[i] = static_cast<uint16_t>(std::min(max_ni_depth, std::max(0.0f, z * 1000.0f)));
+        }
+    }
+}
+
+#if MULTISENSE_ROS_X86_SIMD
+
+//
+// As with the reprojection kernels the vectorized depth kernels perform the same single precision operations as the
+// scalar kernel. _mm_max_ps returns its second operand for NaN inputs, matching std::max(0.0f, NaN)
+
+template <typename T, bool Depth, bool NiDepth>
+__attribute__((target("avx2")))
+size_t disparityToDepthAvx2(const T *disparity, size_t size, float depth_scale, float *depth, uint16_t *ni_depth)
+{
+    const __m256 bad_point = _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN());
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 scale = _mm256_set1_ps(depth_scale);
+    const __m256 millimeters = _mm256_set1_ps(1000.0f);
+    const __m256 max_ni_depth = _mm256_set1_ps(static_cast<float>(std::numeric_limits<uint16_t>::max()));
+
+    size_t i = 0;
+    for ( ; i + 8 <= size ; i += 8)
+    {
+        const __m256 d = loadDisparityAvx2(disparity + i);
+        const __m256 invalid_mask = _mm256_cmp_ps(d, zero, _CMP_LE_OQ);
+
+        const __m256 z = _mm256_div_ps(scale, d);
+
+        if (Depth)
+        {
+            _mm256_storeu_ps(depth + i, _mm256_blendv_ps(z, bad_point, invalid_mask));
+        }
+
+        if (NiDepth)
+        {
+            const __m256 mm = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(z, millimeters), zero), max_ni_depth);
+            const __m256i ni = _mm256_cvttps_epi32(_mm256_andnot_ps(invalid_mask, mm));
+
+            const __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(ni), _mm256_extracti128_si256(ni, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ni_depth + i), packed);
+        }
+    }
+
+    return i;
+}
+
+template <typename T, bool Depth, bool NiDepth>
+__attribute__((target("sse4.1")))
+size_t disparityToDepthSse4(const T *disparity, size_t size, float depth_scale, float *depth, uint16_t *ni_depth)
+{
+    const __m128 bad_point = _mm_set1_ps(std::numeric_limits<float>::quiet_NaN());
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 scale = _mm_set1_ps(depth_scale);
+    const __m128 millimeters = _mm_set1_ps(1000.0f);
+    const __m128 max_ni_depth = _mm_set1_ps(static_cast<float>(std::numeric_limits<uint16_t>::max()));
+
+    size_t i = 0;
+    for ( ; i + 4 <= size ; i += 4)
+    {
+        const __m128 d = loadDisparitySse4(disparity + i);
+        const __m128 invalid_mask = _mm_cmple_ps(d, zero);
+
+        const __m128 z = _mm_div_ps(scale, d);
+
+        if (Depth)
+        {
+            _mm_storeu_ps(depth + i, _mm_blendv_ps(z, bad_point, invalid_mask));
+        }
+
+        if (NiDepth)
+        {
+            const __m128 mm = _mm_min_ps(_mm_max_ps(_mm_mul_ps(z, millimeters), zero), max_ni_depth);
+            const __m128i ni = _mm_cvttps_epi32(_mm_andnot_ps(invalid_mask, mm));
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(ni_depth + i), _mm_packus_epi32(ni, ni));
+        }
+    }
+
+    return i;
+}
+
+#endif
+
+template <typename T, bool Depth, bool NiDepth>
+void disparityToDepthImpl(const T *disparity,
+                          size_t size,
+                          float depth_scale,
+                          float *depth,
+                          uint16_t *ni_depth,
+                          SimdLevel level)
+{
+    size_t begin = 0;
+
+#if MULTISENSE_ROS_X86_SIMD
+    switch (level)
+    {
+        case SimdLevel::AVX2:
+            begin = disparityToDepthAvx2<T, Depth, NiDepth>(disparity, size, depth_scale, depth, ni_depth);
+            break;
+        case SimdLevel::SSE4:
+            begin = disparityToDepthSse4<T, Depth, NiDepth>(disparity, size, depth_scale, depth, ni_depth);
+            break;
+        case SimdLevel::SCALAR:
+            break;
+    }
+#else
+    (void) level;
+#endif
+
+    disparityToDepthScalar<T, Depth, NiDepth>(disparity, begin, size, depth_scale, depth, ni_depth);
+}
+
+template <typename T>
+void disparityToDepthImpl(const T *disparity,
+                          size_t size,
+                          const RayTableT &ray_table,
+                          float *depth,
+                          uint16_t *ni_depth,
+                          SimdLevel level)
+{
+    //
+    // Depth = focal_length*baseline/disparity
+    // From the Q matrix used to reproject disparity images using non-isotropic
+    // pixels we see that z = (fx*fy*Tx). Normalizing z so that
+    // the scale factor on the homogeneous Cartesian coordinate is 1 results
+    // in z =  (fx*fy*Tx)/(-fy*d) or z = (fx*Tx)/(-d). 16 bit disparities are
+    // in 1/16th pixel so we must also divide by 16 making z = (fx*Tx*16)/(-d)
+    // The 4th element of the right camera projection matrix is defined
+    // as fx*Tx. The ray table caches the depth scale -fx*Tx.
+
+    const float depth_scale = ray_table.depth_scale * disparityScale<T>();
+
+    if (depth && ni_depth)
+    {
+        disparityToDepthImpl<T, true, true>(disparity, size, depth_scale, depth, ni_depth, level);
+    }
+    else if (depth)
+    {
+        disparityToDepthImpl<T, true, false>(disparity, size, depth_scale, depth, ni_depth, level);
+    }
+    else if (ni_depth)
+    {
+        disparityToDepthImpl<T, false, true>(disparity, size, depth_scale, depth, ni_depth, level);
+    }
+}
+
+//
+// 16 bit disparities only have RayTableT::DISPARITY_LUT_SIZE distinct values, so their depths are looked up in the
+// tables of the ray table, which are built with disparityToDepthScalar, instead of divided per pixel
+
+template <bool Depth, bool NiDepth>
+void disparityToDepthLutScalar(const uint16_t *disparity,
+                               size_t begin,
+                               size_t end,
+                               const RayTableT &ray_table,
+                               float *depth,
+                               uint16_t *ni_depth)
+{
+    const float *depth_lut = ray_table.depth_lut.data();
+    const uint16_t *ni_depth_lut = ray_table.ni_depth_lut.data();
+
+    for (size_t i = begin ; i < end ; ++i)
+    {
+        if (Depth)
+        {
+            depth[i] = depth_lut[disparity[i]];
+        }
+
+        if (NiDepth)
+        {
+            ni_depth[i] = ni_depth_lut[disparity[i]];
+        }
+    }
+}
+
+#if MULTISENSE_ROS_X86_SIMD
+
+//
+// Gathers the depths and recomputes the OpenNI depths from them with the operations of disparityToDepthScalar, which
+// avoids a second 16 bit gather. NaN depths of zero disparities become 0 through _mm256_max_ps
+
+template <bool Depth, bool NiDepth>
+__attribute__((target("avx2")))
+size_t disparityToDepthLutAvx2(const uint16_t *disparity,
+                               size_t size,
+                               const RayTableT &ray_table,
+                               float *depth,
+                               uint16_t *ni_depth)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 millimeters = _mm256_set1_ps(1000.0f);
+    const __m256 max_ni_depth = _mm256_set1_ps(static_cast<float>(std::numeric_limits<uint16_t>::max()));
+    const float *depth_lut = ray_table.depth_lut.data();
+
+    size_t i = 0;
+    for ( ; i + 8 <= size ; i += 8)
+    {
+        const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(disparity + i));
+        const __m256 z = _mm256_i32gather_ps(depth_lut, _mm256_cvtepu16_epi32(raw), sizeof(float));
+
+        if (Depth)
+        {
+            _mm256_storeu_ps(depth + i, z);
+        }
+
+        if (NiDepth)
+        {
+            const __m256 mm = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(z, millimeters), zero), max_ni_depth);
+            const __m256i ni = _mm256_cvttps_epi32(mm);
+
+            const __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(ni), _mm256_extracti128_si256(ni, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ni_depth + i), packed);
+        }
+    }
+
+    return i;
+}
+
+#endif
+
+template <bool Depth, bool NiDepth>
+void disparityToDepthLut(const uint16_t *disparity,
+                         size_t size,
+                         const RayTableT &ray_table,
+                         float *depth,
+                         uint16_t *ni_depth,
+                         SimdLevel level)
+{
+    size_t begin = 0;
+
+    //
+    // SSE4 has no gather instruction, so it uses the scalar lookup
+
+#if MULTISENSE_ROS_X86_SIMD
+    if (SimdLevel::AVX2 == level)
+    {
+        begin = disparityToDepthLutAvx2<Depth, NiDepth>(disparity, size, ray_table, depth, ni_depth);
+    }
+#else
+    (void) level;
+#endif
+
+    disparityToDepthLutScalar<Depth, NiDepth>(disparity, begin, size, ray_table, depth, ni_depth);
+}
+
+void disparityToDepthImpl(const uint16_t *disparity,
+                          size_t size,
+                          const RayTableT &ray_table,
+                          float *depth,
+                          uint16_t *ni_depth,
+                          SimdLevel level)
+{
+    if (depth && ni_depth)
+    {
+        disparityToDepthLut<true, true>(disparity, size, ray_table, depth, ni_depth, level);
+    }
+    else if (depth)
+    {
+        disparityToDepthLut<true, false>(disparity, size, ray_table, depth, ni_depth, level);
+    }
+    else if (ni_depth)
+    {
+        disparityToDepthLut<false, true>(disparity, size, ray_table, depth, ni_depth, level);
+    }
+}
+
+void disparityToFloatScalar(const uint16_t *disparity, size_t begin, size_t end, float *output)
+{
+    const float scale = 1.0f / disparityScale<uint16_t>();
+
+    for (size_t i = begin ; i < end ; ++i)
+    {
+        output[i] = static_cast<float>(disparity[i]) * scale;
+    }
+}
+
+#if MULTISENSE_ROS_X86_SIMD
+
+//
+// Scaling by 1/16 is exact in single precision, so every implementation matches a division by 16
+
+__attribute__((target("avx2")))
+size_t disparityToFloatAvx2(const uint16_t *disparity, size_t size, float *output)
 {
-    const auto crop = config.camMode() == 2000 &&
-                      (device_info.imagerType == crl::multisense::system::DeviceInfo::IMAGER_TYPE_CMV4000_GREY ||
-                      device_info.imagerType == crl::multisense::system::DeviceInfo::IMAGER_TYPE_CMV4000_COLOR);
+    const __m256 scale = _mm256_set1_ps(1.0f / disparityScale<uint16_t>());
 
-    // crop mode causes the imager to behave completely like a CMV2000, but the device info imager height does not get modified
-    const auto imagerHeight = crop ? 1088 : device_info.imagerHeight;
+    size_t i = 0;
+    for ( ; i + 8 <= size ; i += 8)
+    {
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(loadDisparityAvx2(disparity + i), scale));
+    }
 
-    const double x_scale = 1.0 / ((static_cast<double>(device_info.imagerWidth) /
-                                   static_cast<double>(config.width())));
+    return i;
+}
 
-    const double y_scale = 1.0 / ((static_cast<double>(imagerHeight) /
-                                   static_cast<double>(config.height())));
+__attribute__((target("sse4.1")))
+size_t disparityToFloatSse4(const uint16_t *disparity, size_t size, float *output)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / disparityScale<uint16_t>());
 
-    //
-    // In crop mode we want to offset our cx/cy values
-    // by the current crop offset. This is because the pixel size does not change in crop mode, and instead a cropped
-    // region of the original image is returned
+    size_t i = 0;
+    for ( ; i + 4 <= size ; i += 4)
+    {
+        _mm_storeu_ps(output + i, _mm_mul_ps(loadDisparitySse4(disparity + i), scale));
+    }
 
-    return ScaleT{x_scale,
-                  y_scale,
-                  0.0,
-                  crop ? -config.offset()*y_scale : 0.0};
+    return i;
 }
 
-}// namespace
+#endif
 
-void ycbcrToBgr(const crl::multisense::image::Header &luma,
-                const crl::multisense::image::Header &chroma,
-                uint8_t *output)
+//
+// Aux color sampling. Projected coordinates are clamped to the image with comparisons which map NaN to 0, matching
+// _mm256_max_ps, so invalid points can never sample outside of the image
+
+inline float clampCoordinate(float value, float max_value)
+{
+    value = value > 0.0f ? value : 0.0f;
+    return value < max_value ? value : max_value;
+}
+
+inline float bilinearChannel(float p00, float p01, float p10, float p11, float wx, float wy)
 {
-    const size_t rgb_stride = luma.width * 3;
+    const float top = p00 + wx * (p01 - p00);
+    const float bottom = p10 + wx * (p11 - p10);
 
-    for(uint32_t y=0; y< luma.height; ++y)
+    return top + wy * (bottom - top);
+}
+
+void auxColorRowScalar(const AuxProjectionTableT &table,
+                       size_t v,
+                       size_t begin,
+                       size_t end,
+                       const float *z,
+                       const cv::Mat &image,
+                       uint32_t *colors)
+{
+    const int width = image.cols;
+    const float max_u = static_cast<float>(image.cols - 1);
+    const float max_v = static_cast<float>(image.rows - 1);
+    const float v_scale = table.v_scale[v];
+    const uint8_t *pixels = image.data;
+
+    for (size_t u = begin ; u < end ; ++u)
     {
-        const size_t row_offset = y * rgb_stride;
+        const float inverse = 1.0f / (z[u] + table.z_offset);
+        const float pu = (table.u_scale[u] * z[u] + table.u_offset) * inverse;
+        const float pv = (v_scale * z[u] + table.v_offset) * inverse;
+
+        const float floor_u = std::floor(pu);
+        const float floor_v = std::floor(pv);
+
+        const float x0 = clampCoordinate(floor_u, max_u);
+        const float x1 = clampCoordinate(floor_u + 1.0f, max_u);
+        const float y0 = clampCoordinate(floor_v, max_v);
+        const float y1 = clampCoordinate(floor_v + 1.0f, max_v);
+
+        const float wx = x0 != x1 ? pu - floor_u : 0.0f;
+        const float wy = y0 != y1 ? pv - floor_v : 0.0f;
+
+        const uint8_t *p00 = pixels + 3 * (static_cast<int>(y0) * width + static_cast<int>(x0));
+        const uint8_t *p01 = pixels + 3 * (static_cast<int>(y0) * width + static_cast<int>(x1));
+        const uint8_t *p10 = pixels + 3 * (static_cast<int>(y1) * width + static_cast<int>(x0));
+        const uint8_t *p11 = pixels + 3 * (static_cast<int>(y1) * width + static_cast<int>(x1));
 
-        for(uint32_t x=0; x< luma.width; ++x)
+        uint32_t color = 0;
+        for (size_t c = 0 ; c < 3 ; ++c)
         {
-            memcpy(output + row_offset + (3 * x), ycbcrToBgr<uint8_t>(luma, chroma, x, y).data(), 3);
+            const float value = bilinearChannel(p00[c], p01[c], p10[c], p11[c], wx, wy);
+            color |= static_cast<uint32_t>(value + 0.5f) << (8 * c);
         }
+
+        colors[u] = color;
     }
 }
 
-Eigen::Matrix4d makeQ(const crl::multisense::image::Config& config,
-                      const crl::multisense::image::Calibration& calibration,
-                      const crl::multisense::system::DeviceInfo& device_info)
-{
-    Eigen::Matrix4d q_matrix = Eigen::Matrix4d::Zero();
+#if MULTISENSE_ROS_X86_SIMD
 
-    const auto scale = compute_scale(config, device_info);
+//
+// Gather the 3 byte pixels at the given pixel indices into the low bytes of 32 bit lanes. Gathers near the end of
+// the image are moved back so they never read past the last byte, and shifted to compensate
 
-    //
-    // Compute the Q matrix here, as image_geometery::StereoCameraModel does
-    // not allow for non-square pixels.
-    //
-    //  FyTx    0     0    -FyCxTx
-    //   0     FxTx   0    -FxCyTx
-    //   0      0     0     FxFyTx
-    //   0      0    -Fy    Fy(Cx - Cx')
-    //
-    const auto fx = calibration.left.P[0][0] * scale.x_scale;
-    const auto cx = calibration.left.P[0][2] * scale.x_scale + scale.cx_offset;
-    const auto fy = calibration.left.P[1][1] * scale.y_scale;
-    const auto cy = calibration.left.P[1][2] * scale.y_scale + scale.cy_offset;
-    const auto tx = calibration.right.P[0][3] / calibration.right.P[0][0];
-    const auto cx_prime = calibration.left.P[0][2] * scale.x_scale + scale.cx_offset;
+__attribute__((target("avx2")))
+inline __m256i gatherPixelsAvx2(const uint8_t *pixels, __m256i index, __m256i last_offset)
+{
+    const __m256i offset = _mm256_add_epi32(index, _mm256_add_epi32(index, index));
+    const __m256i clamped_offset = _mm256_min_epi32(offset, last_offset);
 
-    q_matrix(0,0) =  fy * tx;
-    q_matrix(1,1) =  fx * tx;
-    q_matrix(0,3) = -fy * cx * tx;
-    q_matrix(1,3) = -fx * cy * tx;
-    q_matrix(2,3) =  fx * fy * tx;
-    q_matrix(3,2) = -fy;
-    q_matrix(3,3) =  fy * (cx - cx_prime);
+    const __m256i gathered = _mm256_i32gather_epi32(reinterpret_cast<const int*>(pixels), clamped_offset, 1);
 
-    return q_matrix;
+    return _mm256_srlv_epi32(gathered, _mm256_slli_epi32(_mm256_sub_epi32(offset, clamped_offset), 3));
 }
 
-sensor_msgs::CameraInfo makeCameraInfo(const crl::multisense::image::Config& config,
-                                       const crl::multisense::image::Calibration::Data& calibration,
-                                       const ScaleT &scale)
+__attribute__((target("avx2")))
+inline __m256 channelAvx2(__m256i pixels, int shift)
 {
-    sensor_msgs::CameraInfo camera_info;
+    return _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(pixels, shift), _mm256_set1_epi32(0xff)));
+}
 
-    camera_info.width = config.width();
-    camera_info.height = config.height();
+__attribute__((target("avx2")))
+inline __m256i bilinearChannelAvx2(__m256i p00, __m256i p01, __m256i p10, __m256i p11, int shift, __m256 wx, __m256 wy)
+{
+    const __m256 c00 = channelAvx2(p00, shift);
+    const __m256 c10 = channelAvx2(p10, shift);
 
-    camera_info.P[0] = calibration.P[0][0] * scale.x_scale;
-    camera_info.P[1] = calibration.P[0][1];
-    camera_info.P[2] = calibration.P[0][2] * scale.x_scale + scale.cx_offset;
-    camera_info.P[3] = calibration.P[0][3] * scale.x_scale;
-    camera_info.P[4] = calibration.P[1][0];
-    camera_info.P[5] = calibration.P[1][1] * scale.y_scale;
-    camera_info.P[6] = calibration.P[1][2] * scale.y_scale + scale.cy_offset;
-    camera_info.P[7] = calibration.P[1][3];
-    camera_info.P[8] = calibration.P[2][0];
-    camera_info.P[9] = calibration.P[2][1];
-    camera_info.P[10] = calibration.P[2][2];
-    camera_info.P[11] = calibration.P[2][3];
+    const __m256 top = _mm256_add_ps(c00, _mm256_mul_ps(wx, _mm256_sub_ps(channelAvx2(p01, shift), c00)));
+    const __m256 bottom = _mm256_add_ps(c10, _mm256_mul_ps(wx, _mm256_sub_ps(channelAvx2(p11, shift), c10)));
 
-    camera_info.K[0] = calibration.M[0][0] * scale.x_scale;
-    camera_info.K[1] = calibration.M[0][1];
-    camera_info.K[2] = calibration.M[0][2] * scale.x_scale + scale.cx_offset;
-    camera_info.K[3] = calibration.M[1][0];
-    camera_info.K[4] = calibration.M[1][1] * scale.y_scale;
-    camera_info.K[5] = calibration.M[1][2] * scale.y_scale + scale.cy_offset;
-    camera_info.K[6] = calibration.M[2][0];
-    camera_info.K[7] = calibration.M[2][1];
-    camera_info.K[8] = calibration.M[2][2];
+    const __m256 value = _mm256_add_ps(top, _mm256_mul_ps(wy, _mm256_sub_ps(bottom, top)));
 
-    camera_info.R[0] = calibration.R[0][0];
-    camera_info.R[1] = calibration.R[0][1];
-    camera_info.R[2] = calibration.R[0][2];
-    camera_info.R[3] = calibration.R[1][0];
-    camera_info.R[4] = calibration.R[1][1];
-    camera_info.R[5] = calibration.R[1][2];
-    camera_info.R[6] = calibration.R[2][0];
-    camera_info.R[7] = calibration.R[2][1];
-    camera_info.R[8] = calibration.R[2][2];
+    return _mm256_slli_epi32(_mm256_cvttps_epi32(_mm256_add_ps(value, _mm256_set1_ps(0.5f))), shift);
+}
 
-    //
-    // Distortion coefficients follow OpenCV's convention.
-    // k1, k2, p1, p2, k3, k4, k5, k6
+//
+// Performs the same single precision operations as auxColorRowScalar, so both produce identical colors
 
-    camera_info.D.resize(8);
-    for (size_t i=0 ; i < 8 ; ++i)
+__attribute__((target("avx2")))
+size_t auxColorRowAvx2(const AuxProjectionTableT &table,
+                       size_t v,
+                       size_t width,
+                       const float *z,
+                       const cv::Mat &image,
+                       uint32_t *colors)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 max_u = _mm256_set1_ps(static_cast<float>(image.cols - 1));
+    const __m256 max_v = _mm256_set1_ps(static_cast<float>(image.rows - 1));
+    const __m256 v_scale = _mm256_set1_ps(table.v_scale[v]);
+    const __m256 u_offset = _mm256_set1_ps(table.u_offset);
+    const __m256 v_offset = _mm256_set1_ps(table.v_offset);
+    const __m256 z_offset = _mm256_set1_ps(table.z_offset);
+    const __m256i image_width = _mm256_set1_epi32(image.cols);
+    const __m256i last_offset = _mm256_set1_epi32(3 * image.cols * image.rows - 4);
+
+    const float *u_scale = table.u_scale.data();
+    const uint8_t *pixels = image.data;
+
+    size_t u = 0;
+    for ( ; u + 8 <= width ; u += 8)
     {
-        camera_info.D[i] = calibration.D[i];
+        const __m256 depth = _mm256_loadu_ps(z + u);
+        const __m256 inverse = _mm256_div_ps(one, _mm256_add_ps(depth, z_offset));
+
+        const __m256 pu = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(u_scale + u), depth), u_offset),
+                                        inverse);
+        const __m256 pv = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(v_scale, depth), v_offset), inverse);
+
+        const __m256 floor_u = _mm256_floor_ps(pu);
+        const __m256 floor_v = _mm256_floor_ps(pv);
+
+        const __m256 x0 = _mm256_min_ps(_mm256_max_ps(floor_u, zero), max_u);
+        const __m256 x1 = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(floor_u, one), zero), max_u);
+        const __m256 y0 = _mm256_min_ps(_mm256_max_ps(floor_v, zero), max_v);
+        const __m256 y1 = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(floor_v, one), zero), max_v);
+
+        const __m256 wx = _mm256_and_ps(_mm256_cmp_ps(x0, x1, _CMP_NEQ_UQ), _mm256_sub_ps(pu, floor_u));
+        const __m256 wy = _mm256_and_ps(_mm256_cmp_ps(y0, y1, _CMP_NEQ_UQ), _mm256_sub_ps(pv, floor_v));
+
+        const __m256i x0i = _mm256_cvttps_epi32(x0);
+        const __m256i x1i = _mm256_cvttps_epi32(x1);
+        const __m256i row0 = _mm256_mullo_epi32(_mm256_cvttps_epi32(y0), image_width);
+        const __m256i row1 = _mm256_mullo_epi32(_mm256_cvttps_epi32(y1), image_width);
+
+        const __m256i p00 = gatherPixelsAvx2(pixels, _mm256_add_epi32(row0, x0i), last_offset);
+        const __m256i p01 = gatherPixelsAvx2(pixels, _mm256_add_epi32(row0, x1i), last_offset);
+        const __m256i p10 = gatherPixelsAvx2(pixels, _mm256_add_epi32(row1, x0i), last_offset);
+        const __m256i p11 = gatherPixelsAvx2(pixels, _mm256_add_epi32(row1, x1i), last_offset);
+
+        const __m256i color = _mm256_or_si256(_mm256_or_si256(bilinearChannelAvx2(p00, p01, p10, p11, 0, wx, wy),
+                                                              bilinearChannelAvx2(p00, p01, p10, p11, 8, wx, wy)),
+                                              bilinearChannelAvx2(p00, p01, p10, p11, 16, wx, wy));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(colors + u), color);
     }
 
-    //
-    // MultiSense cameras support both the full 8 parameter rational_polynomial
-    // model and the simplified 5 parameter plum_bob model. If the last 3
-    // parameters of the distortion model are 0 then the camera is using
-    // the simplified plumb_bob model
+    return u;
+}
 
-    if (calibration.D[7] == 0.0 && calibration.D[6] == 0.0 && calibration.D[5] == 0.0)
+#endif
+
+}// namespace
+
+constexpr size_t RayTableT::DISPARITY_LUT_SIZE;
+
+RayTableT makeRayTable(const sensor_msgs::CameraInfo &left_camera_info,
+                       const sensor_msgs::CameraInfo &right_camera_info)
+{
+    const double &fx = left_camera_info.P[0];
+    const double &fy = left_camera_info.P[5];
+    const double &cx = left_camera_info.P[2];
+    const double &cy = left_camera_info.P[6];
+    const double &cx_right = right_camera_info.P[2];
+    const double tx = right_camera_info.P[3] / right_camera_info.P[0];
+
+    RayTableT ray_table;
+    ray_table.resolution = OperatingResolutionT{left_camera_info.width, left_camera_info.height};
+
+    ray_table.x_over_z.resize(left_camera_info.width);
+    for (size_t u = 0 ; u < left_camera_info.width ; ++u)
     {
-        camera_info.distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
+        ray_table.x_over_z[u] = static_cast<float>((static_cast<double>(u) - cx) / fx);
     }
-    else
+
+    ray_table.y_over_z.resize(left_camera_info.height);
+    for (size_t v = 0 ; v < left_camera_info.height ; ++v)
     {
-        camera_info.distortion_model = sensor_msgs::distortion_models::RATIONAL_POLYNOMIAL;
+        ray_table.y_over_z[v] = static_cast<float>((static_cast<double>(v) - cy) / fy);
     }
 
-    return camera_info;
+    //
+    // Expanding z = (fx * fy * tx) * (1 / (-fy * d) + fy * (cx - cx_right)) as computed in
+    // StereoCalibrationManger::reproject. The depth offset is zero unless the rectified principal points differ
+
+    ray_table.depth_scale = static_cast<float>(-fx * tx);
+    ray_table.depth_offset = static_cast<float>(fx * fy * fy * tx * (cx - cx_right));
+
+    std::vector<uint16_t> disparities(RayTableT::DISPARITY_LUT_SIZE);
+    std::iota(disparities.begin(), disparities.end(), 0);
+
+    ray_table.depth_lut.resize(RayTableT::DISPARITY_LUT_SIZE);
+    ray_table.ni_depth_lut.resize(RayTableT::DISPARITY_LUT_SIZE);
+
+    disparityToDepthScalar<uint16_t, true, true>(disparities.data(),
+                                                 0,
+                                                 disparities.size(),
+                                                 ray_table.depth_scale * disparityScale<uint16_t>(),
+                                                 ray_table.depth_lut.data(),
+                                                 ray_table.ni_depth_lut.data());
+
+    return ray_table;
 }
 
-RectificationRemapT makeRectificationRemap(const crl::multisense::image::Config& config,
-                                           const crl::multisense::image::Calibration::Data& calibration,
-                                           const crl::multisense::system::DeviceInfo& device_info)
+void reprojectDisparityRow(const uint16_t *disparity,
+                           size_t v,
+                           size_t width,
+                           const RayTableT &ray_table,
+                           float *x,
+                           float *y,
+                           float *z,
+                           SimdLevel level)
 {
-    RectificationRemapT remap;
+    reprojectDisparityRowImpl(disparity, v, width, ray_table, x, y, z, level);
+}
 
-    const auto scale = compute_scale(config, device_info);
+void reprojectDisparityRow(const float *disparity,
+                           size_t v,
+                           size_t width,
+                           const RayTableT &ray_table,
+                           float *x,
+                           float *y,
+                           float *z,
+                           SimdLevel level)
+{
+    reprojectDisparityRowImpl(disparity, v, width, ray_table, x, y, z, level);
+}
 
-    const cv::Matx33d K(calibration.M[0][0] * scale.x_scale,
-                        calibration.M[0][1],
-                        calibration.M[0][2] * scale.x_scale + scale.cx_offset,
-                        calibration.M[1][0],
-                        calibration.M[1][1] * scale.y_scale,
-                        calibration.M[1][2] * scale.y_scale + scale.cy_offset,
-                        calibration.M[2][0],
-                        calibration.M[2][1],
-                        calibration.M[2][2]);
+bool disparityToDepth(const crl::multisense::image::Header &disparity,
+                      const RayTableT &ray_table,
+                      float *depth,
+                      uint16_t *ni_depth,
+                      SimdLevel level)
+{
+    const size_t image_size = static_cast<size_t>(disparity.width) * disparity.height;
 
-    const cv::Matx33d R(calibration.R[0][0],
-                        calibration.R[0][1],
-                        calibration.R[0][2],
-                        calibration.R[1][0],
-                        calibration.R[1][1],
-                        calibration.R[1][2],
-                        calibration.R[2][0],
-                        calibration.R[2][1],
-                        calibration.R[2][2]);
+    //
+    // Disparity is in 32-bit floating point
 
-    const cv::Matx34d P(calibration.P[0][0] * scale.x_scale,
-                        calibration.P[0][1],
-                        calibration.P[0][2] * scale.x_scale + scale.cx_offset,
-                        calibration.P[0][3] * scale.x_scale,
-                        calibration.P[1][0],
-                        calibration.P[1][1] * scale.y_scale,
-                        calibration.P[1][2] * scale.y_scale + scale.cy_offset,
-                        calibration.P[1][3],
-                        calibration.P[2][0],
-                        calibration.P[2][1],
-                        calibration.P[2][2],
-                        calibration.P[2][3]);
+    if (32 == disparity.bitsPerPixel) {
 
-    const bool plumbob = calibration.D[7] == 0.0 && calibration.D[6] == 0.0 && calibration.D[5] == 0.0;
+        disparityToDepthImpl(reinterpret_cast<const float*>(disparity.imageDataP),
+                             image_size,
+                             ray_table,
+                             depth,
+                             ni_depth,
+                             level);
+        return true;
+    }
 
-    cv::Mat D(plumbob ? 5 : 8, 1, CV_64FC1);
-    for (int i = 0; i < D.rows ; ++i)
+    //
+    // Disparity is in 1/16th pixel, unsigned integer
+
+    if (16 == disparity.bitsPerPixel) {
+
+        disparityToDepthImpl(reinterpret_cast<const uint16_t*>(disparity.imageDataP),
+                             image_size,
+                             ray_table,
+                             depth,
+                             ni_depth,
+                             level);
+        return true;
+    }
+
+    return false;
+}
+
+void disparityToFloat(const uint16_t *disparity, size_t size, float *output, SimdLevel level)
+{
+    size_t begin = 0;
+
+#if MULTISENSE_ROS_X86_SIMD
+    switch (level)
     {
-        D.at<double>(i) = calibration.D[i];
+        case SimdLevel::AVX2:
+            begin = disparityToFloatAvx2(disparity, size, output);
+            break;
+        case SimdLevel::SSE4:
+            begin = disparityToFloatSse4(disparity, size, output);
+            break;
+        case SimdLevel::SCALAR:
+            break;
     }
+#else
+    (void) level;
+#endif
 
-    cv::initUndistortRectifyMap(K, D, R, P, cv::Size(config.width(), config.height()), CV_32FC1, remap.map1, remap.map2);
+    disparityToFloatScalar(disparity, begin, size, output);
+}
 
-    return remap;
+AuxProjectionTableT makeAuxProjectionTable(const RayTableT &ray_table,
+                                           const sensor_msgs::CameraInfo &aux_camera_info)
+{
+    const double &fx = aux_camera_info.P[0];
+    const double &fy = aux_camera_info.P[5];
+    const double &cx = aux_camera_info.P[2];
+    const double &cy = aux_camera_info.P[6];
+    const double &fxtx = aux_camera_info.P[3];
+    const double &fyty = aux_camera_info.P[7];
+    const double &tz = aux_camera_info.P[11];
+
+    AuxProjectionTableT table;
+    table.resolution = ray_table.resolution;
+
+    table.u_scale.resize(ray_table.x_over_z.size());
+    for (size_t u = 0 ; u < ray_table.x_over_z.size() ; ++u)
+    {
+        table.u_scale[u] = static_cast<float>(fx * ray_table.x_over_z[u] + cx);
+    }
+
+    table.v_scale.resize(ray_table.y_over_z.size());
+    for (size_t v = 0 ; v < ray_table.y_over_z.size() ; ++v)
+    {
+        table.v_scale[v] = static_cast<float>(fy * ray_table.y_over_z[v] + cy);
+    }
+
+    table.u_offset = static_cast<float>(fxtx);
+    table.v_offset = static_cast<float>(fyty);
+    table.z_offset = static_cast<float>(tz);
+
+    return table;
+}
+
+void auxColorRow(const AuxProjectionTableT &table,
+                 size_t v,
+                 size_t width,
+                 const float *z,
+                 const cv::Mat &image,
+                 uint32_t *colors,
+                 SimdLevel level)
+{
+    size_t begin = 0;
+
+#if MULTISENSE_ROS_X86_SIMD
+    //
+    // SSE4 has no gather instruction, so it uses the scalar kernel. The AVX2 gathers load 4 bytes per pixel, which
+    // needs an image of at least 4 bytes
+
+    if (SimdLevel::AVX2 == level && image.cols * image.rows >= 2)
+    {
+        begin = auxColorRowAvx2(table, v, width, z, image, colors);
+    }
+#else
+    (void) level;
+#endif
+
+    auxColorRowScalar(table, v, begin, width, z, image, colors);
 }
 
 StereoCalibrationManger::StereoCalibrationManger(const crl::multisense::image::Config& config,
@@ -265,17 +1784,21 @@ StereoCalibrationManger::StereoCalibrationManger(const crl::multisense::image::C
     right_camera_info_(makeCameraInfo(config_, calibration_.right, compute_scale(config_, device_info_))),
     aux_camera_info_(makeCameraInfo(config_, calibration_.aux, config_.cameraProfile() == crl::multisense::Full_Res_Aux_Cam ?
                                                                ScaleT{1., 1., 0., 0.} : compute_scale(config_, device_info_))),
-    left_remap_(std::make_shared<RectificationRemapT>(makeRectificationRemap(config_, calibration_.left, device_info_))),
-    right_remap_(std::make_shared<RectificationRemapT>(makeRectificationRemap(config_, calibration_.right, device_info_)))
+    remap_cache_(new RectificationRemapCache(calibration_, device_info_)),
+    remaps_(remap_cache_->build(config_)),
+    ray_table_(std::make_shared<const RayTableT>(makeRayTable(left_camera_info_, right_camera_info_))),
+    aux_projection_table_(std::make_shared<const AuxProjectionTableT>(makeAuxProjectionTable(*ray_table_,
+                                                                                             aux_camera_info_)))
 {
 }
 
 void StereoCalibrationManger::updateConfig(const crl::multisense::image::Config& config)
 {
     //
-    // Only update the calibration if the resolution changed.
+    // Only update the calibration if the resolution or crop offset changed.
 
-    if (config_.width() == config.width() && config_.height() == config.height() && config_.cameraProfile() == config.cameraProfile())
+    if (config_.width() == config.width() && config_.height() == config.height() &&
+        config_.cameraProfile() == config.cameraProfile() && config_.offset() == config.offset())
     {
         std::lock_guard<std::mutex> lock(mutex_);
         config_ = config;
@@ -290,8 +1813,15 @@ void StereoCalibrationManger::updateConfig(const crl::multisense::image::Config&
                              ScaleT{1., 1., 0., 0.} : compute_scale(config, device_info_);
 
     auto aux_camera_info = makeCameraInfo(config, calibration_.aux, aux_scale);
-    auto left_remap = std::make_shared<RectificationRemapT>(makeRectificationRemap(config, calibration_.left, device_info_));
-    auto right_remap = std::make_shared<RectificationRemapT>(makeRectificationRemap(config, calibration_.right, device_info_));
+    auto remaps = remap_cache_->get(config);
+    auto ray_table = std::make_shared<const RayTableT>(makeRayTable(left_camera_info, right_camera_info));
+    auto aux_projection_table = std::make_shared<const AuxProjectionTableT>(makeAuxProjectionTable(*ray_table,
+                                                                                                   aux_camera_info));
+
+    //
+    // Only swap pointers while holding the lock. Callbacks which already hold the previous remaps and ray table
+    // continue to use them until they release them. If the remaps for the new config are not cached they are empty
+    // until the background build completes
 
     std::lock_guard<std::mutex> lock(mutex_);
 
@@ -300,8 +1830,9 @@ void StereoCalibrationManger::updateConfig(const crl::multisense::image::Config&
     left_camera_info_ = std::move(left_camera_info);
     right_camera_info_ = std::move(right_camera_info);
     aux_camera_info_ = std::move(aux_camera_info);
-    left_remap_ = left_remap;
-    right_remap_ = right_remap;
+    remaps_ = std::move(remaps);
+    ray_table_ = ray_table;
+    aux_projection_table_ = aux_projection_table;
 }
 
 crl::multisense::image::Config StereoCalibrationManger::config() const
@@ -491,17 +2022,39 @@ sensor_msgs::CameraInfo StereoCalibrationManger::auxCameraInfo(const std::string
 }
 
 std::shared_ptr<RectificationRemapT> StereoCalibrationManger::leftRemap() const
+{
+    return remaps().left;
+}
+
+std::shared_ptr<RectificationRemapT> StereoCalibrationManger::rightRemap() const
+{
+    return remaps().right;
+}
+
+StereoRectificationRemapT StereoCalibrationManger::remaps() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!remaps_.left || !remaps_.right)
+    {
+        remaps_ = remap_cache_->get(config_);
+    }
+
+    return remaps_;
+}
+
+std::shared_ptr<const RayTableT> StereoCalibrationManger::rayTable() const
 {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    return left_remap_;
+    return ray_table_;
 }
 
-std::shared_ptr<RectificationRemapT> StereoCalibrationManger::rightRemap() const
+std::shared_ptr<const AuxProjectionTableT> StereoCalibrationManger::auxProjectionTable() const
 {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    return right_remap_;
+    return aux_projection_table_;
 }
 
 }// namespace
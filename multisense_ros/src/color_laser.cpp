@@ -31,22 +31,17 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **/
 
+#include <cstring>
 #include <functional>
 
+#include <boost/make_shared.hpp>
+
 #include <multisense_ros/color_laser.h>
 #include <multisense_ros/point_cloud_utilities.h>
 
-//
-// Anonymous namespace for locally scoped symbols
-namespace {
-
-    const uint32_t laser_cloud_step = 16;
-
-} // namespace
-
 namespace multisense_ros {
 
-ColorLaser::ColorLaser(ros::NodeHandle& nh, const std::string &tf_prefix):
+ColorLaser::ColorLaser(ros::NodeHandle& nh, const std::string &tf_prefix, PointLayout point_layout):
     node_handle_(nh),
     image_channels_(3),
     tf_prefix_(tf_prefix)
@@ -54,7 +49,7 @@ ColorLaser::ColorLaser(ros::NodeHandle& nh, const std::string &tf_prefix):
     //
     // Initialize point cloud structure
 
-    color_laser_pointcloud_ = initialize_pointcloud<float>(true, "/left_camera_optical_frame", "rgb");
+    color_laser_pointcloud_ = initialize_pointcloud(point_layout, true, "/left_camera_optical_frame", {"rgb"});
 
     color_laser_publisher_ = nh.advertise<sensor_msgs::PointCloud2>("lidar_points2_color",
                                                                    10,
@@ -79,7 +74,7 @@ void ColorLaser::colorImageCallback(
         ROS_ERROR("Unsupported number of color channels: %d", image_channels_);
     }
 
-    color_image_ = *message;
+    color_image_ = message;
 }
 
 void ColorLaser::cameraInfoCallback(
@@ -92,7 +87,7 @@ void ColorLaser::cameraInfoCallback(
 }
 
 void ColorLaser::laserPointCloudCallback(
-    sensor_msgs::PointCloud2::Ptr message
+    const sensor_msgs::PointCloud2::ConstPtr& message
 )
 {
     std::lock_guard<std::mutex> lock(data_lock_);
@@ -101,20 +96,31 @@ void ColorLaser::laserPointCloudCallback(
     // Make sure the associated camera_info/color image is within 2 seconds
     // of the current point cloud message
 
-    if (message->header.stamp - color_image_.header.stamp > ros::Duration(2) ||
+    if (!color_image_ ||
+        message->header.stamp - color_image_->header.stamp > ros::Duration(2) ||
         message->header.stamp - camera_info_.header.stamp > ros::Duration(2))
     {
         return;
     }
 
-    color_laser_pointcloud_.header = message->header;
+    //
+    // Publish a new message every time so intra-process subscribers can
+    // share it without a copy
+
+    const auto color_laser_pointcloud = boost::make_shared<sensor_msgs::PointCloud2>(color_laser_pointcloud_);
+
+    color_laser_pointcloud->header = message->header;
 
     //
-    // Here we assume that our the sizeof our intensity field is the same as
-    // the sizeof our new rgb color field.
+    // Size the output for the case where every laser point projects into the image
 
-    color_laser_pointcloud_.data.resize(message->data.size());
-    float* colorPointCloudDataP = reinterpret_cast<float*>(&(color_laser_pointcloud_.data[0]));
+    const uint32_t height = message->height;
+    const uint32_t width = message->width;
+    const uint32_t colorCloudStep = color_laser_pointcloud_.point_step;
+    const uint32_t colorChannelOffset = channel_offset(color_laser_pointcloud_);
+
+    color_laser_pointcloud->data.resize(static_cast<size_t>(height) * width * colorCloudStep);
+    uint8_t* colorPointCloudDataP = &(color_laser_pointcloud->data[0]);
 
     //
     // Iterate over all the points in the point cloud, Use the camera projection
@@ -122,19 +128,22 @@ void ColorLaser::laserPointCloudCallback(
     // colorize the point with the corresponding image point in the left
     // camera. If the point does not project into the camera image
     // do not add it to the point cloud.
+    //
+    // The incoming points are read using their own point step, since the
+    // laser pointcloud may use any point layout with x, y, z leading
 
-    float* pointCloudDataP = reinterpret_cast<float*>(&(message->data[0]));
-
-    const uint32_t height = message->height;
-    const uint32_t width = message->width;
-    const uint32_t cloudStep = message->point_step / message->fields.size();
+    const uint8_t* pointCloudDataP = &(message->data[0]);
+    const uint32_t cloudStep = message->point_step;
 
     uint32_t validPoints = 0;
     for( uint32_t index = 0 ; index < height * width ; ++index, pointCloudDataP += cloudStep)
     {
-        float x = pointCloudDataP[0];
-        float y = pointCloudDataP[1];
-        float z = pointCloudDataP[2];
+        float xyz[3];
+        memcpy(xyz, pointCloudDataP, sizeof(xyz));
+
+        const float x = xyz[0];
+        const float y = xyz[1];
+        const float z = xyz[2];
 
         //
         // Invalid points from the laser will have a distance of 60m.
@@ -161,51 +170,55 @@ void ColorLaser::laserPointCloudCallback(
         // If our computed (u, v) point projects into the image use its
         // color value and add it to the color pointcloud message
 
-        if (u < color_image_.width && v < color_image_.height && u >= 0.0 && v >= 0.0)
+        if (u < color_image_->width && v < color_image_->height && u >= 0.0 && v >= 0.0)
         {
 
-            colorPointCloudDataP[0] = x;
-            colorPointCloudDataP[1] = y;
-            colorPointCloudDataP[2] = z;
+            memcpy(colorPointCloudDataP, xyz, sizeof(xyz));
 
-            uint8_t* colorChannelP = reinterpret_cast<uint8_t*>(&colorPointCloudDataP[3]);
+            uint8_t colorChannel[4] = {0, 0, 0, 0};
 
             //
             // Image data is assumed to be BRG and stored continuously in memory
             // both of which are the case for color images from the MultiSense
 
-            uint8_t* imageDataP = &color_image_.data[(image_channels_ * static_cast<size_t>(v) * color_image_.width) +
-                                                     (image_channels_ * static_cast<size_t>(u))];
+            const uint8_t* imageDataP = &color_image_->data[(image_channels_ * static_cast<size_t>(v) * color_image_->width) +
+                                                            (image_channels_ * static_cast<size_t>(u))];
 
             switch(image_channels_)
             {
                 case 3:
-                    colorChannelP[2] = imageDataP[2];
-                    colorChannelP[1] = imageDataP[1];
-                    colorChannelP[0] = imageDataP[0];
+                    colorChannel[2] = imageDataP[2];
+                    colorChannel[1] = imageDataP[1];
+                    colorChannel[0] = imageDataP[0];
                     break;
                 case 2:
-                    colorChannelP[1] = imageDataP[1];
-                    colorChannelP[0] = imageDataP[0];
+                    colorChannel[1] = imageDataP[1];
+                    colorChannel[0] = imageDataP[0];
                     break;
                 case 1:
-                    colorChannelP[0] = imageDataP[0];
-                    colorChannelP[2] = imageDataP[0];
-                    colorChannelP[1] = imageDataP[0];
+                    colorChannel[0] = imageDataP[0];
+                    colorChannel[2] = imageDataP[0];
+                    colorChannel[1] = imageDataP[0];
                     break;
             }
 
-            colorPointCloudDataP += cloudStep;
+            if (0 != colorChannelOffset)
+            {
+                memcpy(colorPointCloudDataP + colorChannelOffset, colorChannel, sizeof(colorChannel));
+            }
+
+            colorPointCloudDataP += colorCloudStep;
             ++validPoints;
         }
 
     }
 
-    color_laser_pointcloud_.data.resize(validPoints * laser_cloud_step);
-    color_laser_pointcloud_.width = validPoints;
-    color_laser_pointcloud_.row_step = validPoints * laser_cloud_step;
+    color_laser_pointcloud->data.resize(validPoints * colorCloudStep);
+    color_laser_pointcloud->height = 1;
+    color_laser_pointcloud->width = validPoints;
+    color_laser_pointcloud->row_step = validPoints * colorCloudStep;
 
-    color_laser_publisher_.publish(color_laser_pointcloud_);
+    color_laser_publisher_.publish(color_laser_pointcloud);
 }
 
 void ColorLaser::startStreaming()
@@ -243,28 +256,3 @@ void ColorLaser::stopStreaming()
 }
 
 } // namespace
-
-int main(int argc, char** argv)
-{
-    try
-    {
-        ros::init(argc, argv, "color_laser_publisher");
-
-        ros::NodeHandle nh;
-        ros::NodeHandle nh_private("~");
-
-        std::string tf_prefix;
-        nh_private.param<std::string>("tf_prefix", tf_prefix, "multisense");
-
-        multisense_ros::ColorLaser colorLaserPublisher(nh, tf_prefix);
-
-        ros::spin();
-    }
-    catch(std::exception& e)
-    {
-        ROS_ERROR("%s", e.what());
-        return 1;
-    }
-
-    return 0;
-}
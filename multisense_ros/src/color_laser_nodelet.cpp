@@ -0,0 +1,67 @@
+/**
+ * @file color_laser_nodelet.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <memory>
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <multisense_ros/color_laser.h>
+
+namespace multisense_ros {
+
+///
+/// @brief Nodelet version of the color_laser_publisher. Loading it into the same nodelet manager as the driver lets
+///        the laser point clouds and color images reach it without serialization
+///
+class ColorLaserNodelet : public nodelet::Nodelet
+{
+private:
+
+    void onInit() override
+    {
+        std::string tf_prefix;
+        getPrivateNodeHandle().param<std::string>("tf_prefix", tf_prefix, "multisense");
+
+        color_laser_ = std::unique_ptr<ColorLaser>(new ColorLaser(getNodeHandle(),
+                                                                  tf_prefix,
+                                                                  point_layout_param(getPrivateNodeHandle(),
+                                                                                     "lidar_points2_color")));
+    }
+
+    std::unique_ptr<ColorLaser> color_laser_;
+};
+
+} // namespace
+
+PLUGINLIB_EXPORT_CLASS(multisense_ros::ColorLaserNodelet, nodelet::Nodelet)
@@ -0,0 +1,291 @@
+/**
+ * @file frame_assembler.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <algorithm>
+
+#include <multisense_ros/frame_assembler.h>
+
+using namespace crl::multisense;
+
+namespace multisense_ros {
+
+AssembledFrame::AssembledFrame(int64_t frame_id):
+    frame_id_(frame_id)
+{
+}
+
+int64_t AssembledFrame::frameId() const noexcept
+{
+    return frame_id_;
+}
+
+uint32_t AssembledFrame::timeSeconds() const noexcept
+{
+    return time_seconds_;
+}
+
+uint32_t AssembledFrame::timeMicroSeconds() const noexcept
+{
+    return time_microseconds_;
+}
+
+DataSource AssembledFrame::sources() const noexcept
+{
+    return sources_;
+}
+
+const image::Header* AssembledFrame::image(DataSource source) const
+{
+    for (const auto &image : images_) {
+        if (image.first == source) {
+            return &(image.second->data());
+        }
+    }
+
+    return nullptr;
+}
+
+void AssembledFrame::add(const ImageBufferT &image)
+{
+    const DataSource source = image->data().source;
+
+    //
+    // The driver can resend a source for a frame, in which case the latest image wins
+
+    for (auto &existing : images_) {
+        if (existing.first == source) {
+            existing.second = image;
+            return;
+        }
+    }
+
+    if (images_.empty()) {
+        time_seconds_ = image->data().timeSeconds;
+        time_microseconds_ = image->data().timeMicroSeconds;
+    }
+
+    images_.emplace_back(source, image);
+    sources_ |= source;
+}
+
+constexpr int64_t FrameAssembler::MAX_LATE_FRAMES;
+
+FrameAssembler::FrameAssembler(Channel* driver, size_t max_frames, CallbackBufferLimiter* buffer_limiter):
+    driver_(driver),
+    max_frames_(std::max(max_frames, static_cast<size_t>(1))),
+    buffer_limiter_(buffer_limiter)
+{
+    pending_frames_.reserve(max_frames_);
+}
+
+void FrameAssembler::addConsumer(const RequirementFunction &required, const CompletionCallback &callback)
+{
+    consumers_.push_back(ConsumerT{required, callback});
+}
+
+void FrameAssembler::insert(const image::Header &header)
+{
+    //
+    // Evaluate the consumer requirements before taking the lock since they may query publishers
+
+    std::vector<DataSource> required(consumers_.size(), 0);
+    DataSource all_required = 0;
+
+    for (size_t i = 0 ; i < consumers_.size() ; ++i) {
+        required[i] = consumers_[i].required();
+        all_required |= required[i];
+    }
+
+    if (0 == (all_required & header.source)) {
+        return;
+    }
+
+    const auto image = reserve(header);
+
+    std::vector<size_t> ready_consumers;
+    AssembledFrame ready_frame;
+
+    //
+    // Frames dropped on a restart release their buffers after the lock is released
+
+    std::vector<PendingFrameT> restarted_frames;
+
+    if (!image) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (header.frameId + MAX_LATE_FRAMES < newest_frame_id_) {
+
+            ++stats_.restarts;
+            newest_frame_id_ = -1;
+            newest_evicted_frame_id_ = -1;
+            restarted_frames.swap(pending_frames_);
+            pending_frames_.reserve(max_frames_);
+
+        } else if (header.frameId <= newest_evicted_frame_id_) {
+            ++stats_.late_images;
+            return;
+        }
+
+        newest_frame_id_ = std::max(newest_frame_id_, header.frameId);
+
+        auto pending = std::find_if(std::begin(pending_frames_), std::end(pending_frames_),
+                                    [&header](const PendingFrameT &p) { return p.frame.frameId() == header.frameId; });
+
+        if (pending == std::end(pending_frames_)) {
+
+            if (pending_frames_.size() >= max_frames_) {
+                evictOldest(header.frameId);
+            }
+
+            pending_frames_.push_back(PendingFrameT{AssembledFrame(header.frameId),
+                                                    std::vector<bool>(consumers_.size(), false)});
+            pending = std::prev(std::end(pending_frames_));
+        }
+
+        pending->frame.add(image);
+
+        bool frame_complete = true;
+
+        for (size_t i = 0 ; i < consumers_.size() ; ++i) {
+
+            if (0 == required[i] || pending->completed_consumers[i]) {
+                continue;
+            }
+
+            if ((pending->frame.sources() & required[i]) == required[i]) {
+                pending->completed_consumers[i] = true;
+                ready_consumers.push_back(i);
+            } else {
+                frame_complete = false;
+            }
+        }
+
+        if (!ready_consumers.empty()) {
+            ready_frame = pending->frame;
+        }
+
+        //
+        // Release our references as soon as every active consumer has the frame. The images stay valid until the
+        // consumer callbacks below return
+
+        if (frame_complete) {
+            ++stats_.completed_frames;
+            pending_frames_.erase(pending);
+        }
+    }
+
+    for (const auto &i : ready_consumers) {
+        consumers_[i].callback(ready_frame);
+    }
+}
+
+FrameAssembler::ImageBufferT FrameAssembler::reserve(const image::Header &header)
+{
+    if (!buffer_limiter_) {
+        return std::make_shared<const BufferWrapper<image::Header>>(driver_, header);
+    }
+
+    //
+    // Charge the buffers of pending frames against the shared limit so they can not exhaust the driver buffer pool.
+    // Pending frames may hold every buffer, so evict them oldest first until the image fits
+
+    auto image = buffer_limiter_->reserve(header);
+
+    while (!image) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (!evictOldest(header.frameId)) {
+                ++stats_.dropped_images;
+                return nullptr;
+            }
+        }
+
+        image = buffer_limiter_->reserve(header);
+    }
+
+    return image;
+}
+
+bool FrameAssembler::evictOldest(int64_t keep_frame_id)
+{
+    auto oldest = std::end(pending_frames_);
+
+    for (auto pending = std::begin(pending_frames_) ; pending != std::end(pending_frames_) ; ++pending) {
+        if (pending->frame.frameId() != keep_frame_id &&
+            (oldest == std::end(pending_frames_) || pending->frame.frameId() < oldest->frame.frameId())) {
+            oldest = pending;
+        }
+    }
+
+    if (oldest == std::end(pending_frames_)) {
+        return false;
+    }
+
+    newest_evicted_frame_id_ = std::max(newest_evicted_frame_id_, oldest->frame.frameId());
+    ++stats_.evicted_frames;
+
+    pending_frames_.erase(oldest);
+
+    return true;
+}
+
+void FrameAssembler::reset()
+{
+    std::vector<PendingFrameT> pending_frames;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        newest_frame_id_ = -1;
+        newest_evicted_frame_id_ = -1;
+        pending_frames.swap(pending_frames_);
+        pending_frames_.reserve(max_frames_);
+    }
+}
+
+FrameAssembler::StatsT FrameAssembler::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    StatsT stats = stats_;
+    stats.pending_frames = pending_frames_.size();
+
+    return stats;
+}
+
+}// namespace
@@ -179,10 +179,11 @@ Eigen::Matrix<uint8_t, 3, 1> groundSurfaceClassToPixelColor(const uint8_t value)
 
 sensor_msgs::PointCloud2 eigenToPointcloud(
     const std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f>> &input,
-    const std::string &frame_id)
+    const std::string &frame_id,
+    multisense_ros::PointLayout layout)
 {
     sensor_msgs::PointCloud2 ret =
-        multisense_ros::initialize_pointcloud<float>(true, frame_id, "intensity");
+        multisense_ros::initialize_pointcloud(layout, true, frame_id, {"intensity"});
 
     const double num_points = input.size();
     ret.data.resize(num_points * ret.point_step);
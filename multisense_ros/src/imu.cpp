@@ -50,9 +50,12 @@ void imuCB(const imu::Header& header, void* userDataP)
 
 } // anonymous
 
-Imu::Imu(Channel* driver, std::string tf_prefix) :
+Imu::Imu(Channel* driver,
+         std::string tf_prefix,
+         const ros::NodeHandle& nh,
+         const std::shared_ptr<LatencyRegistry>& latency_registry) :
     driver_(driver),
-    device_nh_(""),
+    device_nh_(nh),
     imu_nh_(device_nh_, "imu"),
     accelerometer_pub_(),
     gyroscope_pub_(),
@@ -67,7 +70,9 @@ Imu::Imu(Channel* driver, std::string tf_prefix) :
     tf_prefix_(tf_prefix),
     accel_frameId_(tf_prefix_ + "/accel"),
     gyro_frameId_(tf_prefix_ + "/gyro"),
-    mag_frameId_(tf_prefix_ + "/mag")
+    mag_frameId_(tf_prefix_ + "/mag"),
+    latency_registry_(latency_registry ? latency_registry : std::make_shared<LatencyRegistry>()),
+    imu_latency_(latency_registry_->tracker("imu"))
 {
 
     //
@@ -173,6 +178,8 @@ Imu::~Imu()
 
 void Imu::imuCallback(const imu::Header& header)
 {
+    const auto callback_start = LatencyTracker::now();
+
     std::vector<imu::Sample>::const_iterator it = header.samples.begin();
 
     uint32_t accel_subscribers = accelerometer_pub_.getNumSubscribers();
@@ -265,6 +272,14 @@ void Imu::imuCallback(const imu::Header& header)
             break;
         }
     }
+
+    //
+    // Samples are published as they are unpacked, so measure the latency of the newest sample
+
+    if (!header.samples.empty()) {
+        const imu::Sample& newest = header.samples.back();
+        imu_latency_->record(ros::Time(newest.timeSeconds, 1000 * newest.timeMicroSeconds), callback_start);
+    }
 }
 
 
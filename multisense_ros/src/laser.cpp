@@ -31,8 +31,6 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **/
 
-#include <arpa/inet.h>
-
 #include <angles/angles.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
@@ -45,8 +43,6 @@ using namespace crl::multisense;
 
 namespace { // anonymous
 
-const uint32_t laser_cloud_step = 16;
-
 tf2::Transform makeTransform(float T[4][4])
 {
     //
@@ -96,11 +92,17 @@ void pCB(const lidar::Header&        header,
 } // anonymous
 
 Laser::Laser(Channel* driver,
-             const std::string& tf_prefix):
+             const std::string& tf_prefix,
+             const ros::NodeHandle& device_nh,
+             const std::shared_ptr<LatencyRegistry>& latency_registry,
+             PointLayout point_layout):
     driver_(driver),
     subscribers_(0),
     spindle_angle_(0.0),
-    previous_scan_time_(0.0)
+    previous_scan_time_(0.0),
+    latency_registry_(latency_registry ? latency_registry : std::make_shared<LatencyRegistry>()),
+    scan_latency_(latency_registry_->tracker("lidar_scan")),
+    point_cloud_latency_(latency_registry_->tracker("lidar_points2"))
 
 {
     //
@@ -120,7 +122,7 @@ Laser::Laser(Channel* driver,
         return;
     }
 
-    ros::NodeHandle nh("");
+    ros::NodeHandle nh(device_nh);
 
     //
     // Set frame ID
@@ -165,29 +167,8 @@ Laser::Laser(Channel* driver,
     //
     // Initialize point cloud structure
 
-    point_cloud_.is_bigendian    = (htonl(1) == 1);
-    point_cloud_.is_dense        = true;
-    point_cloud_.point_step      = laser_cloud_step;
-    point_cloud_.height          = 1;
-    point_cloud_.header.frame_id =  tf_prefix + "/left_camera_optical_frame";
-
-    point_cloud_.fields.resize(4);
-    point_cloud_.fields[0].name     = "x";
-    point_cloud_.fields[0].offset   = 0;
-    point_cloud_.fields[0].count    = 1;
-    point_cloud_.fields[0].datatype = sensor_msgs::PointField::FLOAT32;
-    point_cloud_.fields[1].name     = "y";
-    point_cloud_.fields[1].offset   = 4;
-    point_cloud_.fields[1].count    = 1;
-    point_cloud_.fields[1].datatype = sensor_msgs::PointField::FLOAT32;
-    point_cloud_.fields[2].name     = "z";
-    point_cloud_.fields[2].offset   = 8;
-    point_cloud_.fields[2].count    = 1;
-    point_cloud_.fields[2].datatype = sensor_msgs::PointField::FLOAT32;
-    point_cloud_.fields[3].name     = "intensity";
-    point_cloud_.fields[3].offset   = 12;
-    point_cloud_.fields[3].count    = 1;
-    point_cloud_.fields[3].datatype = sensor_msgs::PointField::FLOAT32;
+    point_cloud_ = initialize_pointcloud(point_layout, true, tf_prefix + "/left_camera_optical_frame", {"intensity"});
+    point_cloud_.height = 1;
 
     //
     // Create point cloud publisher
@@ -281,14 +262,16 @@ Laser::~Laser()
 
 void Laser::pointCloudCallback(const lidar::Header& header)
 {
+    const auto callback_start = LatencyTracker::now();
+
     //
     // Get out if we have no work to do
 
     if (0 == point_cloud_pub_.getNumSubscribers())
         return;
 
-    point_cloud_.data.resize(laser_cloud_step * header.pointCount);
-    point_cloud_.row_step     = header.pointCount * laser_cloud_step;
+    point_cloud_.data.resize(point_cloud_.point_step * header.pointCount);
+    point_cloud_.row_step     = header.pointCount * point_cloud_.point_step;
     point_cloud_.width        = header.pointCount;
     point_cloud_.header.stamp = ros::Time(header.timeStartSeconds,
                                           1000 * header.timeStartMicroSeconds);
@@ -297,13 +280,15 @@ void Laser::pointCloudCallback(const lidar::Header& header)
 
     uint8_t       *cloudP            = reinterpret_cast<uint8_t*>(&point_cloud_.data[0]);
     const uint32_t pointSize         = 3 * sizeof(float); // x, y, z
+    const uint32_t pointStep         = point_cloud_.point_step;
+    const uint32_t intensityOffset   = channel_offset(point_cloud_);
     const double   arcRadians        = 1e-6 * static_cast<double>(header.scanArc);
     const double   mirrorThetaStart  = -arcRadians / 2.0;
     const double   spindleAngleStart = angles::normalize_angle(1e-6 * static_cast<double>(header.spindleAngleStart));
     const double   spindleAngleEnd   = angles::normalize_angle(1e-6 * static_cast<double>(header.spindleAngleEnd));
     const double   spindleAngleRange = angles::normalize_angle(spindleAngleEnd - spindleAngleStart);
 
-    for(uint32_t i=0; i<header.pointCount; ++i, cloudP += laser_cloud_step) {
+    for(uint32_t i=0; i<header.pointCount; ++i, cloudP += pointStep) {
 
         //
         // Percent through the scan arc
@@ -339,15 +324,21 @@ void Laser::pointCloudCallback(const lidar::Header& header)
                               static_cast<float>(pointCamera.getZ())};
 
         memcpy(cloudP, &(xyz[0]), pointSize);
-        float* intensityChannel = reinterpret_cast<float*>(cloudP + pointSize);
-        *intensityChannel = static_cast<float>(header.intensitiesP[i]);   // in device units
+
+        if (0 != intensityOffset) {
+            const float intensity = static_cast<float>(header.intensitiesP[i]);   // in device units
+            memcpy(cloudP + intensityOffset, &intensity, sizeof(float));
+        }
     }
 
     point_cloud_pub_.publish(point_cloud_);
+
+    point_cloud_latency_->record(ros::Time(header.timeEndSeconds, 1000 * header.timeEndMicroSeconds), callback_start);
 }
 
 void Laser::scanCallback(const lidar::Header& header)
 {
+    const auto callback_start = LatencyTracker::now();
 
     const ros::Time start_absolute_time = ros::Time(header.timeStartSeconds,
                                                     1000 * header.timeStartMicroSeconds);
@@ -435,6 +426,8 @@ void Laser::scanCallback(const lidar::Header& header)
 
         raw_lidar_data_pub_.publish(ros_msg);
     }
+
+    scan_latency_->record(end_absolute_time, callback_start);
 }
 
 void Laser::publishSpindleTransform(const float spindle_angle, const float velocity, const ros::Time& time) {
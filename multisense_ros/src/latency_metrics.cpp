@@ -0,0 +1,201 @@
+/**
+ * @file latency_metrics.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <multisense_ros/latency_metrics.h>
+
+namespace multisense_ros {
+
+namespace { // anonymous
+
+size_t highestBit(uint64_t value)
+{
+    size_t bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+
+    return bit;
+}
+
+double percentile(const std::array<uint64_t, LatencyHistogram::BUCKETS> &counts,
+                  uint64_t total,
+                  double fraction,
+                  uint64_t max)
+{
+    const uint64_t target = std::max(static_cast<uint64_t>(std::ceil(fraction * total)), static_cast<uint64_t>(1));
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0 ; i < counts.size() ; ++i) {
+        cumulative += counts[i];
+        if (cumulative >= target) {
+            return 1e-6 * static_cast<double>(std::min(LatencyHistogram::bucketUpperBound(i), max));
+        }
+    }
+
+    return 1e-6 * static_cast<double>(max);
+}
+
+} // anonymous
+
+constexpr size_t LatencyHistogram::SUB_BUCKETS;
+constexpr size_t LatencyHistogram::BUCKETS;
+
+LatencyHistogram::LatencyHistogram():
+    max_(0)
+{
+    for (auto &count : counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::record(uint64_t microseconds) noexcept
+{
+    counts_[bucket(microseconds)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (microseconds > max && !max_.compare_exchange_weak(max, microseconds, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::SummaryT LatencyHistogram::collect() noexcept
+{
+    //
+    // Each bucket is reset individually, so a concurrent record lands in either this summary or the next one
+
+    std::array<uint64_t, BUCKETS> counts;
+    uint64_t total = 0;
+
+    for (size_t i = 0 ; i < BUCKETS ; ++i) {
+        counts[i] = counts_[i].exchange(0, std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    const uint64_t max = max_.exchange(0, std::memory_order_relaxed);
+
+    SummaryT summary;
+
+    if (0 == total) {
+        return summary;
+    }
+
+    summary.count = total;
+    summary.p50 = percentile(counts, total, 0.50, max);
+    summary.p95 = percentile(counts, total, 0.95, max);
+    summary.p99 = percentile(counts, total, 0.99, max);
+    summary.max = 1e-6 * static_cast<double>(max);
+
+    return summary;
+}
+
+size_t LatencyHistogram::bucket(uint64_t microseconds) noexcept
+{
+    //
+    // Values below SUB_BUCKETS get a bucket each. Above that, each power of two is split into SUB_BUCKETS linear
+    // buckets indexed by the bits following the highest set bit
+
+    if (microseconds < SUB_BUCKETS) {
+        return static_cast<size_t>(microseconds);
+    }
+
+    const size_t bit = highestBit(microseconds);
+    const size_t sub_bucket = (microseconds >> (bit - 2)) & (SUB_BUCKETS - 1);
+
+    return std::min((bit - 1) * SUB_BUCKETS + sub_bucket, BUCKETS - 1);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) noexcept
+{
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+
+    if (bucket >= BUCKETS - 1) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+    const size_t bit = bucket / SUB_BUCKETS + 1;
+    const uint64_t sub_bucket = bucket % SUB_BUCKETS;
+
+    return ((SUB_BUCKETS + sub_bucket + 1) << (bit - 2)) - 1;
+}
+
+LatencyTracker::TimePoint LatencyTracker::now() noexcept
+{
+    return std::chrono::steady_clock::now();
+}
+
+void LatencyTracker::record(const ros::Time &sensor_stamp, const TimePoint &callback_start) noexcept
+{
+    const auto processing_time = std::chrono::duration_cast<std::chrono::microseconds>(now() - callback_start);
+    processing.record(static_cast<uint64_t>(std::max(processing_time.count(), static_cast<int64_t>(0))));
+
+    //
+    // The sensor clock may lead the host clock slightly when time sync is off, so clamp negative latencies
+
+    const int64_t latency_ns = static_cast<int64_t>(ros::Time::now().toNSec()) - static_cast<int64_t>(sensor_stamp.toNSec());
+    latency.record(static_cast<uint64_t>(std::max(latency_ns, static_cast<int64_t>(0)) / 1000));
+}
+
+LatencyTracker* LatencyRegistry::tracker(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto &tracker = trackers_[name];
+    if (!tracker) {
+        tracker = std::unique_ptr<LatencyTracker>(new LatencyTracker());
+    }
+
+    return tracker.get();
+}
+
+std::vector<LatencyRegistry::TopicSummaryT> LatencyRegistry::collect()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<TopicSummaryT> summaries;
+    summaries.reserve(trackers_.size());
+
+    for (auto &tracker : trackers_) {
+        summaries.push_back(TopicSummaryT{tracker.first,
+                                          tracker.second->processing.collect(),
+                                          tracker.second->latency.collect()});
+    }
+
+    return summaries;
+}
+
+}// namespace
@@ -0,0 +1,228 @@
+/**
+ * @file load_generator.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+
+#include <multisense_ros/laser.h>
+#include <multisense_ros/camera.h>
+#include <multisense_ros/mock_channel.h>
+#include <multisense_ros/pps.h>
+#include <multisense_ros/imu.h>
+#include <multisense_ros/status.h>
+#include <multisense_ros/reconfigure.h>
+#include <ros/ros.h>
+
+using namespace crl::multisense;
+
+//
+// Drives the driver classes with a mock sensor, exactly as ros_driver does with a real one. Streams start when
+// their topics are subscribed to, so subscribe to the topics under load (e.g. with rostopic hz or rviz). The
+// achieved rate, drops and callback CPU time of every stream are reported periodically
+
+namespace {
+
+double processCpuSeconds()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           1e-6 * static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+class LoadReporter
+{
+public:
+    explicit LoadReporter(const multisense_ros::MockChannel &channel):
+        channel_(channel),
+        previous_time_(std::chrono::steady_clock::now()),
+        previous_process_cpu_(processCpuSeconds())
+    {
+    }
+
+    void report(const ros::TimerEvent&)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - previous_time_).count();
+        const double process_cpu = processCpuSeconds();
+
+        if (elapsed <= 0.0) {
+            return;
+        }
+
+        std::map<std::string, double> subsystem_cpu;
+
+        for (const auto &stream : channel_.stats()) {
+
+            const auto previous = previous_stats_[stream.name];
+
+            const double fps = static_cast<double>(stream.delivered - previous.delivered) / elapsed;
+            const double cpu = 100.0 * (stream.cpu_seconds - previous.cpu_seconds) / elapsed;
+
+            subsystem_cpu[stream.subsystem] += cpu;
+
+            ROS_INFO("load: %-28s %7.1f msgs/s  dropped %6lu  failed reservations %6lu  callback cpu %6.1f%%",
+                     stream.name.c_str(),
+                     fps,
+                     static_cast<unsigned long>(stream.dropped - previous.dropped),
+                     static_cast<unsigned long>(stream.failed_reservations - previous.failed_reservations),
+                     cpu);
+
+            previous_stats_[stream.name] = stream;
+        }
+
+        for (const auto &subsystem : subsystem_cpu) {
+            ROS_INFO("load: %-8s callback cpu %6.1f%%", subsystem.first.c_str(), subsystem.second);
+        }
+
+        //
+        // Work moved off the callback threads (e.g. to the camera worker pool) only shows up in the process total
+
+        ROS_INFO("load: process cpu %6.1f%%", 100.0 * (process_cpu - previous_process_cpu_) / elapsed);
+
+        previous_time_ = now;
+        previous_process_cpu_ = process_cpu;
+    }
+
+private:
+
+    const multisense_ros::MockChannel &channel_;
+
+    std::chrono::steady_clock::time_point previous_time_;
+    double previous_process_cpu_ = 0.0;
+    std::map<std::string, multisense_ros::MockChannel::StreamStatsT> previous_stats_;
+};
+
+}// namespace
+
+int main(int argc, char** argvPP)
+{
+    ros::init(argc, argvPP, "multisense_load_generator");
+    ros::NodeHandle nh;
+    ros::NodeHandle nh_private_("~");
+
+    //
+    // Get parameters from ROS/command-line
+
+    std::string tf_prefix;
+    std::string device;
+    int         width;
+    int         height;
+    int         queue_depth;
+    int         callback_buffers;
+    double      report_period;
+
+    multisense_ros::MockChannel::ConfigT config;
+
+    nh_private_.param<std::string>("tf_prefix", tf_prefix, "multisense");
+    nh_private_.param<std::string>("device", device, "S30");
+    nh_private_.param<int>("width", width, config.width);
+    nh_private_.param<int>("height", height, config.height);
+    nh_private_.param<double>("fps", config.image_fps, config.image_fps);
+    nh_private_.param<double>("lidar_scan_rate", config.lidar_scan_rate, config.lidar_scan_rate);
+    nh_private_.param<double>("imu_sample_rate", config.imu_sample_rate, config.imu_sample_rate);
+    nh_private_.param<double>("pps_rate", config.pps_rate, config.pps_rate);
+    nh_private_.param<double>("jitter", config.jitter, config.jitter);
+    nh_private_.param<int>("queue_depth", queue_depth, config.queue_depth);
+    nh_private_.param<int>("callback_buffers", callback_buffers, config.callback_buffers);
+    nh_private_.param<std::string>("luma_image", config.luma_image, "");
+    nh_private_.param<std::string>("disparity_image", config.disparity_image, "");
+    nh_private_.param<double>("report_period", report_period, 5.0);
+
+    if (device == "S30") {
+        config.device = multisense_ros::MockChannel::DeviceType::S30;
+    } else if (device == "SL") {
+        config.device = multisense_ros::MockChannel::DeviceType::SL;
+    } else {
+        ROS_ERROR("multisense_ros: unsupported mock device \"%s\", expected S30 or SL", device.c_str());
+        return -1;
+    }
+
+    if (width <= 0 || height <= 0 || queue_depth <= 0 || callback_buffers <= 0) {
+        ROS_ERROR("multisense_ros: width, height, queue_depth and callback_buffers must be positive");
+        return -1;
+    }
+
+    config.width = static_cast<uint32_t>(width);
+    config.height = static_cast<uint32_t>(height);
+    config.queue_depth = static_cast<size_t>(queue_depth);
+    config.callback_buffers = static_cast<size_t>(callback_buffers);
+
+    multisense_ros::MockChannel channel(config);
+    Channel *d = &channel;
+
+    try {
+
+        //
+        // Anonymous namespace so objects can deconstruct before channel is destroyed
+        {
+            const auto latency_registry = std::make_shared<multisense_ros::LatencyRegistry>();
+
+            multisense_ros::Laser        laser(d, tf_prefix, nh, latency_registry,
+                                               multisense_ros::point_layout_param(nh_private_, "lidar_points2"));
+            multisense_ros::Camera       camera(d, tf_prefix, nh, nh_private_, latency_registry);
+            multisense_ros::Pps          pps(d);
+            multisense_ros::Imu          imu(d, tf_prefix, nh, latency_registry);
+            multisense_ros::Status       status(d);
+            multisense_ros::Reconfigure  rec(d,
+                                             std::bind(&multisense_ros::Camera::updateConfig, &camera, std::placeholders::_1),
+                                             std::bind(&multisense_ros::Camera::borderClipChanged, &camera,
+                                                       std::placeholders::_1, std::placeholders::_2),
+                                             std::bind(&multisense_ros::Camera::maxPointCloudRangeChanged, &camera,
+                                                       std::placeholders::_1),
+                                             std::bind(&multisense_ros::Camera::extrinsicsChanged, &camera,
+                                                       std::placeholders::_1),
+                                             std::bind(&multisense_ros::Camera::groundSurfaceSplineDrawParametersChanged, &camera,
+                                                       std::placeholders::_1));
+
+            LoadReporter reporter(channel);
+            ros::Timer report_timer;
+            if (report_period > 0.0) {
+                report_timer = nh_private_.createTimer(ros::Duration(report_period), &LoadReporter::report, &reporter);
+            }
+
+            ros::spin();
+        }
+
+        return 0;
+
+    } catch (const std::exception& e) {
+        ROS_ERROR("multisense_ros: caught exception: %s", e.what());
+        return -4;
+    }
+}
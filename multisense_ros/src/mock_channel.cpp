@@ -0,0 +1,1416 @@
+/**
+ * @file mock_channel.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <time.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <opencv2/opencv.hpp>
+#include <ros/ros.h>
+
+#include <multisense_ros/camera_utilities.h>
+#include <multisense_ros/mock_channel.h>
+
+using namespace crl::multisense;
+
+namespace multisense_ros {
+
+namespace {
+
+//
+// Canned sensor geometry. Calibrations are given at the full imager resolution
+
+static constexpr uint32_t S30_IMAGER_WIDTH = 1920;
+static constexpr uint32_t S30_IMAGER_HEIGHT = 1200;
+static constexpr uint32_t SL_IMAGER_WIDTH = 2048;
+static constexpr uint32_t SL_IMAGER_HEIGHT = 1088;
+static constexpr double FOCAL_LENGTH = 1500.0;
+static constexpr double S30_BASELINE = 0.27;
+static constexpr double SL_BASELINE = 0.07;
+static constexpr double AUX_BASELINE = 0.033;
+static constexpr int32_t DISPARITIES = 256;
+
+//
+// Synthetic scene: a flat floor CAMERA_HEIGHT below the sensor, with a wall at WALL_DISTANCE above the horizon
+
+static constexpr double CAMERA_HEIGHT = 1.5;
+static constexpr double WALL_DISTANCE = 10.0;
+
+//
+// Hokuyo UTM-30LX geometry of the SL lidar. Ranges are synthetic and describe a round room ROOM_RADIUS_MM in radius
+
+static constexpr uint32_t LIDAR_POINTS = 1081;
+static constexpr double LIDAR_ARC = 270.0 * M_PI / 180.0;
+static constexpr uint32_t LIDAR_MAX_RANGE_MM = 30000;
+static constexpr uint32_t ROOM_RADIUS_MM = 5000;
+static constexpr float DEFAULT_MOTOR_RPM = 15.0f;
+
+//
+// Synthetic spline ground surface model which covers the default SplineDrawParameters drawing extents
+
+static constexpr uint32_t CONTROL_GRID_ROWS = 20;
+static constexpr uint32_t CONTROL_GRID_COLS = 30;
+
+static constexpr uint32_t API_VERSION = 0x0500;
+static constexpr uint32_t FIRMWARE_VERSION = 0x0500;
+static constexpr uint32_t IMU_MAX_SAMPLES_PER_MESSAGE = 20;
+static constexpr uint32_t HISTOGRAM_CHANNELS = 4;
+static constexpr uint32_t HISTOGRAM_BINS = 256;
+
+//
+// The payload and stream of the message being dispatched on the current listener thread. Used to hand out callback
+// buffers, which like LibMultiSense can only be reserved from within a callback
+
+thread_local const std::shared_ptr<const void> *dispatching_payload = nullptr;
+thread_local const std::string *dispatching_stream = nullptr;
+
+struct GroundSurfacePayloadT
+{
+    std::vector<float> control_grid;
+    ground_surface::Header header;
+};
+
+struct LidarPayloadT
+{
+    std::vector<uint32_t> ranges;
+    std::vector<uint32_t> intensities;
+};
+
+std::string streamName(DataSource source)
+{
+    switch (source) {
+    case Source_Luma_Left:                  return "luma_left";
+    case Source_Luma_Right:                 return "luma_right";
+    case Source_Luma_Rectified_Left:        return "luma_rectified_left";
+    case Source_Luma_Rectified_Right:       return "luma_rectified_right";
+    case Source_Chroma_Left:                return "chroma_left";
+    case Source_Luma_Aux:                   return "luma_aux";
+    case Source_Luma_Rectified_Aux:         return "luma_rectified_aux";
+    case Source_Chroma_Aux:                 return "chroma_aux";
+    case Source_Chroma_Rectified_Aux:       return "chroma_rectified_aux";
+    case Source_Disparity:                  return "disparity_left";
+    case Source_Disparity_Right:            return "disparity_right";
+    case Source_Disparity_Cost:             return "disparity_cost";
+    case Source_Ground_Surface_Class_Image: return "ground_surface_class_image";
+    default:                                return "unknown";
+    }
+}
+
+double threadCpuSeconds()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+
+    return static_cast<double>(time.tv_sec) + 1e-9 * static_cast<double>(time.tv_nsec);
+}
+
+void wallTime(uint32_t &seconds, uint32_t &microseconds)
+{
+    const auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    seconds = static_cast<uint32_t>(now / 1000000);
+    microseconds = static_cast<uint32_t>(now % 1000000);
+}
+
+image::Calibration::Data makeCalibrationData(uint32_t imager_width, uint32_t imager_height, double tx)
+{
+    image::Calibration::Data data;
+
+    for (size_t r = 0 ; r < 3 ; ++r) {
+        for (size_t c = 0 ; c < 3 ; ++c) {
+            data.M[r][c] = 0.0f;
+            data.R[r][c] = (r == c) ? 1.0f : 0.0f;
+        }
+
+        for (size_t c = 0 ; c < 4 ; ++c) {
+            data.P[r][c] = 0.0f;
+        }
+    }
+
+    for (size_t i = 0 ; i < 8 ; ++i) {
+        data.D[i] = 0.0f;
+    }
+
+    data.M[0][0] = FOCAL_LENGTH;
+    data.M[0][2] = imager_width / 2.0;
+    data.M[1][1] = FOCAL_LENGTH;
+    data.M[1][2] = imager_height / 2.0;
+    data.M[2][2] = 1.0f;
+
+    data.P[0][0] = FOCAL_LENGTH;
+    data.P[0][2] = imager_width / 2.0;
+    data.P[0][3] = FOCAL_LENGTH * tx;
+    data.P[1][1] = FOCAL_LENGTH;
+    data.P[1][2] = imager_height / 2.0;
+    data.P[2][2] = 1.0f;
+
+    return data;
+}
+
+template <typename T>
+std::shared_ptr<const std::vector<T>> matToPayload(const cv::Mat &image)
+{
+    const cv::Mat continuous = image.isContinuous() ? image : image.clone();
+    const T *data = reinterpret_cast<const T*>(continuous.data);
+
+    return std::make_shared<const std::vector<T>>(data, data + continuous.total());
+}
+
+///
+/// @brief Load a recorded image and resize it to the operating resolution. Returns an empty image on failure
+///
+cv::Mat loadRecordedImage(const std::string &path, int flags, int type, int interpolation, uint32_t width, uint32_t height)
+{
+    if (path.empty()) {
+        return cv::Mat();
+    }
+
+    const cv::Mat image = cv::imread(path, flags);
+    if (image.empty() || image.type() != type) {
+        ROS_ERROR("MockChannel: unable to load recorded image \"%s\", using a synthetic image", path.c_str());
+        return cv::Mat();
+    }
+
+    cv::Mat resized;
+    cv::resize(image, resized, cv::Size(width, height), 0, 0, interpolation);
+
+    return resized;
+}
+
+}// namespace
+
+MockChannel::Listener::Listener(MockChannel *channel,
+                                CallbackType type,
+                                uintptr_t key,
+                                DataSource mask,
+                                const CallbackT &callback):
+    channel_(channel),
+    type_(type),
+    key_(key),
+    mask_(mask),
+    callback_(callback),
+    thread_(&Listener::run, this)
+{
+}
+
+MockChannel::Listener::~Listener()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+
+    condition_.notify_all();
+    thread_.join();
+}
+
+std::string MockChannel::Listener::post(const std::string &stream,
+                                        const PayloadT &payload,
+                                        const std::shared_ptr<const void> &header)
+{
+    std::string dropped_stream;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (queue_.size() >= channel_->config_.queue_depth) {
+            dropped_stream = queue_.front().stream;
+            queue_.pop_front();
+        }
+
+        queue_.push_back(QueuedMessageT{stream, payload, header});
+    }
+
+    condition_.notify_one();
+
+    return dropped_stream;
+}
+
+void MockChannel::Listener::run()
+{
+    while (true) {
+
+        QueuedMessageT message;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this]() { return shutdown_ || !queue_.empty(); });
+
+            if (shutdown_) {
+                return;
+            }
+
+            message = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        dispatching_payload = &message.payload;
+        dispatching_stream = &message.stream;
+
+        const double start = threadCpuSeconds();
+        callback_(message.header.get());
+        const double cpu_seconds = threadCpuSeconds() - start;
+
+        dispatching_payload = nullptr;
+        dispatching_stream = nullptr;
+
+        channel_->recordCallback(message.stream, cpu_seconds);
+    }
+}
+
+MockChannel::MockChannel(const ConfigT &config):
+    config_(config),
+    start_time_(std::chrono::steady_clock::now()),
+    image_fps_(config.image_fps),
+    motor_rpm_(DEFAULT_MOTOR_RPM)
+{
+    config_.queue_depth = std::max(config_.queue_depth, static_cast<size_t>(1));
+
+    //
+    // Canned device information
+
+    const bool sl = DeviceType::SL == config_.device;
+
+    device_info_.name = sl ? "MultiSense SL (mock)" : "MultiSense S30 (mock)";
+    device_info_.buildDate = "mock";
+    device_info_.serialNumber = "mock";
+    device_info_.hardwareRevision = sl ? system::DeviceInfo::HARDWARE_REV_MULTISENSE_SL :
+                                         system::DeviceInfo::HARDWARE_REV_MULTISENSE_S30;
+    device_info_.imagerName = sl ? "CMV2000" : "AR0234";
+    device_info_.imagerType = sl ? system::DeviceInfo::IMAGER_TYPE_CMV2000_COLOR :
+                                   system::DeviceInfo::IMAGER_TYPE_AR0234_GREY;
+    device_info_.imagerWidth = sl ? SL_IMAGER_WIDTH : S30_IMAGER_WIDTH;
+    device_info_.imagerHeight = sl ? SL_IMAGER_HEIGHT : S30_IMAGER_HEIGHT;
+    device_info_.lensName = "mock";
+    device_info_.lensType = 0;
+    device_info_.nominalBaseline = sl ? SL_BASELINE : S30_BASELINE;
+    device_info_.nominalFocalLength = 0.0f;
+    device_info_.nominalRelativeAperture = 0.0f;
+    device_info_.lightingType = 0;
+    device_info_.numberOfLights = 0;
+    device_info_.laserName = sl ? "Hokuyo UTM-30LX-EW" : "";
+    device_info_.laserType = 0;
+    device_info_.motorName = sl ? "mock" : "";
+    device_info_.motorType = 0;
+    device_info_.motorGearReduction = 1.0f;
+
+    //
+    // Canned calibrations
+
+    image_calibration_.left = makeCalibrationData(device_info_.imagerWidth, device_info_.imagerHeight, 0.0);
+    image_calibration_.right = makeCalibrationData(device_info_.imagerWidth, device_info_.imagerHeight,
+                                                   -device_info_.nominalBaseline);
+    image_calibration_.aux = makeCalibrationData(device_info_.imagerWidth, device_info_.imagerHeight,
+                                                 sl ? std::numeric_limits<float>::quiet_NaN() : -AUX_BASELINE);
+
+    for (size_t r = 0 ; r < 4 ; ++r) {
+        for (size_t c = 0 ; c < 4 ; ++c) {
+            lidar_calibration_.laserToSpindle[r][c] = (r == c) ? 1.0f : 0.0f;
+            lidar_calibration_.cameraToSpindleFixed[r][c] = (r == c) ? 1.0f : 0.0f;
+        }
+    }
+
+    //
+    // Canned image config at the requested operating resolution
+
+    image::Config image_config;
+    image_config.setResolution(config_.width, config_.height);
+    image_config.setDisparities(DISPARITIES);
+    image_config.setFps(config_.image_fps);
+
+    if (Status_Ok != setImageConfig(image_config)) {
+        ROS_ERROR("MockChannel: unsupported resolution %ux%u, using %ux%u",
+                  config_.width, config_.height, device_info_.imagerWidth / 2, device_info_.imagerHeight / 2);
+
+        image_config.setResolution(device_info_.imagerWidth / 2, device_info_.imagerHeight / 2);
+        setImageConfig(image_config);
+    }
+
+    //
+    // Lidar ranges do not change between scans
+
+    if (sl) {
+        auto lidar_payload = std::make_shared<LidarPayloadT>();
+        lidar_payload->ranges.resize(LIDAR_POINTS);
+        lidar_payload->intensities.resize(LIDAR_POINTS);
+
+        for (uint32_t i = 0 ; i < LIDAR_POINTS ; ++i) {
+            lidar_payload->ranges[i] = ROOM_RADIUS_MM + static_cast<uint32_t>(500.0 * (1.0 + std::sin(0.05 * i)));
+            lidar_payload->intensities[i] = 1000 + (i % 100) * 10;
+        }
+
+        lidar_point_count_ = LIDAR_POINTS;
+        lidar_payload_ = lidar_payload;
+    }
+
+    //
+    // Start the sensor. Each stream is generated on its own thread
+
+    generators_.emplace_back(&MockChannel::runGenerator, this,
+                             [this]() { return image_fps_.load(); },
+                             [this]() { generateImages(); });
+
+    if (sl) {
+        generators_.emplace_back(&MockChannel::runGenerator, this,
+                                 [this]() { return config_.lidar_scan_rate; },
+                                 [this]() { generateLidarScan(); });
+    }
+
+    generators_.emplace_back(&MockChannel::runGenerator, this,
+                             [this]() { return config_.imu_sample_rate / imu_samples_per_message_.load(); },
+                             [this]() { generateImu(); });
+
+    generators_.emplace_back(&MockChannel::runGenerator, this,
+                             [this]() { return config_.pps_rate; },
+                             [this]() { generatePps(); });
+}
+
+MockChannel::~MockChannel()
+{
+    {
+        std::lock_guard<std::mutex> lock(shutdown_mutex_);
+        shutdown_ = true;
+    }
+
+    shutdown_condition_.notify_all();
+
+    for (auto &generator : generators_) {
+        generator.join();
+    }
+
+    std::vector<std::unique_ptr<Listener>> listeners;
+    {
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+        listeners.swap(listeners_);
+    }
+}
+
+std::vector<MockChannel::StreamStatsT> MockChannel::stats() const
+{
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+
+    std::vector<StreamStatsT> stats;
+    stats.reserve(stats_.size());
+
+    for (const auto &stream : stats_) {
+        stats.push_back(stream.second);
+    }
+
+    return stats;
+}
+
+Status MockChannel::addIsolatedCallback(image::Callback callback, DataSource imageSourceMask, void *userDataP)
+{
+    return addListener(CallbackType::IMAGE, reinterpret_cast<uintptr_t>(callback), imageSourceMask,
+                       [callback, userDataP](const void *header) {
+                           callback(*static_cast<const image::Header*>(header), userDataP);
+                       });
+}
+
+Status MockChannel::addIsolatedCallback(lidar::Callback callback, void *userDataP)
+{
+    return addListener(CallbackType::LIDAR, reinterpret_cast<uintptr_t>(callback), Source_Lidar_Scan,
+                       [callback, userDataP](const void *header) {
+                           callback(*static_cast<const lidar::Header*>(header), userDataP);
+                       });
+}
+
+Status MockChannel::addIsolatedCallback(pps::Callback callback, void *userDataP)
+{
+    return addListener(CallbackType::PPS, reinterpret_cast<uintptr_t>(callback), Source_Pps,
+                       [callback, userDataP](const void *header) {
+                           callback(*static_cast<const pps::Header*>(header), userDataP);
+                       });
+}
+
+Status MockChannel::addIsolatedCallback(imu::Callback callback, void *userDataP)
+{
+    return addListener(CallbackType::IMU, reinterpret_cast<uintptr_t>(callback), Source_Imu,
+                       [callback, userDataP](const void *header) {
+                           callback(*static_cast<const imu::Header*>(header), userDataP);
+                       });
+}
+
+Status MockChannel::addIsolatedCallback(compressed_image::Callback callback, DataSource imageSourceMask, void *userDataP)
+{
+    //
+    // Compressed streams are never generated, but the callback is registered so it can be removed
+
+    return addListener(CallbackType::COMPRESSED_IMAGE, reinterpret_cast<uintptr_t>(callback), imageSourceMask,
+                       [callback, userDataP](const void *header) {
+                           callback(*static_cast<const compressed_image::Header*>(header), userDataP);
+                       });
+}
+
+Status MockChannel::addIsolatedCallback(ground_surface::Callback callback, void *userDataP)
+{
+    return addListener(CallbackType::GROUND_SURFACE, reinterpret_cast<uintptr_t>(callback),
+                       Source_Ground_Surface_Spline_Data,
+                       [callback, userDataP](const void *header) {
+                           callback(*static_cast<const ground_surface::Header*>(header), userDataP);
+                       });
+}
+
+Status MockChannel::removeIsolatedCallback(image::Callback callback)
+{
+    return removeListener(CallbackType::IMAGE, reinterpret_cast<uintptr_t>(callback));
+}
+
+Status MockChannel::removeIsolatedCallback(lidar::Callback callback)
+{
+    return removeListener(CallbackType::LIDAR, reinterpret_cast<uintptr_t>(callback));
+}
+
+Status MockChannel::removeIsolatedCallback(pps::Callback callback)
+{
+    return removeListener(CallbackType::PPS, reinterpret_cast<uintptr_t>(callback));
+}
+
+Status MockChannel::removeIsolatedCallback(imu::Callback callback)
+{
+    return removeListener(CallbackType::IMU, reinterpret_cast<uintptr_t>(callback));
+}
+
+Status MockChannel::removeIsolatedCallback(compressed_image::Callback callback)
+{
+    return removeListener(CallbackType::COMPRESSED_IMAGE, reinterpret_cast<uintptr_t>(callback));
+}
+
+Status MockChannel::removeIsolatedCallback(ground_surface::Callback callback)
+{
+    return removeListener(CallbackType::GROUND_SURFACE, reinterpret_cast<uintptr_t>(callback));
+}
+
+void* MockChannel::reserveCallbackBuffer()
+{
+    if (nullptr == dispatching_payload) {
+        return nullptr;
+    }
+
+    if (reserved_buffers_.fetch_add(1) >= config_.callback_buffers) {
+        reserved_buffers_.fetch_sub(1);
+        recordFailedReservation(*dispatching_stream);
+        return nullptr;
+    }
+
+    return new PayloadT(*dispatching_payload);
+}
+
+Status MockChannel::releaseCallbackBuffer(void *referenceP)
+{
+    if (nullptr == referenceP) {
+        return Status_Error;
+    }
+
+    delete static_cast<PayloadT*>(referenceP);
+    reserved_buffers_.fetch_sub(1);
+
+    return Status_Ok;
+}
+
+Status MockChannel::networkTimeSynchronization(bool)
+{
+    return Status_Ok;
+}
+
+Status MockChannel::ptpTimeSynchronization(bool)
+{
+    return Status_Ok;
+}
+
+Status MockChannel::startStreams(DataSource mask)
+{
+    enabled_streams_.fetch_or(mask);
+    return Status_Ok;
+}
+
+Status MockChannel::stopStreams(DataSource mask)
+{
+    enabled_streams_.fetch_and(~mask);
+    return Status_Ok;
+}
+
+Status MockChannel::getEnabledStreams(DataSource &mask)
+{
+    mask = enabled_streams_.load();
+    return Status_Ok;
+}
+
+Status MockChannel::startDirectedStream(const DirectedStream&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::startDirectedStreams(const std::vector<DirectedStream>&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::stopDirectedStream(const DirectedStream&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::getDirectedStreams(std::vector<DirectedStream>&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::maxDirectedStreams(uint32_t&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::setTriggerSource(TriggerSource)
+{
+    return Status_Ok;
+}
+
+Status MockChannel::setMotorSpeed(float rpm)
+{
+    if (DeviceType::SL != config_.device) {
+        return Status_Unsupported;
+    }
+
+    motor_rpm_ = rpm;
+    return Status_Ok;
+}
+
+Status MockChannel::getLightingConfig(lighting::Config&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::setLightingConfig(const lighting::Config&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::getLightingSensorStatus(lighting::SensorStatus&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::getSensorVersion(VersionType &version)
+{
+    version = FIRMWARE_VERSION;
+    return Status_Ok;
+}
+
+Status MockChannel::getApiVersion(VersionType &version)
+{
+    version = API_VERSION;
+    return Status_Ok;
+}
+
+Status MockChannel::getVersionInfo(system::VersionInfo &v)
+{
+    v.apiBuildDate = "mock";
+    v.apiVersion = API_VERSION;
+    v.sensorFirmwareBuildDate = "mock";
+    v.sensorFirmwareVersion = FIRMWARE_VERSION;
+    v.sensorHardwareVersion = 0;
+    v.sensorHardwareMagic = 0;
+    v.sensorFpgaDna = 0;
+
+    return Status_Ok;
+}
+
+Status MockChannel::getImageConfig(image::Config &c)
+{
+    std::lock_guard<std::mutex> lock(config_mutex_);
+
+    c = image_config_;
+    return Status_Ok;
+}
+
+Status MockChannel::setImageConfig(const image::Config &c)
+{
+    //
+    // Only full, half and quarter resolution modes are supported
+
+    bool supported = false;
+    for (uint32_t divisor : {1, 2, 4}) {
+        supported |= c.width() == device_info_.imagerWidth / divisor && c.height() == device_info_.imagerHeight / divisor;
+    }
+
+    if (!supported) {
+        return Status_Error;
+    }
+
+    std::lock_guard<std::mutex> lock(config_mutex_);
+
+    //
+    // Report the rectified intrinsics scaled to the operating resolution, like the sensor does
+
+    const double scale = static_cast<double>(c.width()) / static_cast<double>(device_info_.imagerWidth);
+    const double tx = image_calibration_.right.P[0][3] / image_calibration_.right.P[0][0];
+
+    image_config_ = c;
+    image_config_.setCal(image_calibration_.left.P[0][0] * scale,
+                         image_calibration_.left.P[1][1] * scale,
+                         image_calibration_.left.P[0][2] * scale,
+                         image_calibration_.left.P[1][2] * scale,
+                         tx, 0.0f, 0.0f,
+                         0.0f, 0.0f, 0.0f);
+
+    if (c.fps() > 0.0f) {
+        image_fps_ = c.fps();
+    }
+
+    buildImagePayloads();
+
+    return Status_Ok;
+}
+
+Status MockChannel::getRemoteHeadConfig(image::RemoteHeadConfig&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::setRemoteHeadConfig(const image::RemoteHeadConfig&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::getImageCalibration(image::Calibration &c)
+{
+    std::lock_guard<std::mutex> lock(config_mutex_);
+
+    c = image_calibration_;
+    return Status_Ok;
+}
+
+Status MockChannel::setImageCalibration(const image::Calibration &c)
+{
+    std::lock_guard<std::mutex> lock(config_mutex_);
+
+    image_calibration_ = c;
+    return Status_Ok;
+}
+
+Status MockChannel::getTransmitDelay(image::TransmitDelay &c)
+{
+    c.delay = 0;
+    return Status_Ok;
+}
+
+Status MockChannel::setTransmitDelay(const image::TransmitDelay&)
+{
+    return Status_Ok;
+}
+
+Status MockChannel::getImageHistogram(int64_t, image::Histogram &histogram)
+{
+    histogram.channels = HISTOGRAM_CHANNELS;
+    histogram.bins = HISTOGRAM_BINS;
+    histogram.data.assign(HISTOGRAM_CHANNELS * HISTOGRAM_BINS, 0);
+
+    return Status_Ok;
+}
+
+Status MockChannel::getLidarCalibration(lidar::Calibration &c)
+{
+    if (DeviceType::SL != config_.device) {
+        return Status_Unsupported;
+    }
+
+    std::lock_guard<std::mutex> lock(config_mutex_);
+
+    c = lidar_calibration_;
+    return Status_Ok;
+}
+
+Status MockChannel::setLidarCalibration(const lidar::Calibration &c)
+{
+    if (DeviceType::SL != config_.device) {
+        return Status_Unsupported;
+    }
+
+    std::lock_guard<std::mutex> lock(config_mutex_);
+
+    lidar_calibration_ = c;
+    return Status_Ok;
+}
+
+Status MockChannel::getPtpStatus(int64_t, system::PtpStatus&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::getDeviceModes(std::vector<system::DeviceMode> &modes)
+{
+    DataSource sources = 0;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+
+        for (const auto &payload : image_payloads_) {
+            sources |= payload.source;
+        }
+    }
+
+    modes.clear();
+
+    for (uint32_t divisor : {1, 2, 4}) {
+        for (int32_t disparities : {64, 128, 256}) {
+            system::DeviceMode mode;
+            mode.width = device_info_.imagerWidth / divisor;
+            mode.height = device_info_.imagerHeight / divisor;
+            mode.supportedDataSources = sources;
+            mode.disparities = disparities;
+
+            modes.push_back(mode);
+        }
+    }
+
+    return Status_Ok;
+}
+
+Status MockChannel::getMtu(int32_t &mtu)
+{
+    mtu = mtu_;
+    return Status_Ok;
+}
+
+Status MockChannel::setMtu(int32_t mtu)
+{
+    mtu_ = mtu;
+    return Status_Ok;
+}
+
+Status MockChannel::getMotorPos(int32_t &mtu)
+{
+    if (DeviceType::SL != config_.device) {
+        return Status_Unsupported;
+    }
+
+    mtu = spindle_angle_;
+    return Status_Ok;
+}
+
+Status MockChannel::getNetworkConfig(system::NetworkConfig&)
+{
+    return Status_Ok;
+}
+
+Status MockChannel::setNetworkConfig(const system::NetworkConfig&)
+{
+    return Status_Ok;
+}
+
+Status MockChannel::getDeviceInfo(system::DeviceInfo &info)
+{
+    info = device_info_;
+    return Status_Ok;
+}
+
+Status MockChannel::setDeviceInfo(const std::string&, const system::DeviceInfo&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::getDeviceStatus(system::StatusMessage &status)
+{
+    status.uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    status.systemOk = true;
+    status.laserOk = DeviceType::SL == config_.device;
+    status.laserMotorOk = DeviceType::SL == config_.device;
+    status.camerasOk = true;
+    status.imuOk = true;
+    status.externalLedsOk = false;
+    status.processingPipelineOk = true;
+    status.powerSupplyTemperature = 40.0f;
+    status.fpgaTemperature = 50.0f;
+    status.leftImagerTemperature = 40.0f;
+    status.rightImagerTemperature = 40.0f;
+    status.inputVoltage = 24.0f;
+    status.inputCurrent = 0.5f;
+    status.fpgaPower = 5.0f;
+    status.logicPower = 2.0f;
+    status.imagerPower = 1.0f;
+
+    return Status_Ok;
+}
+
+Status MockChannel::getExternalCalibration(system::ExternalCalibration &calibration)
+{
+    std::lock_guard<std::mutex> lock(config_mutex_);
+
+    calibration = external_calibration_;
+    return Status_Ok;
+}
+
+Status MockChannel::setExternalCalibration(const system::ExternalCalibration &calibration)
+{
+    std::lock_guard<std::mutex> lock(config_mutex_);
+
+    external_calibration_ = calibration;
+    return Status_Ok;
+}
+
+Status MockChannel::setGroundSurfaceParams(const system::GroundSurfaceParams&)
+{
+    return DeviceType::S30 == config_.device ? Status_Ok : Status_Unsupported;
+}
+
+Status MockChannel::flashBitstream(const std::string&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::flashFirmware(const std::string&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::verifyBitstream(const std::string&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::verifyFirmware(const std::string&)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::getImuInfo(uint32_t &maxSamplesPerMessage, std::vector<imu::Info> &info)
+{
+    maxSamplesPerMessage = IMU_MAX_SAMPLES_PER_MESSAGE;
+    info.clear();
+
+    return Status_Ok;
+}
+
+Status MockChannel::getImuConfig(uint32_t &samplesPerMessage, std::vector<imu::Config> &c)
+{
+    samplesPerMessage = imu_samples_per_message_;
+    c.clear();
+
+    return Status_Ok;
+}
+
+Status MockChannel::setImuConfig(bool, uint32_t samplesPerMessage, const std::vector<imu::Config>&)
+{
+    if (samplesPerMessage == 0 || samplesPerMessage > IMU_MAX_SAMPLES_PER_MESSAGE) {
+        return Status_Error;
+    }
+
+    imu_samples_per_message_ = samplesPerMessage;
+    return Status_Ok;
+}
+
+Status MockChannel::getLargeBufferDetails(uint32_t &bufferCount, uint32_t &bufferSize)
+{
+    bufferCount = static_cast<uint32_t>(config_.callback_buffers);
+    bufferSize = device_info_.imagerWidth * device_info_.imagerHeight * sizeof(uint16_t);
+
+    return Status_Ok;
+}
+
+Status MockChannel::setLargeBuffers(const std::vector<uint8_t*>&, uint32_t)
+{
+    return Status_Unsupported;
+}
+
+Status MockChannel::getLocalUdpPort(uint16_t &port)
+{
+    port = 0;
+    return Status_Ok;
+}
+
+Status MockChannel::addListener(CallbackType type, uintptr_t key, DataSource mask, const Listener::CallbackT &callback)
+{
+    std::lock_guard<std::mutex> lock(listener_mutex_);
+
+    listeners_.emplace_back(new Listener(this, type, key, mask, callback));
+    return Status_Ok;
+}
+
+Status MockChannel::removeListener(CallbackType type, uintptr_t key)
+{
+    //
+    // Listeners are destroyed without the lock held, since their threads may be inside a callback which is waiting
+    // on another driver call
+
+    std::vector<std::unique_ptr<Listener>> removed;
+    {
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+
+        auto it = listeners_.begin();
+        while (it != listeners_.end()) {
+            if ((*it)->type() == type && (*it)->key() == key) {
+                removed.push_back(std::move(*it));
+                it = listeners_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return removed.empty() ? Status_Error : Status_Ok;
+}
+
+void MockChannel::dispatch(CallbackType type,
+                           DataSource source,
+                           const std::string &stream,
+                           const PayloadT &payload,
+                           const std::shared_ptr<const void> &header)
+{
+    std::lock_guard<std::mutex> lock(listener_mutex_);
+
+    for (const auto &listener : listeners_) {
+        if (listener->type() != type || !(listener->mask() & source)) {
+            continue;
+        }
+
+        recordGenerated(stream, listener->post(stream, payload, header));
+    }
+}
+
+void MockChannel::runGenerator(const std::function<double()> &rate, const std::function<void()> &generate)
+{
+    std::mt19937 generator(std::random_device{}());
+    std::normal_distribution<double> jitter(0.0, config_.jitter);
+
+    auto next = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(shutdown_mutex_);
+    while (!shutdown_) {
+
+        const double current_rate = rate();
+        if (current_rate <= 0.0) {
+            next = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+            shutdown_condition_.wait_until(lock, next, [this]() { return shutdown_; });
+            continue;
+        }
+
+        lock.unlock();
+        generate();
+        lock.lock();
+
+        const double period = std::max(0.0, (1.0 + (config_.jitter > 0.0 ? jitter(generator) : 0.0)) / current_rate);
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(period));
+
+        //
+        // Restart the schedule rather than bursting to catch up if the generator fell far behind
+
+        const auto now = std::chrono::steady_clock::now();
+        if (next + std::chrono::seconds(1) < now) {
+            next = now;
+        }
+
+        shutdown_condition_.wait_until(lock, next, [this]() { return shutdown_; });
+    }
+}
+
+void MockChannel::generateImages()
+{
+    std::vector<ImagePayloadT> image_payloads;
+    PayloadT ground_surface_payload;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        image_payloads = image_payloads_;
+        ground_surface_payload = ground_surface_payload_;
+    }
+
+    const int64_t frame_id = ++frame_id_;
+
+    uint32_t seconds = 0;
+    uint32_t microseconds = 0;
+    wallTime(seconds, microseconds);
+
+    for (const auto &payload : image_payloads) {
+
+        if (!enabled(payload.source)) {
+            continue;
+        }
+
+        auto header = std::make_shared<image::Header>();
+        header->source = payload.source;
+        header->bitsPerPixel = payload.bits_per_pixel;
+        header->width = payload.width;
+        header->height = payload.height;
+        header->frameId = frame_id;
+        header->timeSeconds = seconds;
+        header->timeMicroSeconds = microseconds;
+        header->exposure = 10000;
+        header->gain = 1.0f;
+        header->framesPerSecond = static_cast<float>(image_fps_.load());
+        header->imageLength = payload.length;
+        header->imageDataP = payload.data_p;
+
+        dispatch(CallbackType::IMAGE, payload.source, streamName(payload.source), payload.data, header);
+    }
+
+    if (ground_surface_payload && enabled(Source_Ground_Surface_Spline_Data)) {
+
+        const auto spline = std::static_pointer_cast<const GroundSurfacePayloadT>(ground_surface_payload);
+
+        auto header = std::make_shared<ground_surface::Header>(spline->header);
+        header->frameId = frame_id;
+        header->timestamp = static_cast<int64_t>(seconds) * 1000000000ll + static_cast<int64_t>(microseconds) * 1000ll;
+
+        dispatch(CallbackType::GROUND_SURFACE, Source_Ground_Surface_Spline_Data, "ground_surface_spline",
+                 ground_surface_payload, header);
+    }
+}
+
+void MockChannel::generateLidarScan()
+{
+    if (!enabled(Source_Lidar_Scan)) {
+        return;
+    }
+
+    const auto lidar = std::static_pointer_cast<const LidarPayloadT>(lidar_payload_);
+
+    //
+    // The spindle turns through the scan at the current motor speed
+
+    const double scan_seconds = 1.0 / config_.lidar_scan_rate;
+    const int32_t spindle_start = spindle_angle_;
+    const double spindle_travel = 2.0 * M_PI * (motor_rpm_ / 60.0) * scan_seconds;
+    const int32_t spindle_end = static_cast<int32_t>(std::fmod(1e-6 * spindle_start + spindle_travel, 2.0 * M_PI) * 1e6);
+    spindle_angle_ = spindle_end;
+
+    uint32_t seconds = 0;
+    uint32_t microseconds = 0;
+    wallTime(seconds, microseconds);
+
+    const uint64_t end_microseconds = static_cast<uint64_t>(seconds) * 1000000 + microseconds;
+    const uint64_t start_microseconds = end_microseconds - static_cast<uint64_t>(scan_seconds * 1e6);
+
+    auto header = std::make_shared<lidar::Header>();
+    header->scanId = scan_id_++;
+    header->timeStartSeconds = static_cast<uint32_t>(start_microseconds / 1000000);
+    header->timeStartMicroSeconds = static_cast<uint32_t>(start_microseconds % 1000000);
+    header->timeEndSeconds = seconds;
+    header->timeEndMicroSeconds = microseconds;
+    header->spindleAngleStart = spindle_start;
+    header->spindleAngleEnd = spindle_end;
+    header->scanArc = static_cast<int32_t>(LIDAR_ARC * 1e6);
+    header->maxRange = LIDAR_MAX_RANGE_MM;
+    header->pointCount = lidar_point_count_;
+    header->rangesP = lidar->ranges.data();
+    header->intensitiesP = lidar->intensities.data();
+
+    dispatch(CallbackType::LIDAR, Source_Lidar_Scan, "lidar_scan", lidar_payload_, header);
+}
+
+void MockChannel::generateImu()
+{
+    if (!enabled(Source_Imu)) {
+        return;
+    }
+
+    //
+    // Each message holds samples_per_message accelerometer and gyroscope samples, spread evenly over the message
+    // period. The sensor is at rest
+
+    const uint32_t samples_per_message = imu_samples_per_message_;
+    const uint64_t sample_microseconds = static_cast<uint64_t>(1e6 / config_.imu_sample_rate);
+
+    uint32_t seconds = 0;
+    uint32_t microseconds = 0;
+    wallTime(seconds, microseconds);
+    const uint64_t now = static_cast<uint64_t>(seconds) * 1000000 + microseconds;
+
+    auto header = std::make_shared<imu::Header>();
+    header->sequence = imu_sequence_++;
+    header->samples.reserve(2 * samples_per_message);
+
+    for (uint32_t i = 0 ; i < samples_per_message ; ++i) {
+
+        const uint64_t time = now - (samples_per_message - 1 - i) * sample_microseconds;
+
+        imu::Sample sample;
+        sample.timeSeconds = static_cast<uint32_t>(time / 1000000);
+        sample.timeMicroSeconds = static_cast<uint32_t>(time % 1000000);
+
+        sample.type = imu::Sample::Type_Accelerometer;
+        sample.x = 0.0f;
+        sample.y = 0.0f;
+        sample.z = 1.0f;
+        header->samples.push_back(sample);
+
+        sample.type = imu::Sample::Type_Gyroscope;
+        sample.z = 0.0f;
+        header->samples.push_back(sample);
+    }
+
+    dispatch(CallbackType::IMU, Source_Imu, "imu", nullptr, header);
+}
+
+void MockChannel::generatePps()
+{
+    uint32_t seconds = 0;
+    uint32_t microseconds = 0;
+    wallTime(seconds, microseconds);
+
+    auto header = std::make_shared<pps::Header>();
+    header->sensorTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start_time_).count();
+    header->timeSeconds = seconds;
+    header->timeMicroSeconds = microseconds;
+
+    dispatch(CallbackType::PPS, Source_Pps, "pps", nullptr, header);
+}
+
+void MockChannel::buildImagePayloads()
+{
+    const uint32_t width = image_config_.width();
+    const uint32_t height = image_config_.height();
+    const bool sl = DeviceType::SL == config_.device;
+
+    const double scale = static_cast<double>(width) / static_cast<double>(device_info_.imagerWidth);
+    const double focal_length = FOCAL_LENGTH * scale;
+    const double horizon = height / 2.0;
+
+    //
+    // Luma, from a recording or a synthetic checkerboard
+
+    std::shared_ptr<const std::vector<uint8_t>> luma;
+
+    const cv::Mat recorded_luma = loadRecordedImage(config_.luma_image, cv::IMREAD_GRAYSCALE, CV_8UC1,
+                                                    cv::INTER_AREA, width, height);
+    if (!recorded_luma.empty()) {
+        luma = matToPayload<uint8_t>(recorded_luma);
+    } else {
+        auto synthetic = std::make_shared<std::vector<uint8_t>>(width * height);
+        for (uint32_t v = 0 ; v < height ; ++v) {
+            for (uint32_t u = 0 ; u < width ; ++u) {
+                (*synthetic)[v * width + u] = static_cast<uint8_t>((((u / 32) + (v / 32)) % 2 ? 160 : 64) + (u % 32));
+            }
+        }
+        luma = synthetic;
+    }
+
+    //
+    // Disparity in 1/16th pixels, from a recording or the synthetic floor and wall
+
+    std::shared_ptr<const std::vector<uint16_t>> disparity;
+
+    const cv::Mat recorded_disparity = loadRecordedImage(config_.disparity_image, cv::IMREAD_ANYDEPTH, CV_16UC1,
+                                                         cv::INTER_NEAREST, width, height);
+    if (!recorded_disparity.empty()) {
+        disparity = matToPayload<uint16_t>(recorded_disparity);
+    } else {
+        const double baseline = device_info_.nominalBaseline;
+        const double wall_disparity = focal_length * baseline / WALL_DISTANCE;
+        const double max_disparity = static_cast<double>(image_config_.disparities() > 0 ?
+                                                         image_config_.disparities() - 1 : DISPARITIES - 1);
+
+        auto synthetic = std::make_shared<std::vector<uint16_t>>(width * height);
+        for (uint32_t v = 0 ; v < height ; ++v) {
+
+            const double floor_disparity = baseline * (static_cast<double>(v) - horizon) / CAMERA_HEIGHT;
+            const double d = std::min(std::max(floor_disparity, wall_disparity), max_disparity);
+
+            std::fill(synthetic->begin() + v * width, synthetic->begin() + (v + 1) * width,
+                      static_cast<uint16_t>(16.0 * d));
+        }
+        disparity = synthetic;
+    }
+
+    //
+    // Interleaved CbCr at half resolution with a smooth color gradient
+
+    const auto make_chroma = [](uint32_t luma_width, uint32_t luma_height) {
+        auto chroma = std::make_shared<std::vector<uint8_t>>(2 * (luma_width / 2) * (luma_height / 2));
+        for (uint32_t v = 0 ; v < luma_height / 2 ; ++v) {
+            for (uint32_t u = 0 ; u < luma_width / 2 ; ++u) {
+                const size_t offset = 2 * (v * (luma_width / 2) + u);
+                (*chroma)[offset + 0] = static_cast<uint8_t>(64 + (128 * u) / std::max(luma_width / 2, 1u));
+                (*chroma)[offset + 1] = static_cast<uint8_t>(64 + (128 * v) / std::max(luma_height / 2, 1u));
+            }
+        }
+        return std::shared_ptr<const std::vector<uint8_t>>(chroma);
+    };
+
+    auto cost = std::make_shared<const std::vector<uint8_t>>(width * height, 8);
+
+    image_payloads_.clear();
+
+    const auto add = [this](DataSource source, uint32_t bits_per_pixel, uint32_t w, uint32_t h, const PayloadT &data,
+                            const void *data_p, size_t length) {
+        ImagePayloadT payload;
+        payload.source = source;
+        payload.bits_per_pixel = bits_per_pixel;
+        payload.width = w;
+        payload.height = h;
+        payload.data = data;
+        payload.data_p = data_p;
+        payload.length = static_cast<uint32_t>(length);
+
+        image_payloads_.push_back(payload);
+    };
+
+    const size_t luma_bytes = luma->size();
+    const size_t disparity_bytes = disparity->size() * sizeof(uint16_t);
+
+    add(Source_Luma_Left, 8, width, height, luma, luma->data(), luma_bytes);
+    add(Source_Luma_Right, 8, width, height, luma, luma->data(), luma_bytes);
+    add(Source_Luma_Rectified_Left, 8, width, height, luma, luma->data(), luma_bytes);
+    add(Source_Luma_Rectified_Right, 8, width, height, luma, luma->data(), luma_bytes);
+    add(Source_Disparity, 16, width, height, disparity, disparity->data(), disparity_bytes);
+    add(Source_Disparity_Right, 16, width, height, disparity, disparity->data(), disparity_bytes);
+    add(Source_Disparity_Cost, 8, width, height, cost, cost->data(), cost->size());
+
+    if (sl) {
+        const auto chroma = make_chroma(width, height);
+        add(Source_Chroma_Left, 16, width / 2, height / 2, chroma, chroma->data(), chroma->size());
+
+        ground_surface_payload_ = nullptr;
+        return;
+    }
+
+    //
+    // S30 aux camera. The aux imager is shorter than the stereo imagers
+
+    const uint32_t aux_height = static_cast<uint32_t>(S30_AUX_CAM_HEIGHT * static_cast<double>(height) /
+                                                      static_cast<double>(device_info_.imagerHeight));
+
+    std::shared_ptr<const std::vector<uint8_t>> aux_luma = luma;
+    if (aux_height != height) {
+        aux_luma = std::make_shared<const std::vector<uint8_t>>(luma->begin(), luma->begin() + width * aux_height);
+    }
+
+    const auto aux_chroma = make_chroma(width, aux_height);
+
+    add(Source_Luma_Aux, 8, width, aux_height, aux_luma, aux_luma->data(), aux_luma->size());
+    add(Source_Luma_Rectified_Aux, 8, width, aux_height, aux_luma, aux_luma->data(), aux_luma->size());
+    add(Source_Chroma_Aux, 16, width / 2, aux_height / 2, aux_chroma, aux_chroma->data(), aux_chroma->size());
+    add(Source_Chroma_Rectified_Aux, 16, width / 2, aux_height / 2, aux_chroma, aux_chroma->data(), aux_chroma->size());
+
+    //
+    // Ground surface class image: out of bounds above the horizon, free space on the floor with an obstacle in the
+    // middle third of the image
+
+    auto classes = std::make_shared<std::vector<uint8_t>>(width * height);
+    for (uint32_t v = 0 ; v < height ; ++v) {
+        for (uint32_t u = 0 ; u < width ; ++u) {
+            const bool obstacle = u > width / 3 && u < 2 * width / 3 && v > horizon && v < horizon + height / 8;
+            (*classes)[v * width + u] = v < horizon ? 1 : (obstacle ? 2 : 3);
+        }
+    }
+
+    add(Source_Ground_Surface_Class_Image, 8, width, height, classes, classes->data(), classes->size());
+
+    //
+    // Spline model of a gently curved floor. The cell origin leaves one control point of padding around the drawn
+    // region so every sample interpolates inside the grid
+
+    auto spline = std::make_shared<GroundSurfacePayloadT>();
+    spline->control_grid.resize(CONTROL_GRID_ROWS * CONTROL_GRID_COLS);
+    for (uint32_t r = 0 ; r < CONTROL_GRID_ROWS ; ++r) {
+        for (uint32_t c = 0 ; c < CONTROL_GRID_COLS ; ++c) {
+            spline->control_grid[r * CONTROL_GRID_COLS + c] = 0.05f * std::sin(0.5f * r) * std::cos(0.3f * c);
+        }
+    }
+
+    ground_surface::Header &header = spline->header;
+    header.frameId = 0;
+    header.timestamp = 0;
+    header.success = 1;
+    header.controlPointsBitsPerPixel = 32;
+    header.controlPointsWidth = CONTROL_GRID_COLS;
+    header.controlPointsHeight = CONTROL_GRID_ROWS;
+    header.controlPointsImageDataP = spline->control_grid.data();
+
+    const float xz_cell_origin[2] = {-28.0f, -3.0f};
+    const float xz_cell_size[2] = {2.0f, 2.0f};
+    const float xz_limit[2] = {25.0f, 30.0f};
+    const float half_fov = static_cast<float>(std::atan(horizon / focal_length));
+    const float extrinsics[6] = {0.0f, static_cast<float>(CAMERA_HEIGHT), 0.0f, 0.0f, 0.0f, 0.0f};
+
+    std::copy(xz_cell_origin, xz_cell_origin + 2, header.xzCellOrigin);
+    std::copy(xz_cell_size, xz_cell_size + 2, header.xzCellSize);
+    std::copy(xz_limit, xz_limit + 2, header.xzLimit);
+    header.minMaxAzimuthAngle[0] = static_cast<float>(M_PI_2) - half_fov;
+    header.minMaxAzimuthAngle[1] = static_cast<float>(M_PI_2) + half_fov;
+    std::copy(extrinsics, extrinsics + 6, header.extrinsics);
+    std::fill(header.quadraticParams, header.quadraticParams + 6, 0.0f);
+
+    ground_surface_payload_ = spline;
+}
+
+MockChannel::StreamStatsT& MockChannel::streamStats(const std::string &stream)
+{
+    auto it = stats_.find(stream);
+    if (it == stats_.end()) {
+        StreamStatsT stats;
+        stats.name = stream;
+        stats.subsystem = stream == "lidar_scan" ? "lidar" : stream == "imu" ? "imu" : stream == "pps" ? "pps" : "camera";
+
+        it = stats_.emplace(stream, stats).first;
+    }
+
+    return it->second;
+}
+
+void MockChannel::recordCallback(const std::string &stream, double cpu_seconds)
+{
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+
+    auto &stats = streamStats(stream);
+    ++stats.delivered;
+    stats.cpu_seconds += cpu_seconds;
+}
+
+void MockChannel::recordGenerated(const std::string &stream, const std::string &dropped_stream)
+{
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+
+    ++streamStats(stream).generated;
+
+    if (!dropped_stream.empty()) {
+        ++streamStats(dropped_stream).dropped;
+    }
+}
+
+void MockChannel::recordFailedReservation(const std::string &stream)
+{
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+
+    ++streamStats(stream).failed_reservations;
+}
+
+bool MockChannel::enabled(DataSource source) const
+{
+    return enabled_streams_.load() & source;
+}
+
+}// namespace
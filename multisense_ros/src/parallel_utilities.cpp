@@ -0,0 +1,295 @@
+/**
+ * @file parallel_utilities.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <ros/ros.h>
+
+#include <multisense_ros/parallel_utilities.h>
+
+namespace multisense_ros {
+
+RowBandExecutor::RowBandExecutor(size_t threads):
+    bands_(threads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : threads)
+{
+    for (size_t band = 1 ; band < bands_ ; ++band)
+    {
+        workers_.emplace_back(&RowBandExecutor::worker, this, band);
+    }
+}
+
+RowBandExecutor::~RowBandExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+
+    work_cv_.notify_all();
+
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+size_t RowBandExecutor::bands() const noexcept
+{
+    return bands_;
+}
+
+void RowBandExecutor::run(size_t rows, const BandFunction &function)
+{
+    //
+    // A single band runs on the calling thread, so concurrent callers do not need to be serialized
+
+    if (bands_ == 1)
+    {
+        function(0, 0, rows);
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        function_ = &function;
+        rows_ = rows;
+        pending_ = bands_ - 1;
+        ++generation_;
+    }
+
+    work_cv_.notify_all();
+
+    processBand(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() { return pending_ == 0; });
+
+    function_ = nullptr;
+}
+
+void RowBandExecutor::worker(size_t band)
+{
+    uint64_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this, generation]() { return shutdown_ || generation_ != generation; });
+
+            if (shutdown_)
+            {
+                return;
+            }
+
+            generation = generation_;
+        }
+
+        processBand(band);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --pending_;
+        }
+
+        done_cv_.notify_one();
+    }
+}
+
+void RowBandExecutor::processBand(size_t band)
+{
+    const size_t begin_row = band * rows_ / bands_;
+    const size_t end_row = (band + 1) * rows_ / bands_;
+
+    (*function_)(band, begin_row, end_row);
+}
+
+WorkerPool::WorkerPool(size_t threads, size_t queue_depth, const std::vector<int> &cpu_affinity):
+    queue_depth_(std::max(queue_depth, static_cast<size_t>(1))),
+    next_queue_(std::end(queues_))
+{
+    for (size_t i = 0 ; i < std::max(threads, static_cast<size_t>(1)) ; ++i)
+    {
+        workers_.emplace_back(&WorkerPool::worker, this);
+
+        if (cpu_affinity.empty())
+        {
+            continue;
+        }
+
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+
+        for (const auto &cpu : cpu_affinity)
+        {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+            {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+
+        if (0 != pthread_setaffinity_np(workers_.back().native_handle(), sizeof(cpus), &cpus))
+        {
+            ROS_WARN("WorkerPool: failed to set the CPU affinity of worker %zu", i);
+        }
+#else
+        ROS_WARN("WorkerPool: CPU affinity is not supported on this platform");
+#endif
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+
+    work_cv_.notify_all();
+
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+void WorkerPool::post(const std::string &queue, Task task)
+{
+    //
+    // Dropped tasks are destroyed outside of the lock since they may own driver buffers
+
+    std::vector<Task> dropped;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto &q = queues_[queue];
+        q.stats.name = queue;
+
+        while (q.tasks.size() >= queue_depth_)
+        {
+            dropped.push_back(std::move(q.tasks.front()));
+            q.tasks.pop_front();
+            ++q.stats.dropped;
+        }
+
+        q.tasks.push_back(std::move(task));
+        q.stats.max_depth = std::max(q.stats.max_depth, q.tasks.size());
+    }
+
+    work_cv_.notify_one();
+}
+
+std::vector<WorkerPool::QueueStatsT> WorkerPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<QueueStatsT> stats;
+    stats.reserve(queues_.size());
+
+    for (const auto &queue : queues_)
+    {
+        stats.push_back(queue.second.stats);
+        stats.back().depth = queue.second.tasks.size();
+    }
+
+    return stats;
+}
+
+void WorkerPool::worker()
+{
+    while (true)
+    {
+        QueueT *queue = nullptr;
+        Task task;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this, &queue]() { return shutdown_ || (queue = nextQueue()) != nullptr; });
+
+            if (shutdown_)
+            {
+                return;
+            }
+
+            task = std::move(queue->tasks.front());
+            queue->tasks.pop_front();
+            queue->running = true;
+        }
+
+        task();
+        task = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue->running = false;
+            ++queue->stats.processed;
+        }
+
+        //
+        // The queue we just finished may have more work which was skipped while it was running
+
+        work_cv_.notify_one();
+    }
+}
+
+WorkerPool::QueueT* WorkerPool::nextQueue()
+{
+    //
+    // Round robin across the queues starting after the last queue serviced so a busy queue cannot starve the others
+
+    for (size_t i = 0 ; i < queues_.size() ; ++i)
+    {
+        if (next_queue_ == std::end(queues_) || ++next_queue_ == std::end(queues_))
+        {
+            next_queue_ = std::begin(queues_);
+        }
+
+        if (!next_queue_->second.running && !next_queue_->second.tasks.empty())
+        {
+            return &(next_queue_->second);
+        }
+    }
+
+    return nullptr;
+}
+
+}// namespace
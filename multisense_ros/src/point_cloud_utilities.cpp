@@ -31,6 +31,8 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **/
 
+#include <ros/ros.h>
+
 #include <multisense_ros/point_cloud_utilities.h>
 
 namespace multisense_ros {
@@ -83,4 +85,51 @@ uint8_t message_format<double>()
     return sensor_msgs::PointField::FLOAT64;
 }
 
+sensor_msgs::PointCloud2 initialize_pointcloud(PointLayout layout,
+                                               bool dense,
+                                               const std::string& frame_id,
+                                               const std::vector<PointChannel> &channels)
+{
+    switch (layout)
+    {
+        case PointLayout::XYZ:
+            return initialize_pointcloud<PointLayout::XYZ>(dense, frame_id, channels);
+        case PointLayout::XYZ_PAD_CHANNELS:
+            return initialize_pointcloud<PointLayout::XYZ_PAD_CHANNELS>(dense, frame_id, channels);
+        case PointLayout::XYZ_CHANNELS:
+            break;
+    }
+
+    return initialize_pointcloud<PointLayout::XYZ_CHANNELS>(dense, frame_id, channels);
+}
+
+PointLayout point_layout_param(const ros::NodeHandle &nh, const std::string &topic, PointLayout default_layout)
+{
+    const std::string param = topic + "_layout";
+
+    std::string layout;
+    if (!nh.getParam(param, layout))
+    {
+        return default_layout;
+    }
+
+    if (layout == "xyz")
+    {
+        return PointLayout::XYZ;
+    }
+    else if (layout == "xyz_channels")
+    {
+        return PointLayout::XYZ_CHANNELS;
+    }
+    else if (layout == "xyz_pad_channels")
+    {
+        return PointLayout::XYZ_PAD_CHANNELS;
+    }
+
+    ROS_ERROR("multisense_ros: invalid point layout \"%s\" for %s, using the default layout",
+              layout.c_str(), param.c_str());
+
+    return default_layout;
+}
+
 }// namespace
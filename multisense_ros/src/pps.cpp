@@ -51,9 +51,9 @@ void ppsCB(const pps::Header& header, void* userDataP)
 
 } // anonymous
 
-Pps::Pps(Channel* driver) :
+Pps::Pps(Channel* driver, const ros::NodeHandle& nh) :
     driver_(driver),
-    device_nh_(""),
+    device_nh_(nh),
     pps_pub_(),
     stamped_pps_pub_(),
     subscribers_(0)
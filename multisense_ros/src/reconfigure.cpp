@@ -42,10 +42,11 @@ Reconfigure::Reconfigure(Channel* driver,
                          std::function<void (BorderClip, double)> borderClipChangeCallback,
                          std::function<void (double)> maxPointCloudRangeCallback,
                          std::function<void (crl::multisense::system::ExternalCalibration)> extrinsicsCallback,
-                         std::function<void (ground_surface_utilities::SplineDrawParameters)> groundSurfaceSplineDrawParametersCallback):
+                         std::function<void (ground_surface_utilities::SplineDrawParameters)> groundSurfaceSplineDrawParametersCallback,
+                         const ros::NodeHandle& nh):
     driver_(driver),
     resolution_change_callback_(resolutionChangeCallback),
-    device_nh_(""),
+    device_nh_(nh),
     imu_samples_per_message_(0),
     lighting_supported_(false),
     motor_supported_(false),
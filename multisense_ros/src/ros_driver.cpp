@@ -32,6 +32,7 @@
  **/
 
 #include <functional>
+#include <memory>
 
 #include <multisense_ros/laser.h>
 #include <multisense_ros/camera.h>
@@ -83,10 +84,16 @@ int main(int argc, char** argvPP)
         //
         // Anonymous namespace so objects can deconstruct before channel is destroyed
         {
-            multisense_ros::Laser        laser(d, tf_prefix);
-            multisense_ros::Camera       camera(d, tf_prefix);
+            //
+            // Latencies of the laser and IMU are reported alongside the camera latencies
+
+            const auto latency_registry = std::make_shared<multisense_ros::LatencyRegistry>();
+
+            multisense_ros::Laser        laser(d, tf_prefix, nh, latency_registry,
+                                               multisense_ros::point_layout_param(nh_private_, "lidar_points2"));
+            multisense_ros::Camera       camera(d, tf_prefix, nh, nh_private_, latency_registry);
             multisense_ros::Pps          pps(d);
-            multisense_ros::Imu          imu(d, tf_prefix);
+            multisense_ros::Imu          imu(d, tf_prefix, nh, latency_registry);
             multisense_ros::Status       status(d);
             multisense_ros::Reconfigure  rec(d,
                                              std::bind(&multisense_ros::Camera::updateConfig, &camera, std::placeholders::_1),
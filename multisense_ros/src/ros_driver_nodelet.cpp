@@ -0,0 +1,154 @@
+/**
+ * @file ros_driver_nodelet.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <functional>
+#include <memory>
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <multisense_ros/laser.h>
+#include <multisense_ros/camera.h>
+#include <multisense_ros/pps.h>
+#include <multisense_ros/imu.h>
+#include <multisense_ros/status.h>
+#include <multisense_ros/reconfigure.h>
+
+using namespace crl::multisense;
+
+namespace multisense_ros {
+
+///
+/// @brief Nodelet version of the ros_driver. All messages are published as shared pointers, so subscribers loaded
+///        into the same nodelet manager receive images and point clouds without a copy or serialization
+///
+class DriverNodelet : public nodelet::Nodelet
+{
+public:
+
+    ~DriverNodelet();
+
+private:
+
+    void onInit() override;
+
+    Channel *driver_ = nullptr;
+
+    //
+    // Declared in the order the driver constructs them so they deconstruct before the channel is destroyed
+
+    std::unique_ptr<Laser>       laser_;
+    std::unique_ptr<Camera>      camera_;
+    std::unique_ptr<Pps>         pps_;
+    std::unique_ptr<Imu>         imu_;
+    std::unique_ptr<Status>      status_;
+    std::unique_ptr<Reconfigure> reconfigure_;
+};
+
+DriverNodelet::~DriverNodelet()
+{
+    reconfigure_.reset();
+    status_.reset();
+    imu_.reset();
+    pps_.reset();
+    camera_.reset();
+    laser_.reset();
+
+    if (nullptr != driver_) {
+        Channel::Destroy(driver_);
+    }
+}
+
+void DriverNodelet::onInit()
+{
+    ros::NodeHandle& nh = getNodeHandle();
+    ros::NodeHandle& nh_private = getPrivateNodeHandle();
+
+    //
+    // Get parameters from ROS
+
+    std::string sensor_ip;
+    std::string tf_prefix;
+    int         sensor_mtu;
+
+    nh_private.param<std::string>("sensor_ip", sensor_ip, "10.66.171.21");
+    nh_private.param<std::string>("tf_prefix", tf_prefix, "multisense");
+    nh_private.param<int>("sensor_mtu", sensor_mtu, 7200);
+
+    try {
+
+        driver_ = Channel::Create(sensor_ip);
+        if (nullptr == driver_) {
+            NODELET_ERROR("multisense_ros: failed to create communication channel to sensor @ \"%s\"",
+                          sensor_ip.c_str());
+            return;
+        }
+
+        crl::multisense::Status status = driver_->setMtu(sensor_mtu);
+        if (Status_Ok != status) {
+            NODELET_ERROR("multisense_ros: failed to set sensor MTU to %d: %s",
+                          sensor_mtu, Channel::statusString(status));
+            Channel::Destroy(driver_);
+            driver_ = nullptr;
+            return;
+        }
+
+        const auto latency_registry = std::make_shared<LatencyRegistry>();
+
+        laser_ = std::unique_ptr<Laser>(new Laser(driver_, tf_prefix, nh, latency_registry,
+                                                  point_layout_param(nh_private, "lidar_points2")));
+        camera_ = std::unique_ptr<Camera>(new Camera(driver_, tf_prefix, nh, nh_private, latency_registry));
+        pps_ = std::unique_ptr<Pps>(new Pps(driver_, nh));
+        imu_ = std::unique_ptr<Imu>(new Imu(driver_, tf_prefix, nh, latency_registry));
+        status_ = std::unique_ptr<Status>(new Status(driver_, nh));
+        reconfigure_ = std::unique_ptr<Reconfigure>(
+            new Reconfigure(driver_,
+                            std::bind(&Camera::updateConfig, camera_.get(), std::placeholders::_1),
+                            std::bind(&Camera::borderClipChanged, camera_.get(),
+                                      std::placeholders::_1, std::placeholders::_2),
+                            std::bind(&Camera::maxPointCloudRangeChanged, camera_.get(),
+                                      std::placeholders::_1),
+                            std::bind(&Camera::extrinsicsChanged, camera_.get(),
+                                      std::placeholders::_1),
+                            std::bind(&Camera::groundSurfaceSplineDrawParametersChanged, camera_.get(),
+                                      std::placeholders::_1),
+                            nh));
+
+    } catch (const std::exception& e) {
+        NODELET_ERROR("multisense_ros: caught exception: %s", e.what());
+    }
+}
+
+} // namespace
+
+PLUGINLIB_EXPORT_CLASS(multisense_ros::DriverNodelet, nodelet::Nodelet)
@@ -0,0 +1,90 @@
+/**
+ * @file simd_utilities.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <cstdlib>
+
+#include <multisense_ros/simd_utilities.h>
+
+namespace multisense_ros {
+
+namespace {
+
+SimdLevel querySimdLevel()
+{
+    if (nullptr != getenv("MULTISENSE_ROS_DISABLE_SIMD"))
+    {
+        return SimdLevel::SCALAR;
+    }
+
+#if MULTISENSE_ROS_X86_SIMD
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SimdLevel::AVX2;
+    }
+
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        return SimdLevel::SSE4;
+    }
+#endif
+
+    return SimdLevel::SCALAR;
+}
+
+}// namespace
+
+SimdLevel simdLevel()
+{
+    static const SimdLevel level = querySimdLevel();
+
+    return level;
+}
+
+const char* simdLevelString(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::SSE4:
+            return "sse4.1";
+        case SimdLevel::SCALAR:
+            return "scalar";
+    }
+
+    return "unknown";
+}
+
+}// namespace
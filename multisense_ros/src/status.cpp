@@ -37,9 +37,9 @@
 
 namespace multisense_ros {
 
-Status::Status(crl::multisense::Channel* driver):
+Status::Status(crl::multisense::Channel* driver, const ros::NodeHandle& nh):
     driver_(driver),
-    device_nh_(""),
+    device_nh_(nh),
     status_pub_(),
     status_timer_(),
     subscribers_(0)
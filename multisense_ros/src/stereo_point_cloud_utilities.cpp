@@ -0,0 +1,586 @@
+/**
+ * @file stereo_point_cloud_utilities.cpp
+ *
+ * Copyright 2021
+ * Carnegie Robotics, LLC
+ * 4501 Hatfield Street, Pittsburgh, PA 15201
+ * http://www.carnegierobotics.com
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Carnegie Robotics, LLC nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL CARNEGIE ROBOTICS, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include <ros/ros.h>
+
+#include <multisense_ros/point_cloud_utilities.h>
+#include <multisense_ros/stereo_point_cloud_utilities.h>
+
+namespace multisense_ros {
+
+namespace {
+
+//
+// Write a point at index. The channels are written starting at channel_offset, unless the point layout of the
+// pointcloud has no channels and channel_offset is 0
+
+inline float* writePoint(sensor_msgs::PointCloud2 &pointcloud, size_t index, const Eigen::Vector3f &point)
+{
+    float* cloudP = reinterpret_cast<float*>(&(pointcloud.data[index * pointcloud.point_step]));
+    cloudP[0] = point[0];
+    cloudP[1] = point[1];
+    cloudP[2] = point[2];
+
+    return cloudP;
+}
+
+inline void writePoint(sensor_msgs::PointCloud2 &pointcloud,
+                       uint32_t channel_offset,
+                       size_t index,
+                       const Eigen::Vector3f &point,
+                       uint32_t color)
+{
+    uint8_t* pointP = reinterpret_cast<uint8_t*>(writePoint(pointcloud, index, point));
+
+    if (0 != channel_offset)
+    {
+        uint32_t* colorP = reinterpret_cast<uint32_t*>(pointP + channel_offset);
+        colorP[0] = color;
+    }
+}
+
+//
+// The 32 bits written to the intensity channel of the luma pointclouds: either the luma as a float32, or the raw bits
+// of the integer luma
+
+template <typename LumaT>
+inline uint32_t packedLuma(LumaT luma, bool float_intensity)
+{
+    if (!float_intensity)
+    {
+        return static_cast<uint32_t>(luma);
+    }
+
+    const float intensity = static_cast<float>(luma);
+
+    uint32_t packed = 0;
+    memcpy(&packed, &intensity, sizeof(packed));
+
+    return packed;
+}
+
+//
+// Write a point with a float32 intensity channel followed by a packed color channel
+
+inline void writePoint(sensor_msgs::PointCloud2 &pointcloud,
+                       uint32_t channel_offset,
+                       size_t index,
+                       const Eigen::Vector3f &point,
+                       float luma,
+                       uint32_t color)
+{
+    uint8_t* pointP = reinterpret_cast<uint8_t*>(writePoint(pointcloud, index, point));
+
+    if (0 != channel_offset)
+    {
+        float* lumaP = reinterpret_cast<float*>(pointP + channel_offset);
+        lumaP[0] = luma;
+
+        uint32_t* colorP = reinterpret_cast<uint32_t*>(pointP + channel_offset + sizeof(float));
+        colorP[0] = color;
+    }
+}
+
+template <bool AuxColor, bool SparseColor>
+inline uint32_t packedColor(const StereoPointCloudFrameT &frame,
+                            const uint32_t *aux_colors,
+                            bool valid_disparity,
+                            size_t u,
+                            size_t v)
+{
+    if (SparseColor)
+    {
+        uint8_t bgr[3];
+        ycbcrToRectifiedBgrPixel(*frame.color, *frame.color_remap, u, v, bgr);
+
+        return bgr[2] << 16 | bgr[1] << 8 | bgr[0];
+    }
+
+    if (AuxColor && valid_disparity)
+    {
+        return aux_colors[u];
+    }
+
+    const auto color_pixel = AuxColor ?
+        frame.rectified_color->at<cv::Vec3b>(frame.aux_pixel_map->rows[v], frame.aux_pixel_map->columns[u]) :
+        frame.rectified_color->at<cv::Vec3b>(v, u);
+
+    return color_pixel[2] << 16 | color_pixel[1] << 8 | color_pixel[0];
+}
+
+template <uint32_t Outputs, typename DisparityT, typename LumaT>
+size_t stereoPointCloudKernel(const StereoPointCloudFrameT &frame,
+                              size_t begin_row,
+                              size_t end_row,
+                              size_t point_offset,
+                              float *row_buffer)
+{
+    constexpr bool luma = Outputs & LUMA_POINTCLOUD;
+    constexpr bool color = Outputs & COLOR_POINTCLOUD;
+    constexpr bool luma_organized = Outputs & LUMA_ORGANIZED_POINTCLOUD;
+    constexpr bool color_organized = Outputs & COLOR_ORGANIZED_POINTCLOUD;
+    constexpr bool luma_color_organized = Outputs & LUMA_COLOR_ORGANIZED_POINTCLOUD;
+    constexpr bool aux_color = Outputs & AUX_COLOR;
+    constexpr bool sparse_color = Outputs & SPARSE_COLOR;
+
+    constexpr bool any_luma = luma || luma_organized || luma_color_organized;
+    constexpr bool any_organized = luma_organized || color_organized || luma_color_organized;
+
+    //
+    // Organized pointclouds with color need a color for every pixel
+
+    constexpr bool color_every_pixel = color_organized || luma_color_organized;
+
+    if (!(luma || color || luma_organized || color_organized || luma_color_organized))
+    {
+        return 0;
+    }
+
+    const Eigen::Vector3f invalid_point(std::numeric_limits<float>::quiet_NaN(),
+                                        std::numeric_limits<float>::quiet_NaN(),
+                                        std::numeric_limits<float>::quiet_NaN());
+
+    //
+    // Byte offsets of the channels of each pointcloud, which depend on their point layouts
+
+    const uint32_t luma_channels = luma ? channel_offset(*frame.luma_point_cloud) : 0;
+    const uint32_t color_channels = color ? channel_offset(*frame.color_point_cloud) : 0;
+    const uint32_t luma_organized_channels = luma_organized ? channel_offset(*frame.luma_organized_point_cloud) : 0;
+    const uint32_t color_organized_channels = color_organized ? channel_offset(*frame.color_organized_point_cloud) : 0;
+    const uint32_t luma_color_organized_channels = luma_color_organized ?
+        channel_offset(*frame.luma_color_organized_point_cloud) : 0;
+
+    const size_t width = frame.disparity->width;
+
+    const DisparityT *disparity_image = reinterpret_cast<const DisparityT*>(frame.disparity->imageDataP);
+    const LumaT *luma_image = any_luma ? reinterpret_cast<const LumaT*>(frame.luma->imageDataP) : nullptr;
+
+    float *row_x = row_buffer;
+    float *row_y = row_x + width;
+    float *row_z = row_y + width;
+    uint32_t *aux_colors = reinterpret_cast<uint32_t*>(row_z + width);
+
+    //
+    // Write an invalid point to the organized pointclouds. Color pixels are still computed for invalid points to
+    // keep the organized color pointcloud fully populated
+
+    const auto write_invalid = [&](size_t u, size_t v, size_t index)
+    {
+        if (luma_organized)
+        {
+            writePoint(*frame.luma_organized_point_cloud, luma_organized_channels, index, invalid_point,
+                       packedLuma(luma_image[index], frame.float_intensity));
+        }
+
+        if (color_every_pixel)
+        {
+            const bool valid_disparity = disparity_image[index] != static_cast<DisparityT>(0);
+
+            const uint32_t packed_color = packedColor<aux_color, sparse_color>(frame, aux_colors,
+                                                                               valid_disparity, u, v);
+
+            if (color_organized)
+            {
+                writePoint(*frame.color_organized_point_cloud, color_organized_channels, index, invalid_point,
+                           packed_color);
+            }
+
+            if (luma_color_organized)
+            {
+                writePoint(*frame.luma_color_organized_point_cloud, luma_color_organized_channels, index, invalid_point,
+                           static_cast<float>(luma_image[index]), packed_color);
+            }
+        }
+    };
+
+    size_t valid_points = 0;
+    for (size_t v = begin_row ; v < end_row ; ++v)
+    {
+        const size_t row_offset = v * width;
+        const DisparityT *disparity = disparity_image + row_offset;
+        const ColumnRangeT &columns = frame.border_clip->columns[v];
+
+        reprojectDisparityRow(disparity, v, width, *frame.ray_table, row_x, row_y, row_z);
+
+        //
+        // Sample the aux colors of the whole row at once. Colors of points with invalid disparities are never used
+
+        if (aux_color)
+        {
+            auxColorRow(*frame.aux_projection, v, width, row_z, *frame.rectified_color, aux_colors);
+        }
+
+        if (any_organized)
+        {
+            for (size_t u = 0 ; u < columns.begin ; ++u)
+            {
+                write_invalid(u, v, row_offset + u);
+            }
+        }
+
+        for (size_t u = columns.begin ; u < columns.end ; ++u)
+        {
+            const size_t index = row_offset + u;
+
+            const bool valid_disparity = disparity[u] != static_cast<DisparityT>(0);
+
+            const Eigen::Vector3f point(row_x[u], row_y[u], row_z[u]);
+
+            const uint32_t packed_luma = (luma || luma_organized) ?
+                packedLuma(luma_image[index], frame.float_intensity) : 0;
+            const float intensity = luma_color_organized ? static_cast<float>(luma_image[index]) : 0.0f;
+
+            //
+            // If our disparity is 0 pixels our corresponding 3D point is infinite
+
+            if (!valid_disparity)
+            {
+                if (luma_organized)
+                {
+                    writePoint(*frame.luma_organized_point_cloud, luma_organized_channels, index, invalid_point,
+                               packed_luma);
+                }
+
+                if (color_every_pixel)
+                {
+                    const uint32_t packed_color = packedColor<aux_color, sparse_color>(frame, aux_colors,
+                                                                                       valid_disparity, u, v);
+
+                    if (color_organized)
+                    {
+                        writePoint(*frame.color_organized_point_cloud, color_organized_channels, index,
+                                   invalid_point, packed_color);
+                    }
+
+                    if (luma_color_organized)
+                    {
+                        writePoint(*frame.luma_color_organized_point_cloud, luma_color_organized_channels, index,
+                                   invalid_point, intensity, packed_color);
+                    }
+                }
+
+                continue;
+            }
+
+            const bool valid = isValidReprojectedPoint(point, frame.squared_max_range);
+
+            //
+            // Only color the pixels of points which are written, so coloring the unorganized color pointcloud scales
+            // with the number of valid points
+
+            const uint32_t packed_color = (color_every_pixel || (color && valid)) ?
+                packedColor<aux_color, sparse_color>(frame, aux_colors, valid_disparity, u, v) : 0;
+
+            if (luma && valid)
+            {
+                writePoint(*frame.luma_point_cloud, luma_channels, point_offset + valid_points, point, packed_luma);
+            }
+
+            if (color && valid)
+            {
+                writePoint(*frame.color_point_cloud, color_channels, point_offset + valid_points, point, packed_color);
+            }
+
+            if (luma_organized)
+            {
+                writePoint(*frame.luma_organized_point_cloud, luma_organized_channels, index,
+                           valid ? point : invalid_point, packed_luma);
+            }
+
+            if (color_organized)
+            {
+                writePoint(*frame.color_organized_point_cloud, color_organized_channels, index,
+                           valid ? point : invalid_point, packed_color);
+            }
+
+            if (luma_color_organized)
+            {
+                writePoint(*frame.luma_color_organized_point_cloud, luma_color_organized_channels, index,
+                           valid ? point : invalid_point, intensity, packed_color);
+            }
+
+            valid_points += valid ? 1 : 0;
+        }
+
+        if (any_organized)
+        {
+            for (size_t u = columns.end ; u < width ; ++u)
+            {
+                write_invalid(u, v, row_offset + u);
+            }
+        }
+    }
+
+    return valid_points;
+}
+
+//
+// Output flags which select a color source, and the pointclouds they color
+
+constexpr uint32_t COLOR_SOURCE_OUTPUTS = AUX_COLOR | SPARSE_COLOR;
+constexpr uint32_t COLOR_POINTCLOUD_OUTPUTS = COLOR_POINTCLOUD | COLOR_ORGANIZED_POINTCLOUD |
+                                              LUMA_COLOR_ORGANIZED_POINTCLOUD;
+
+//
+// Output flags with a kernel specialization: at least one pointcloud, at most one color source, and a color
+// source only alongside a pointcloud it colors
+
+constexpr bool validOutputs(uint32_t outputs)
+{
+    return outputs <= ALL_STEREO_POINTCLOUD_OUTPUTS &&
+           0 != (outputs & ~COLOR_SOURCE_OUTPUTS) &&
+           COLOR_SOURCE_OUTPUTS != (outputs & COLOR_SOURCE_OUTPUTS) &&
+           (0 != (outputs & COLOR_POINTCLOUD_OUTPUTS) || 0 == (outputs & COLOR_SOURCE_OUTPUTS));
+}
+
+//
+// Table entries for each combination of output flags. Invalid combinations are left empty so their kernels are never
+// instantiated
+
+template <size_t Outputs, typename DisparityT, typename LumaT>
+constexpr StereoPointCloudKernel kernelEntry(std::true_type)
+{
+    return &stereoPointCloudKernel<Outputs, DisparityT, LumaT>;
+}
+
+template <size_t Outputs, typename DisparityT, typename LumaT>
+constexpr StereoPointCloudKernel kernelEntry(std::false_type)
+{
+    return nullptr;
+}
+
+//
+// Tables of the valid kernel specializations for a disparity and luma type, indexed by pointcloud output flags
+
+template <typename DisparityT, typename LumaT, size_t... Outputs>
+StereoPointCloudKernel selectKernel(uint32_t outputs, std::index_sequence<Outputs...>)
+{
+    static const StereoPointCloudKernel kernels[] = {
+        kernelEntry<Outputs, DisparityT, LumaT>(std::integral_constant<bool, validOutputs(Outputs)>{})...};
+
+    return kernels[outputs];
+}
+
+template <typename DisparityT, typename LumaT>
+StereoPointCloudKernel selectKernel(uint32_t outputs)
+{
+    return selectKernel<DisparityT, LumaT>(outputs, std::make_index_sequence<ALL_STEREO_POINTCLOUD_OUTPUTS + 1>{});
+}
+
+template <typename DisparityT>
+StereoPointCloudKernel selectKernel(uint32_t outputs, uint32_t luma_bits)
+{
+    switch (luma_bits)
+    {
+        case 8:  return selectKernel<DisparityT, uint8_t>(outputs);
+        case 16: return selectKernel<DisparityT, uint16_t>(outputs);
+        case 32: return selectKernel<DisparityT, uint32_t>(outputs);
+    }
+
+    return nullptr;
+}
+
+}// namespace
+
+BorderClipMaskT makeBorderClipMask(const BorderClip &border_clip_type,
+                                   double border_clip_value,
+                                   size_t width,
+                                   size_t height)
+{
+    BorderClipMaskT mask;
+    mask.type = border_clip_type;
+    mask.value = border_clip_value;
+    mask.width = width;
+    mask.height = height;
+    mask.columns.resize(height);
+
+    for (size_t v = 0 ; v < height ; ++v)
+    {
+        ColumnRangeT &columns = mask.columns[v];
+
+        columns.begin = 0;
+        while (columns.begin < width && clipPoint(border_clip_type, border_clip_value, width, height, columns.begin, v))
+        {
+            ++columns.begin;
+        }
+
+        columns.end = width;
+        while (columns.end > columns.begin &&
+               clipPoint(border_clip_type, border_clip_value, width, height, columns.end - 1, v))
+        {
+            --columns.end;
+        }
+    }
+
+    return mask;
+}
+
+ColorPixelMapT makeColorPixelMap(size_t width, size_t height, size_t color_width, size_t color_height)
+{
+    ColorPixelMapT map;
+    map.width = width;
+    map.height = height;
+    map.color_width = color_width;
+    map.color_height = color_height;
+
+    //
+    // Map pixel centers, so each disparity pixel takes the color pixel it overlaps
+
+    const auto nearest = [](size_t index, size_t size, size_t color_size)
+    {
+        return static_cast<uint32_t>(std::min(((2 * index + 1) * color_size) / (2 * size), color_size - 1));
+    };
+
+    map.columns.resize(width);
+    for (size_t u = 0 ; u < width ; ++u)
+    {
+        map.columns[u] = nearest(u, width, color_width);
+    }
+
+    map.rows.resize(height);
+    for (size_t v = 0 ; v < height ; ++v)
+    {
+        map.rows[v] = nearest(v, height, color_height);
+    }
+
+    return map;
+}
+
+bool clipPoint(const BorderClip& border_clip_type,
+               double border_clip_value,
+               size_t width,
+               size_t height,
+               size_t u,
+               size_t v)
+{
+    switch (border_clip_type)
+    {
+        case BorderClip::NONE:
+        {
+            return false;
+        }
+        case BorderClip::RECTANGULAR:
+        {
+            return !( u >= border_clip_value && u <= width - border_clip_value &&
+                      v >= border_clip_value && v <= height - border_clip_value);
+        }
+        case BorderClip::CIRCULAR:
+        {
+            const double halfWidth = static_cast<double>(width)/2.0;
+            const double halfHeight = static_cast<double>(height)/2.0;
+
+            const double radius = sqrt( halfWidth * halfWidth + halfHeight * halfHeight ) - border_clip_value;
+
+            return !(Eigen::Vector2d{halfWidth - u, halfHeight - v}.norm() < radius);
+        }
+        default:
+        {
+            ROS_WARN("Camera: Unknown border clip type.");
+            break;
+        }
+    }
+
+    return true;
+}
+
+cv::Vec3b interpolate_color(const Eigen::Vector2f &pixel, const cv::Mat &image)
+{
+    const float width = image.cols;
+    const float height = image.rows;
+
+    const float &u = pixel(0);
+    const float &v = pixel(1);
+
+    //
+    // Implement a basic bileinar interpolation scheme
+    // https://en.wikipedia.org/wiki/Bilinear_interpolation
+    //
+    const size_t min_u = static_cast<size_t>(std::min(std::max(std::floor(u), 0.f), width - 1.f));
+    const size_t max_u = static_cast<size_t>(std::min(std::max(std::floor(u) + 1, 0.f), width - 1.f));
+    const size_t min_v = static_cast<size_t>(std::min(std::max(std::floor(v), 0.f), height - 1.f));
+    const size_t max_v = static_cast<size_t>(std::min(std::max(std::floor(v) + 1, 0.f), height - 1.f));
+
+    const cv::Vec3d element00 = image.at<cv::Vec3b>(width * min_v + min_u);
+    const cv::Vec3d element01 = image.at<cv::Vec3b>(width * min_v + max_u);
+    const cv::Vec3d element10 = image.at<cv::Vec3b>(width * max_v + min_u);
+    const cv::Vec3d element11 = image.at<cv::Vec3b>(width * max_v + max_u);
+
+    const size_t delta_u = max_u - min_u;
+    const size_t delta_v = max_v - min_v;
+
+    const double u_ratio = delta_u == 0 ? 1. : (static_cast<double>(max_u) - u) / static_cast<double>(delta_u);
+    const double v_ratio = delta_v == 0 ? 1. : (static_cast<double>(max_v) - v) / static_cast<double>(delta_v);
+
+    const cv::Vec3b f_xy0 = element00 * u_ratio + element01 * (1. - u_ratio);
+    const cv::Vec3b f_xy1 = element10 * u_ratio + element11 * (1. - u_ratio);
+
+    return (f_xy0 * v_ratio + f_xy1 * (1. - v_ratio));
+}
+
+bool isValidReprojectedPoint(const Eigen::Vector3f& pt, float squared_max_range)
+{
+    return pt[2] > 0.0f && std::isfinite(pt[2]) && pt.squaredNorm() < squared_max_range;
+}
+
+StereoPointCloudKernel selectStereoPointCloudKernel(uint32_t outputs, uint32_t disparity_bits, uint32_t luma_bits)
+{
+    //
+    // A color source has no effect without a color pointcloud, so fall back to the kernel without one
+
+    if (0 == (outputs & COLOR_POINTCLOUD_OUTPUTS))
+    {
+        outputs &= ~COLOR_SOURCE_OUTPUTS;
+    }
+
+    if (!validOutputs(outputs))
+    {
+        return nullptr;
+    }
+
+    switch (disparity_bits)
+    {
+        case 16: return selectKernel<uint16_t>(outputs, luma_bits);
+        case 32: return selectKernel<float>(outputs, luma_bits);
+    }
+
+    return nullptr;
+}
+
+}// namespace